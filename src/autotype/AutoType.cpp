@@ -24,9 +24,9 @@
 
 #include "config-keepassx.h"
 
+#include "autotype/AutoTypeMatchIndex.h"
 #include "autotype/AutoTypePlatformPlugin.h"
 #include "autotype/AutoTypeSelectDialog.h"
-#include "autotype/WildcardMatcher.h"
 #include "core/Config.h"
 #include "core/Database.h"
 #include "core/Entry.h"
@@ -38,6 +38,8 @@
 
 AutoType* AutoType::m_instance = nullptr;
 
+static const int ActionBatchSize = 8;
+
 AutoType::AutoType(QObject* parent, bool test)
     : QObject(parent)
     , m_inAutoType(false)
@@ -170,17 +172,27 @@ void AutoType::executeAutoTypeActions(const Entry* entry, QWidget* hideWindow, c
         window = m_plugin->activeWindow();
     }
 
+    m_executor->prepare(actions);
     QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
 
-    for (AutoTypeAction* action : asConst(actions)) {
-        if (m_plugin->activeWindow() != window) {
-            qWarning("Active window changed, interrupting auto-type.");
-            break;
+    // the actions are sent in small batches, each one flushed to and processed
+    // by the server before the target window is checked again, so no more
+    // than one batch can reach a window that was activated in between
+    for (int i = 0; i < actions.size(); ++i) {
+        if (i % ActionBatchSize == 0) {
+            if (i > 0) {
+                m_executor->flush();
+                QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+            }
+            if (m_plugin->activeWindow() != window) {
+                qWarning("Active window changed, interrupting auto-type.");
+                break;
+            }
         }
 
-        action->accept(m_executor);
-        QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+        actions.at(i)->accept(m_executor);
     }
+    m_executor->flush();
 
     m_inAutoType = false;
 }
@@ -202,13 +214,16 @@ void AutoType::performGlobalAutoType(const QList<Database*>& dbList)
     QList<Entry*> entryList;
     QHash<Entry*, QString> sequenceHash;
 
+    const bool matchTitle = config()->get("AutoTypeEntryTitleMatch").toBool();
+    const bool matchUrl = config()->get("AutoTypeEntryURLMatch").toBool();
+
     for (Database* db : dbList) {
-        const QList<Entry*> dbEntries = db->rootGroup()->entriesRecursive();
-        for (Entry* entry : dbEntries) {
-            QString sequence = autoTypeSequence(entry, windowTitle);
+        const QList<AutoTypeMatch> matches = matchIndex(db)->match(windowTitle, matchTitle, matchUrl);
+        for (const AutoTypeMatch& match : matches) {
+            QString sequence = autoTypeSequence(match.first, match.second);
             if (!sequence.isEmpty()) {
-                entryList << entry;
-                sequenceHash.insert(entry, sequence);
+                entryList << match.first;
+                sequenceHash.insert(match.first, sequence);
             }
         }
     }
@@ -506,46 +521,20 @@ QList<AutoTypeAction*> AutoType::createActionFromTemplate(const QString& tmpl, c
     return list;
 }
 
-QString AutoType::autoTypeSequence(const Entry* entry, const QString& windowTitle)
+/**
+ * The sequence to type for the entry, starting from the sequence of a matched
+ * window association. Falls back to the default sequence of the entry and its
+ * groups. Empty if Auto-Type is disabled for the entry.
+ */
+QString AutoType::autoTypeSequence(const Entry* entry, const QString& windowSequence)
 {
     if (!entry->autoTypeEnabled()) {
         return QString();
     }
 
     bool enableSet = false;
-    QString sequence;
-    if (!windowTitle.isEmpty()) {
-        bool match = false;
-        const QList<AutoTypeAssociations::Association> assocList = entry->autoTypeAssociations()->getAll();
-        for (const AutoTypeAssociations::Association& assoc : assocList) {
-            const QString window = entry->resolveMultiplePlaceholders(assoc.window);
-            if (windowMatches(windowTitle, window)) {
-                if (!assoc.sequence.isEmpty()) {
-                    sequence = assoc.sequence;
-                } else {
-                    sequence = entry->defaultAutoTypeSequence();
-                }
-                match = true;
-                break;
-            }
-        }
-
-        if (!match && config()->get("AutoTypeEntryTitleMatch").toBool() &&
-            windowMatchesTitle(windowTitle, entry->resolvePlaceholder(entry->title()))) {
-            sequence = entry->defaultAutoTypeSequence();
-            match = true;
-        }
-
-        if (!match && config()->get("AutoTypeEntryURLMatch").toBool() &&
-            windowMatchesUrl(windowTitle, entry->resolvePlaceholder(entry->url()))) {
-            sequence = entry->defaultAutoTypeSequence();
-            match = true;
-        }
-
-        if (!match) {
-            return QString();
-        }
-    } else {
+    QString sequence = windowSequence;
+    if (sequence.isEmpty()) {
         sequence = entry->defaultAutoTypeSequence();
     }
 
@@ -580,33 +569,22 @@ QString AutoType::autoTypeSequence(const Entry* entry, const QString& windowTitl
     return sequence;
 }
 
-bool AutoType::windowMatches(const QString& windowTitle, const QString& windowPattern)
-{
-    if (windowPattern.startsWith("//") && windowPattern.endsWith("//") && windowPattern.size() >= 4) {
-        QRegExp regExp(windowPattern.mid(2, windowPattern.size() - 4), Qt::CaseInsensitive, QRegExp::RegExp2);
-        return (regExp.indexIn(windowTitle) != -1);
-    } else {
-        return WildcardMatcher(windowTitle).match(windowPattern);
-    }
-}
-
-bool AutoType::windowMatchesTitle(const QString& windowTitle, const QString& resolvedTitle)
-{
-    return !resolvedTitle.isEmpty() && windowTitle.contains(resolvedTitle, Qt::CaseInsensitive);
-}
-
-bool AutoType::windowMatchesUrl(const QString& windowTitle, const QString& resolvedUrl)
+AutoTypeMatchIndex* AutoType::matchIndex(Database* db)
 {
-    if (!resolvedUrl.isEmpty() && windowTitle.contains(resolvedUrl, Qt::CaseInsensitive)) {
-        return true;
-    }
-
-    QUrl url(resolvedUrl);
-    if (url.isValid() && !url.host().isEmpty()) {
-        return windowTitle.contains(url.host(), Qt::CaseInsensitive);
+    AutoTypeMatchIndex* index = m_matchIndexes.value(db);
+    if (!index) {
+        // drop indexes of closed databases before adding a new one
+        for (auto it = m_matchIndexes.begin(); it != m_matchIndexes.end();) {
+            if (!it.value()) {
+                it = m_matchIndexes.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        index = new AutoTypeMatchIndex(db);
+        m_matchIndexes.insert(db, index);
     }
-
-    return false;
+    return index;
 }
 
 bool AutoType::checkSyntax(const QString& string)
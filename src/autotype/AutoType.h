@@ -19,12 +19,15 @@
 #ifndef KEEPASSX_AUTOTYPE_H
 #define KEEPASSX_AUTOTYPE_H
 
+#include <QHash>
 #include <QObject>
+#include <QPointer>
 #include <QStringList>
 #include <QWidget>
 
 class AutoTypeAction;
 class AutoTypeExecutor;
+class AutoTypeMatchIndex;
 class AutoTypePlatformInterface;
 class Database;
 class Entry;
@@ -79,10 +82,8 @@ private:
     void loadPlugin(const QString& pluginPath);
     bool parseActions(const QString& sequence, const Entry* entry, QList<AutoTypeAction*>& actions);
     QList<AutoTypeAction*> createActionFromTemplate(const QString& tmpl, const Entry* entry);
-    QString autoTypeSequence(const Entry* entry, const QString& windowTitle = QString());
-    bool windowMatchesTitle(const QString& windowTitle, const QString& resolvedTitle);
-    bool windowMatchesUrl(const QString& windowTitle, const QString& resolvedUrl);
-    bool windowMatches(const QString& windowTitle, const QString& windowPattern);
+    QString autoTypeSequence(const Entry* entry, const QString& windowSequence = QString());
+    AutoTypeMatchIndex* matchIndex(Database* db);
 
     bool m_inAutoType;
     int m_autoTypeDelay;
@@ -92,6 +93,7 @@ private:
     AutoTypePlatformInterface* m_plugin;
     AutoTypeExecutor* m_executor;
     WId m_windowFromGlobal;
+    QHash<const Database*, QPointer<AutoTypeMatchIndex>> m_matchIndexes;
     static AutoType* m_instance;
 
     Q_DISABLE_COPY(AutoType)
@@ -82,6 +82,14 @@ void AutoTypeClearField::accept(AutoTypeExecutor* executor)
 }
 
 
+/**
+ * Called with all actions of a sequence before the first one is executed.
+ */
+void AutoTypeExecutor::prepare(const QList<AutoTypeAction*>& actions)
+{
+    Q_UNUSED(actions);
+}
+
 void AutoTypeExecutor::execDelay(AutoTypeDelay* action)
 {
     Tools::wait(action->delayMs);
@@ -91,3 +99,11 @@ void AutoTypeExecutor::execClearField(AutoTypeClearField* action)
 {
     Q_UNUSED(action);
 }
+
+/**
+ * Called after a batch of actions, events an executor queued must be sent
+ * by now.
+ */
+void AutoTypeExecutor::flush()
+{
+}
@@ -19,6 +19,7 @@
 #define KEEPASSX_AUTOTYPEACTION_H
 
 #include <QChar>
+#include <QList>
 #include <Qt>
 
 #include "core/Global.h"
@@ -75,10 +76,12 @@ class KEEPASSX_EXPORT AutoTypeExecutor
 {
 public:
     virtual ~AutoTypeExecutor() {}
+    virtual void prepare(const QList<AutoTypeAction*>& actions);
     virtual void execChar(AutoTypeChar* action) = 0;
     virtual void execKey(AutoTypeKey* action) = 0;
     virtual void execDelay(AutoTypeDelay* action);
     virtual void execClearField(AutoTypeClearField* action);
+    virtual void flush();
 };
 
 #endif // KEEPASSX_AUTOTYPEACTION_H
@@ -0,0 +1,296 @@
+/*
+ *  Copyright (C) 2017 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "AutoTypeMatchIndex.h"
+
+#include <QUrl>
+
+#include <algorithm>
+
+#include "autotype/WildcardMatcher.h"
+#include "core/Database.h"
+#include "core/Entry.h"
+#include "core/Group.h"
+
+namespace {
+
+/**
+ * Position of the entry in the order of Group::entriesRecursive(): the child
+ * indexes of its groups from the root down, then -1 so that the entries of a
+ * group sort before its subgroups, then the index of the entry.
+ */
+QList<int> treePosition(const Entry* entry)
+{
+    QList<int> position;
+    const Group* group = entry->group();
+    position.prepend(group->entries().indexOf(const_cast<Entry*>(entry)));
+    position.prepend(-1);
+    while (const Group* parent = group->parentGroup()) {
+        position.prepend(parent->children().indexOf(const_cast<Group*>(group)));
+        group = parent;
+    }
+    return position;
+}
+
+} // namespace
+
+AutoTypeMatchIndex::AutoTypeMatchIndex(Database* db)
+    : QObject(db)
+    , m_db(db)
+    , m_patternsChanged(false)
+{
+    connect(m_db, SIGNAL(groupAboutToAdd(Group*,int)), SLOT(groupAboutToAdd(Group*)));
+    connect(m_db, SIGNAL(groupAboutToRemove(Group*)), SLOT(groupAboutToRemove(Group*)));
+
+    rebuild();
+}
+
+/**
+ * Entries whose association windows, title or URL match the window title,
+ * each with the sequence of the matching association. The sequence is empty
+ * if the entry's default sequence applies.
+ *
+ * The same precedence as before the index applies: associations in their
+ * order first, then the entry title, then the entry URL. Auto-Type settings
+ * of the entry and its groups are not checked here.
+ *
+ * The matches are in the order of the entries in the tree, like the
+ * Group::entriesRecursive() walk the index replaces.
+ */
+QList<AutoTypeMatch> AutoTypeMatchIndex::match(const QString& windowTitle, bool matchTitle, bool matchUrl)
+{
+    if (m_db->rootGroup() != m_rootGroup) {
+        rebuild();
+    }
+
+    const QSet<Entry*> dirtyEntries = m_dirtyEntries;
+    for (Entry* entry : dirtyEntries) {
+        unindexEntry(entry);
+        indexEntry(entry);
+    }
+
+    if (m_patternsChanged) {
+        compilePatterns();
+    }
+
+    const QBitArray patternMatches = m_patterns.match(windowTitle);
+    WildcardMatcher wildcardMatcher(windowTitle);
+    QList<AutoTypeMatch> result;
+
+    for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+        Entry* entry = it.key();
+        EntryMatcher& matcher = it.value();
+
+        bool match = false;
+        for (WindowMatcher& window : matcher.windows) {
+            if (window.isRegExp) {
+                match = window.regExp.indexIn(windowTitle) != -1;
+            } else if (window.patternId >= 0) {
+                match = patternMatches.testBit(window.patternId);
+            } else {
+                match = wildcardMatcher.match(window.window);
+            }
+
+            if (match) {
+                result.append(qMakePair(entry, window.sequence));
+                break;
+            }
+        }
+
+        if (!match && matchTitle && !matcher.title.isEmpty()
+            && windowTitle.contains(matcher.title, Qt::CaseInsensitive)) {
+            result.append(qMakePair(entry, QString()));
+            match = true;
+        }
+
+        if (!match && matchUrl
+            && ((!matcher.url.isEmpty() && windowTitle.contains(matcher.url, Qt::CaseInsensitive))
+                || (!matcher.urlHost.isEmpty() && windowTitle.contains(matcher.urlHost, Qt::CaseInsensitive)))) {
+            result.append(qMakePair(entry, QString()));
+        }
+    }
+
+    // usually only a few entries match, so their positions are looked up here
+    // instead of keeping the index ordered through every move
+    if (result.size() > 1) {
+        QHash<const Entry*, QList<int>> positions;
+        for (const AutoTypeMatch& match : result) {
+            positions.insert(match.first, treePosition(match.first));
+        }
+        std::sort(result.begin(), result.end(), [&positions](const AutoTypeMatch& a, const AutoTypeMatch& b) {
+            const QList<int>& positionA = positions[a.first];
+            const QList<int>& positionB = positions[b.first];
+            return std::lexicographical_compare(positionA.begin(), positionA.end(),
+                                                positionB.begin(), positionB.end());
+        });
+    }
+
+    return result;
+}
+
+void AutoTypeMatchIndex::groupAboutToAdd(Group* group)
+{
+    addGroup(group);
+}
+
+void AutoTypeMatchIndex::groupAboutToRemove(Group* group)
+{
+    removeGroup(group);
+}
+
+void AutoTypeMatchIndex::entryAdded(Entry* entry)
+{
+    indexEntry(entry);
+}
+
+void AutoTypeMatchIndex::entryAboutToRemove(Entry* entry)
+{
+    unindexEntry(entry);
+}
+
+void AutoTypeMatchIndex::entryModified()
+{
+    Entry* entry = qobject_cast<Entry*>(sender());
+    if (entry && m_entries.contains(entry)) {
+        m_dirtyEntries.insert(entry);
+    }
+}
+
+void AutoTypeMatchIndex::rebuild()
+{
+    if (m_rootGroup) {
+        removeGroup(m_rootGroup);
+    }
+
+    m_entries.clear();
+    m_dirtyEntries.clear();
+
+    m_rootGroup = m_db->rootGroup();
+    if (m_rootGroup) {
+        addGroup(m_rootGroup);
+    }
+}
+
+void AutoTypeMatchIndex::addGroup(Group* group)
+{
+    for (Group* child : group->groupsRecursive(true)) {
+        connect(child, SIGNAL(entryAdded(Entry*)), SLOT(entryAdded(Entry*)));
+        connect(child, SIGNAL(entryAboutToRemove(Entry*)), SLOT(entryAboutToRemove(Entry*)));
+
+        for (Entry* entry : child->entries()) {
+            indexEntry(entry);
+        }
+    }
+}
+
+void AutoTypeMatchIndex::removeGroup(Group* group)
+{
+    for (Group* child : group->groupsRecursive(true)) {
+        child->disconnect(this);
+
+        for (Entry* entry : child->entries()) {
+            unindexEntry(entry);
+        }
+    }
+}
+
+void AutoTypeMatchIndex::indexEntry(Entry* entry)
+{
+    if (m_entries.contains(entry)) {
+        return;
+    }
+
+    connect(entry, SIGNAL(modified()), SLOT(entryModified()), Qt::UniqueConnection);
+
+    EntryMatcher matcher;
+    bool dynamic = isDynamic(entry->title()) || isDynamic(entry->url());
+
+    const QList<AutoTypeAssociations::Association> assocList = entry->autoTypeAssociations()->getAll();
+    for (const AutoTypeAssociations::Association& assoc : assocList) {
+        WindowMatcher window;
+        window.window = entry->resolveMultiplePlaceholders(assoc.window);
+        window.sequence = assoc.sequence;
+        window.patternId = -1;
+        window.isRegExp = window.window.startsWith("//") && window.window.endsWith("//") && window.window.size() >= 4;
+        if (window.isRegExp) {
+            window.regExp = QRegExp(window.window.mid(2, window.window.size() - 4), Qt::CaseInsensitive, QRegExp::RegExp2);
+        }
+        matcher.windows.append(window);
+        dynamic = dynamic || isDynamic(assoc.window);
+    }
+
+    matcher.title = entry->resolvePlaceholder(entry->title());
+    matcher.url = entry->resolvePlaceholder(entry->url());
+    QUrl url(matcher.url);
+    if (url.isValid()) {
+        matcher.urlHost = url.host();
+    }
+
+    // stays dirty, the other entries can change without this one
+    matcher.isDynamic = dynamic;
+    if (dynamic) {
+        m_dirtyEntries.insert(entry);
+    } else if (!matcher.windows.isEmpty()) {
+        m_patternsChanged = true;
+    }
+
+    m_entries.insert(entry, matcher);
+}
+
+void AutoTypeMatchIndex::unindexEntry(Entry* entry)
+{
+    if (!m_entries.contains(entry)) {
+        return;
+    }
+
+    entry->disconnect(this);
+    m_dirtyEntries.remove(entry);
+    m_entries.remove(entry);
+}
+
+/**
+ * Collect the wildcard windows of all entries that don't change on every
+ * lookup into one pattern set. Windows of entries indexed since are matched
+ * one by one until the set is compiled again.
+ */
+void AutoTypeMatchIndex::compilePatterns()
+{
+    QStringList patterns;
+    for (EntryMatcher& matcher : m_entries) {
+        if (matcher.isDynamic) {
+            continue;
+        }
+        for (WindowMatcher& window : matcher.windows) {
+            if (!window.isRegExp) {
+                window.patternId = patterns.size();
+                patterns.append(window.window);
+            }
+        }
+    }
+
+    m_patterns = WildcardPatternSet(patterns);
+    m_patternsChanged = false;
+}
+
+/**
+ * Whether the value resolves differently when other entries or the time
+ * change, so it can't be resolved once when the entry is indexed.
+ */
+bool AutoTypeMatchIndex::isDynamic(const QString& value)
+{
+    return value.contains("{REF:", Qt::CaseInsensitive) || value.contains("{TOTP}", Qt::CaseInsensitive);
+}
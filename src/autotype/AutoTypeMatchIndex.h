@@ -0,0 +1,98 @@
+/*
+ *  Copyright (C) 2017 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSX_AUTOTYPEMATCHINDEX_H
+#define KEEPASSX_AUTOTYPEMATCHINDEX_H
+
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QPair>
+#include <QPointer>
+#include <QRegExp>
+#include <QSet>
+
+#include "autotype/WildcardPatternSet.h"
+
+class Database;
+class Entry;
+class Group;
+
+typedef QPair<Entry*, QString> AutoTypeMatch;
+
+/**
+ * Compiled window matchers of the entries of a database for global
+ * Auto-Type: association windows with their placeholders resolved and their
+ * regular expressions built, plus the resolved entry titles and URLs.
+ *
+ * The index is a child of the database and follows entry and group changes,
+ * recompiling modified entries lazily on the next lookup. The wildcard windows
+ * of all entries are matched together in one pass over the window title. Entries that refer
+ * to other entries or to the TOTP are recompiled on every lookup.
+ */
+class AutoTypeMatchIndex : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit AutoTypeMatchIndex(Database* db);
+
+    QList<AutoTypeMatch> match(const QString& windowTitle, bool matchTitle, bool matchUrl);
+
+private slots:
+    void groupAboutToAdd(Group* group);
+    void groupAboutToRemove(Group* group);
+    void entryAdded(Entry* entry);
+    void entryAboutToRemove(Entry* entry);
+    void entryModified();
+
+private:
+    struct WindowMatcher
+    {
+        QString window;
+        QString sequence;
+        bool isRegExp;
+        QRegExp regExp;
+        int patternId;
+    };
+
+    struct EntryMatcher
+    {
+        QList<WindowMatcher> windows;
+        QString title;
+        QString url;
+        QString urlHost;
+        bool isDynamic;
+    };
+
+    void rebuild();
+    void addGroup(Group* group);
+    void removeGroup(Group* group);
+    void indexEntry(Entry* entry);
+    void unindexEntry(Entry* entry);
+    void compilePatterns();
+    static bool isDynamic(const QString& value);
+
+    Database* const m_db;
+    QPointer<Group> m_rootGroup;
+    QHash<Entry*, EntryMatcher> m_entries;
+    QSet<Entry*> m_dirtyEntries;
+    WildcardPatternSet m_patterns;
+    bool m_patternsChanged;
+};
+
+#endif // KEEPASSX_AUTOTYPEMATCHINDEX_H
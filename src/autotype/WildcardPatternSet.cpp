@@ -0,0 +1,178 @@
+/*
+ *  Copyright (C) 2017 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "WildcardPatternSet.h"
+
+#include <algorithm>
+
+#include "autotype/WildcardMatcher.h"
+
+WildcardPatternSet::WildcardPatternSet()
+    : m_size(0)
+{
+    m_nodes.append(Node());
+}
+
+/**
+ * Compile the patterns, their positions in the list are the bit positions
+ * in the result of match().
+ */
+WildcardPatternSet::WildcardPatternSet(const QStringList& patterns)
+    : m_size(patterns.size())
+{
+    m_nodes.append(Node());
+
+    for (int id = 0; id < patterns.size(); ++id) {
+        const QString pattern = patterns.at(id).toCaseFolded();
+        if (!pattern.contains(WildcardMatcher::Wildcard)) {
+            m_exactPatterns[pattern].append(id);
+            continue;
+        }
+
+        const QStringList parts = pattern.split(WildcardMatcher::Wildcard, QString::KeepEmptyParts);
+        Pattern compiled;
+        compiled.prefix = parts.first();
+        compiled.suffix = parts.last();
+        for (int i = 1; i < parts.size() - 1; ++i) {
+            if (!parts.at(i).isEmpty()) {
+                compiled.fragments.append(addFragment(parts.at(i)));
+            }
+        }
+
+        m_wildcardIds.append(id);
+        m_wildcardPatterns.append(compiled);
+    }
+
+    buildFailureLinks();
+}
+
+int WildcardPatternSet::size() const
+{
+    return m_size;
+}
+
+/**
+ * Match all patterns against the text. Bit i of the result is set if the
+ * i-th pattern matches.
+ */
+QBitArray WildcardPatternSet::match(const QString& text) const
+{
+    QBitArray result(m_size);
+    const QString folded = text.toCaseFolded();
+
+    for (int id : m_exactPatterns.value(folded)) {
+        result.setBit(id);
+    }
+
+    if (m_wildcardPatterns.isEmpty()) {
+        return result;
+    }
+
+    // start positions of every fragment in the text, in ascending order
+    QVector<QVector<int>> occurrences(m_fragmentLengths.size());
+    if (!m_fragmentLengths.isEmpty()) {
+        int state = 0;
+        for (int i = 0; i < folded.size(); ++i) {
+            const QChar ch = folded.at(i);
+            while (state != 0 && !m_nodes.at(state).next.contains(ch)) {
+                state = m_nodes.at(state).fail;
+            }
+            state = m_nodes.at(state).next.value(ch, 0);
+
+            int node = m_nodes.at(state).fragment >= 0 ? state : m_nodes.at(state).output;
+            while (node >= 0) {
+                const int fragment = m_nodes.at(node).fragment;
+                occurrences[fragment].append(i + 1 - m_fragmentLengths.at(fragment));
+                node = m_nodes.at(node).output;
+            }
+        }
+    }
+
+    for (int i = 0; i < m_wildcardPatterns.size(); ++i) {
+        const Pattern& pattern = m_wildcardPatterns.at(i);
+        if (!folded.startsWith(pattern.prefix) || !folded.endsWith(pattern.suffix)) {
+            continue;
+        }
+
+        // earliest occurrence of each fragment after the previous one
+        int index = pattern.prefix.size();
+        bool match = true;
+        for (int fragment : pattern.fragments) {
+            const QVector<int>& starts = occurrences.at(fragment);
+            auto it = std::lower_bound(starts.constBegin(), starts.constEnd(), index);
+            if (it == starts.constEnd()) {
+                match = false;
+                break;
+            }
+            index = *it + m_fragmentLengths.at(fragment);
+        }
+
+        if (match && folded.size() - pattern.suffix.size() >= index) {
+            result.setBit(m_wildcardIds.at(i));
+        }
+    }
+
+    return result;
+}
+
+int WildcardPatternSet::addFragment(const QString& fragment)
+{
+    int state = 0;
+    for (const QChar& ch : fragment) {
+        int next = m_nodes.at(state).next.value(ch, -1);
+        if (next < 0) {
+            next = m_nodes.size();
+            m_nodes.append(Node());
+            m_nodes[state].next.insert(ch, next);
+        }
+        state = next;
+    }
+
+    if (m_nodes.at(state).fragment < 0) {
+        m_nodes[state].fragment = m_fragmentLengths.size();
+        m_fragmentLengths.append(fragment.size());
+    }
+    return m_nodes.at(state).fragment;
+}
+
+void WildcardPatternSet::buildFailureLinks()
+{
+    // breadth first, so the failure target of a node is always done before it
+    QVector<int> queue;
+    for (int child : m_nodes.at(0).next) {
+        queue.append(child);
+    }
+
+    for (int i = 0; i < queue.size(); ++i) {
+        const int state = queue.at(i);
+        const QHash<QChar, int> next = m_nodes.at(state).next;
+        for (auto it = next.constBegin(); it != next.constEnd(); ++it) {
+            const QChar ch = it.key();
+            const int child = it.value();
+
+            int fail = m_nodes.at(state).fail;
+            while (fail != 0 && !m_nodes.at(fail).next.contains(ch)) {
+                fail = m_nodes.at(fail).fail;
+            }
+            fail = m_nodes.at(fail).next.value(ch, 0);
+
+            m_nodes[child].fail = fail;
+            m_nodes[child].output = m_nodes.at(fail).fragment >= 0 ? fail : m_nodes.at(fail).output;
+            queue.append(child);
+        }
+    }
+}
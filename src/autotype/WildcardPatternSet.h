@@ -0,0 +1,73 @@
+/*
+ *  Copyright (C) 2017 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSX_WILDCARDPATTERNSET_H
+#define KEEPASSX_WILDCARDPATTERNSET_H
+
+#include <QBitArray>
+#include <QHash>
+#include <QStringList>
+#include <QVector>
+
+/**
+ * A compiled set of wildcard patterns, matched against a text in one pass.
+ *
+ * Matches like WildcardMatcher: case-insensitive, a pattern without a
+ * wildcard must equal the text, otherwise it is anchored at both ends by
+ * its first and last parts. The parts in between are found with an
+ * Aho-Corasick automaton over all patterns, so the text is scanned once no
+ * matter how many patterns the set holds.
+ */
+class WildcardPatternSet
+{
+public:
+    WildcardPatternSet();
+    explicit WildcardPatternSet(const QStringList& patterns);
+
+    int size() const;
+    QBitArray match(const QString& text) const;
+
+private:
+    struct Pattern
+    {
+        QString prefix;
+        QString suffix;
+        QVector<int> fragments;
+    };
+
+    struct Node
+    {
+        Node() : fragment(-1), fail(0), output(-1) {}
+
+        QHash<QChar, int> next;
+        int fragment;
+        int fail;
+        int output;
+    };
+
+    int addFragment(const QString& fragment);
+    void buildFailureLinks();
+
+    int m_size;
+    QHash<QString, QVector<int>> m_exactPatterns;
+    QVector<int> m_wildcardIds;
+    QVector<Pattern> m_wildcardPatterns;
+    QVector<int> m_fragmentLengths;
+    QVector<Node> m_nodes;
+};
+
+#endif // KEEPASSX_WILDCARDPATTERNSET_H
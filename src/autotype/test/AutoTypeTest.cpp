@@ -34,6 +34,10 @@ QStringList AutoTypePlatformTest::windowTitles()
 
 WId AutoTypePlatformTest::activeWindow()
 {
+    ++m_activeWindowChecks;
+    if (m_changeActiveWindowAfter >= 0 && m_activeWindowChecks > m_changeActiveWindowAfter) {
+        return 1;
+    }
     return 0;
 }
 
@@ -89,6 +93,29 @@ void AutoTypePlatformTest::clearActions()
     m_actionList.clear();
 
     m_actionChars.clear();
+    m_actionBatches.clear();
+    m_batchStart = 0;
+    m_activeWindowChecks = 0;
+    m_changeActiveWindowAfter = -1;
+}
+
+QList<int> AutoTypePlatformTest::actionBatches()
+{
+    return m_actionBatches;
+}
+
+int AutoTypePlatformTest::activeWindowChecks()
+{
+    return m_activeWindowChecks;
+}
+
+/**
+ * Report another active window once activeWindow() was called the given
+ * number of times.
+ */
+void AutoTypePlatformTest::changeActiveWindowAfter(int checks)
+{
+    m_changeActiveWindowAfter = checks;
 }
 
 void AutoTypePlatformTest::addActionChar(AutoTypeChar* action)
@@ -103,6 +130,14 @@ void AutoTypePlatformTest::addActionKey(AutoTypeKey* action)
     m_actionChars.append(keyToString(action->key));
 }
 
+void AutoTypePlatformTest::endActionBatch()
+{
+    if (m_actionList.size() > m_batchStart) {
+        m_actionBatches.append(m_actionList.size() - m_batchStart);
+    }
+    m_batchStart = m_actionList.size();
+}
+
 int AutoTypePlatformTest::initialTimeout()
 {
     return 0;
@@ -141,3 +176,8 @@ void AutoTypeExecutorTest::execKey(AutoTypeKey* action)
 {
     m_platform->addActionKey(action);
 }
+
+void AutoTypeExecutorTest::flush()
+{
+    m_platform->endActionBatch();
+}
@@ -56,9 +56,13 @@ public:
     QString actionChars() override;
     int actionCount() override;
     void clearActions() override;
+    QList<int> actionBatches() override;
+    int activeWindowChecks() override;
+    void changeActiveWindowAfter(int checks) override;
 
     void addActionChar(AutoTypeChar* action);
     void addActionKey(AutoTypeKey* action);
+    void endActionBatch();
 
 signals:
     void globalShortcutTriggered();
@@ -67,6 +71,10 @@ private:
     QString m_activeWindowTitle;
     QList<AutoTypeAction*> m_actionList;
     QString m_actionChars;
+    QList<int> m_actionBatches;
+    int m_batchStart = 0;
+    int m_activeWindowChecks = 0;
+    int m_changeActiveWindowAfter = -1;
 };
 
 class AutoTypeExecutorTest : public AutoTypeExecutor
@@ -76,6 +84,7 @@ public:
 
     void execChar(AutoTypeChar* action) override;
     void execKey(AutoTypeKey* action) override;
+    void flush() override;
 
 private:
     AutoTypePlatformTest* const m_platform;
@@ -29,6 +29,9 @@ public:
     virtual QString actionChars() = 0;
     virtual int actionCount() = 0;
     virtual void clearActions() = 0;
+    virtual QList<int> actionBatches() = 0;
+    virtual int activeWindowChecks() = 0;
+    virtual void changeActiveWindowAfter(int checks) = 0;
 
     virtual QString keyToString(Qt::Key key) = 0;
 };
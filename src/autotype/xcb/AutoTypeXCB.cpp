@@ -51,8 +51,7 @@ AutoTypePlatformX11::AutoTypePlatformX11()
 
     m_keysymTable = nullptr;
     m_xkb = nullptr;
-    m_remapKeycode = 0;
-    m_currentRemapKeysym = NoSymbol;
+    m_modifiersValid = false;
     m_modifierMask = ControlMask | ShiftMask | Mod1Mask | Mod4Mask;
 
     m_loaded = true;
@@ -88,8 +87,16 @@ bool AutoTypePlatformX11::isAvailable()
 void AutoTypePlatformX11::unload()
 {
     // Restore the KeyboardMapping to its original state.
-    if (m_currentRemapKeysym != NoSymbol) {
-        AddKeysym(NoSymbol);
+    if (!m_remappedKeysyms.isEmpty()) {
+        for (int keycode : asConst(m_remappedKeysyms)) {
+            int inx = (keycode - m_minKeycode) * m_keysymPerKeycode;
+            for (int i = 0; i < m_keysymPerKeycode; i++) {
+                m_keysymTable[inx + i] = NoSymbol;
+            }
+            XChangeKeyboardMapping(m_dpy, keycode, m_keysymPerKeycode, &m_keysymTable[inx], 1);
+        }
+        m_remappedKeysyms.clear();
+        XFlush(m_dpy);
     }
 
     if (m_keysymTable) {
@@ -512,18 +519,20 @@ void AutoTypePlatformX11::updateKeymap()
             m_minKeycode, m_maxKeycode - m_minKeycode + 1,
             &m_keysymPerKeycode);
 
-    /* determine the keycode to use for remapped keys */
-    inx = (m_remapKeycode - m_minKeycode) * m_keysymPerKeycode;
-    if (m_remapKeycode == 0 || !isRemapKeycodeValid()) {
-        for (keycode = m_minKeycode; keycode <= m_maxKeycode; keycode++) {
-            inx = (keycode - m_minKeycode) * m_keysymPerKeycode;
-            if (m_keysymTable[inx] == NoSymbol) {
-               m_remapKeycode = keycode;
-               m_currentRemapKeysym = NoSymbol;
-               break;
-            }
+    /* determine the keycodes to use for remapped keys: unused ones and
+       the ones that still hold a keysym remapped before */
+    QHash<KeySym, int> remappedKeysyms;
+    m_remapKeycodes.clear();
+    for (keycode = m_minKeycode; keycode <= m_maxKeycode; keycode++) {
+        inx = (keycode - m_minKeycode) * m_keysymPerKeycode;
+        if (m_keysymTable[inx] == NoSymbol) {
+            m_remapKeycodes.append(keycode);
+        } else if (m_remappedKeysyms.value(m_keysymTable[inx]) == keycode) {
+            m_remapKeycodes.append(keycode);
+            remappedKeysyms.insert(m_keysymTable[inx], keycode);
         }
     }
+    m_remappedKeysyms = remappedKeysyms;
 
     /* determine the keycode to use for modifiers */
     modifiers = XGetModifierMapping(m_dpy);
@@ -539,25 +548,8 @@ void AutoTypePlatformX11::updateKeymap()
     }
     XFreeModifiermap(modifiers);
 
-    /* Xlib needs some time until the mapping is distributed to
-       all clients */
     // TODO: we should probably only sleep while in the middle of typing something
-    timespec ts;
-    ts.tv_sec = 0;
-    ts.tv_nsec = 30 * 1000 * 1000;
-    nanosleep(&ts, nullptr);
-}
-
-bool AutoTypePlatformX11::isRemapKeycodeValid()
-{
-    int baseKeycode = (m_remapKeycode - m_minKeycode) * m_keysymPerKeycode;
-    for (int i = 0; i < m_keysymPerKeycode; i++) {
-        if (m_keysymTable[baseKeycode + i] == m_currentRemapKeysym) {
-            return true;
-        }
-    }
-
-    return false;
+    WaitForMapping();
 }
 
 void AutoTypePlatformX11::startCatchXErrors()
@@ -616,40 +608,107 @@ XkbDescPtr AutoTypePlatformX11::getKeyboard()
 // --------------------------------------------------------------------------
 
 /*
- * Insert a specified keysym on the dedicated position in the keymap
- * table.
+ * Insert a specified keysym on the least recently used spare keycode.
+ * Returns 0 if there is no spare keycode.
  */
 int AutoTypePlatformX11::AddKeysym(KeySym keysym)
 {
-    if (m_remapKeycode == 0) {
+    if (m_remapKeycodes.isEmpty()) {
         return 0;
     }
 
-    int inx = (m_remapKeycode- m_minKeycode) * m_keysymPerKeycode;
-    m_keysymTable[inx] = keysym;
-    m_currentRemapKeysym = keysym;
+    int keycode = m_remapKeycodes.takeFirst();
+    m_remapKeycodes.append(keycode);
+    m_remappedKeysyms.remove(m_remappedKeysyms.key(keycode, NoSymbol));
+    m_remappedKeysyms.insert(keysym, keycode);
 
-    XChangeKeyboardMapping(m_dpy, m_remapKeycode, m_keysymPerKeycode, &m_keysymTable[inx], 1);
-    XFlush(m_dpy);
-    updateKeymap();
+    /* fill every column, so the keysym doesn't depend on the modifiers */
+    int inx = (keycode - m_minKeycode) * m_keysymPerKeycode;
+    for (int i = 0; i < m_keysymPerKeycode; i++) {
+        m_keysymTable[inx + i] = keysym;
+    }
+    XChangeKeyboardMapping(m_dpy, keycode, m_keysymPerKeycode, &m_keysymTable[inx], 1);
 
-    return m_remapKeycode;
+    return keycode;
 }
 
 /*
- * Send event to the focused window.
- * If input focus is specified explicitly, select the window
- * before send event to the window.
+ * Remap all keysyms of a sequence that the keyboard layout doesn't have
+ * before typing it, so the mapping only changes once. Keysyms that don't
+ * fit on the spare keycodes are remapped one by one while typing.
  */
-void AutoTypePlatformX11::SendKeyEvent(unsigned keycode, bool press)
+void AutoTypePlatformX11::RemapKeysyms(const QList<KeySym>& keysyms)
 {
-    XSync(m_dpy, False);
-    int (*oldHandler) (Display*, XErrorEvent*) = XSetErrorHandler(MyErrorHandler);
+    QSet<KeySym> seen;
+    QList<KeySym> missing;
+    int available = m_remapKeycodes.size();
+
+    for (KeySym keysym : keysyms) {
+        if (keysym == NoSymbol || seen.contains(keysym)) {
+            continue;
+        }
+        seen.insert(keysym);
+
+        int keycode = m_remappedKeysyms.value(keysym, 0);
+        if (keycode) {
+            /* still mapped, don't reuse it for this sequence */
+            m_remapKeycodes.removeOne(keycode);
+            m_remapKeycodes.append(keycode);
+            available--;
+            continue;
+        }
+
+        unsigned int mask;
+        keycode = XKeysymToKeycode(m_dpy, keysym);
+        if (!keycode || !keysymModifiers(keysym, keycode, &mask)) {
+            missing.append(keysym);
+        }
+    }
+
+    if (missing.isEmpty() || available <= 0) {
+        return;
+    }
+
+    for (int i = 0; i < missing.size() && i < available; i++) {
+        AddKeysym(missing.at(i));
+    }
 
-    XTestFakeKeyEvent(m_dpy, keycode, press, 0);
     XFlush(m_dpy);
+    WaitForMapping();
+}
 
+/*
+ * Send all queued key events and report errors they caused.
+ */
+void AutoTypePlatformX11::FlushKeyEvents()
+{
+    int (*oldHandler) (Display*, XErrorEvent*) = XSetErrorHandler(MyErrorHandler);
+    XSync(m_dpy, False);
     XSetErrorHandler(oldHandler);
+
+    /* the user may change the modifiers between batches */
+    m_modifiersValid = false;
+}
+
+/*
+ * Xlib needs some time until a changed mapping is distributed to all
+ * clients.
+ */
+void AutoTypePlatformX11::WaitForMapping()
+{
+    timespec ts;
+    ts.tv_sec = 0;
+    ts.tv_nsec = 30 * 1000 * 1000;
+    nanosleep(&ts, nullptr);
+}
+
+/*
+ * Queue a key event for the focused window. It is sent with the next
+ * FlushKeyEvents().
+ */
+void AutoTypePlatformX11::SendKeyEvent(unsigned keycode, bool press)
+{
+    XTestFakeKeyEvent(m_dpy, keycode, press, 0);
 }
 
 /*
@@ -672,7 +731,14 @@ void AutoTypePlatformX11::SendModifiers(unsigned int mask, bool press)
  */
 int AutoTypePlatformX11::GetKeycode(KeySym keysym, unsigned int *mask)
 {
-    int keycode = XKeysymToKeycode(m_dpy, keysym);
+    /* remapped keycodes hold the keysym in every column */
+    int keycode = m_remappedKeysyms.value(keysym, 0);
+    if (keycode) {
+        *mask = 0;
+        return keycode;
+    }
+
+    keycode = XKeysymToKeycode(m_dpy, keysym);
 
     if (keycode && keysymModifiers(keysym, keycode, mask)) {
         return keycode;
@@ -680,7 +746,11 @@ int AutoTypePlatformX11::GetKeycode(KeySym keysym, unsigned int *mask)
 
     /* no modifier matches => resort to remapping */
     keycode = AddKeysym(keysym);
-    if (keycode && keysymModifiers(keysym, keycode, mask)) {
+    if (keycode) {
+        /* the events queued so far must not see the new mapping */
+        XFlush(m_dpy);
+        WaitForMapping();
+        *mask = 0;
         return keycode;
     }
 
@@ -734,12 +804,15 @@ void AutoTypePlatformX11::SendKey(KeySym keysym, unsigned int modifiers)
     }
     wanted_mask |= modifiers;
 
-    Window root, child;
-    int root_x, root_y, x, y;
-    unsigned int original_mask;
+    /* query the pressed modifiers once per batch of key events */
+    if (!m_modifiersValid) {
+        Window root, child;
+        int root_x, root_y, x, y;
 
-    XSync(m_dpy, False);
-    XQueryPointer(m_dpy, m_rootWindow, &root, &child, &root_x, &root_y, &x, &y, &original_mask);
+        XQueryPointer(m_dpy, m_rootWindow, &root, &child, &root_x, &root_y, &x, &y, &m_modifiers);
+        m_modifiersValid = true;
+    }
+    unsigned int original_mask = m_modifiers;
 
     // modifiers that need to be pressed but aren't
     unsigned int press_mask = wanted_mask & ~original_mask;
@@ -816,6 +889,20 @@ AutoTypeExecutorX11::AutoTypeExecutorX11(AutoTypePlatformX11* platform)
 {
 }
 
+void AutoTypeExecutorX11::prepare(const QList<AutoTypeAction*>& actions)
+{
+    QList<KeySym> keysyms;
+    for (AutoTypeAction* action : actions) {
+        if (AutoTypeChar* charAction = dynamic_cast<AutoTypeChar*>(action)) {
+            keysyms.append(m_platform->charToKeySym(charAction->character));
+        } else if (AutoTypeKey* keyAction = dynamic_cast<AutoTypeKey*>(action)) {
+            keysyms.append(m_platform->keyToKeySym(keyAction->key));
+        }
+    }
+
+    m_platform->RemapKeysyms(keysyms);
+}
+
 void AutoTypeExecutorX11::execChar(AutoTypeChar* action)
 {
     m_platform->SendKey(m_platform->charToKeySym(action->character));
@@ -826,6 +913,13 @@ void AutoTypeExecutorX11::execKey(AutoTypeKey* action)
     m_platform->SendKey(m_platform->keyToKeySym(action->key));
 }
 
+void AutoTypeExecutorX11::execDelay(AutoTypeDelay* action)
+{
+    // the keys typed so far have to arrive before the delay
+    m_platform->FlushKeyEvents();
+    AutoTypeExecutor::execDelay(action);
+}
+
 void AutoTypeExecutorX11::execClearField(AutoTypeClearField* action = nullptr)
 {
     Q_UNUSED(action);
@@ -835,15 +929,23 @@ void AutoTypeExecutorX11::execClearField(AutoTypeClearField* action = nullptr)
     ts.tv_nsec = 25 * 1000 * 1000;
 
     m_platform->SendKey(m_platform->keyToKeySym(Qt::Key_Home), static_cast<unsigned int>(ControlMask));
+    m_platform->FlushKeyEvents();
     nanosleep(&ts, nullptr);
 
     m_platform->SendKey(m_platform->keyToKeySym(Qt::Key_End), static_cast<unsigned int>(ControlMask | ShiftMask));
+    m_platform->FlushKeyEvents();
     nanosleep(&ts, nullptr);
 
     m_platform->SendKey(m_platform->keyToKeySym(Qt::Key_Backspace));
+    m_platform->FlushKeyEvents();
     nanosleep(&ts, nullptr);
 }
 
+void AutoTypeExecutorX11::flush()
+{
+    m_platform->FlushKeyEvents();
+}
+
 
 int AutoTypePlatformX11::initialTimeout()
 {
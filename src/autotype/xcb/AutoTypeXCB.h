@@ -21,6 +21,7 @@
 #define KEEPASSX_AUTOTYPEXCB_H
 
 #include <QApplication>
+#include <QHash>
 #include <QSet>
 #include <QtPlugin>
 #include <QWidget>
@@ -59,6 +60,8 @@ public:
     KeySym keyToKeySym(Qt::Key key);
 
     void SendKey(KeySym keysym, unsigned int modifiers = 0);
+    void RemapKeysyms(const QList<KeySym>& keysyms);
+    void FlushKeyEvents();
 
 signals:
     void globalShortcutTriggered();
@@ -76,8 +79,8 @@ private:
 
     XkbDescPtr getKeyboard();
     void updateKeymap();
-    bool isRemapKeycodeValid();
     int AddKeysym(KeySym keysym);
+    void WaitForMapping();
     void AddModifier(KeySym keysym);
     void SendKeyEvent(unsigned keycode, bool press);
     void SendModifiers(unsigned int mask, bool press);
@@ -113,9 +116,11 @@ private:
     int m_minKeycode;
     int m_maxKeycode;
     int m_keysymPerKeycode;
-    /* dedicated keycode for remapped keys */
-    unsigned int m_remapKeycode;
-    KeySym m_currentRemapKeysym;
+    /* spare keycodes for remapped keys, least recently used first */
+    QList<int> m_remapKeycodes;
+    QHash<KeySym, int> m_remappedKeysyms;
+    unsigned int m_modifiers;
+    bool m_modifiersValid;
     KeyCode m_modifier_keycode[N_MOD_INDICES];
     bool m_loaded;
 };
@@ -125,9 +130,12 @@ class AutoTypeExecutorX11 : public AutoTypeExecutor
 public:
     explicit AutoTypeExecutorX11(AutoTypePlatformX11* platform);
 
+    void prepare(const QList<AutoTypeAction*>& actions) override;
     void execChar(AutoTypeChar* action) override;
     void execKey(AutoTypeKey* action) override;
+    void execDelay(AutoTypeDelay* action) override;
     void execClearField(AutoTypeClearField* action) override;
+    void flush() override;
 
 private:
     AutoTypePlatformX11* const m_platform;
@@ -33,6 +33,16 @@ BrowserAction::BrowserAction(BrowserService& browserService) :
 
 }
 
+BrowserAction::~BrowserAction()
+{
+    if (!m_sharedKey.empty()) {
+        sodium_memzero(m_sharedKey.data(), m_sharedKey.size());
+    }
+    if (!m_buffer.empty()) {
+        sodium_memzero(m_buffer.data(), m_buffer.size());
+    }
+}
+
 QJsonObject BrowserAction::readResponse(const QJsonObject& json)
 {
     if (json.isEmpty()) {
@@ -50,16 +60,30 @@ QJsonObject BrowserAction::readResponse(const QJsonObject& json)
         return QJsonObject();
     }
 
-    QMutexLocker locker(&m_mutex);
+    // Several requests of the same client may be in flight on different
+    // threads. m_mutex only guards the client state, it is never held while
+    // BrowserService waits for the GUI thread.
+    QJsonObject response;
     if (action.compare("change-public-keys", Qt::CaseSensitive) != 0 && !m_browserService.isDatabaseOpened()) {
-        if (m_clientPublicKey.isEmpty()) {
-            return getErrorReply(action, ERROR_KEEPASS_CLIENT_PUBLIC_KEY_NOT_RECEIVED);
+        if (clientPublicKey().isEmpty()) {
+            response = getErrorReply(action, ERROR_KEEPASS_CLIENT_PUBLIC_KEY_NOT_RECEIVED);
         } else if (!m_browserService.openDatabase(triggerUnlock)) {
-            return getErrorReply(action, ERROR_KEEPASS_DATABASE_NOT_OPENED);
+            response = getErrorReply(action, ERROR_KEEPASS_DATABASE_NOT_OPENED);
         }
     }
 
-    return handleAction(json);
+    if (response.isEmpty()) {
+        response = handleAction(json);
+    }
+
+    // Replies may complete out of order, let the client match error replies
+    // to their request as well
+    const QString nonce = json.value("nonce").toString();
+    if (!response.isEmpty() && !response.contains("nonce") && !nonce.isEmpty()) {
+        response["nonce"] = incrementNonce(nonce);
+    }
+
+    return response;
 }
 
 
@@ -105,16 +129,31 @@ QJsonObject BrowserAction::handleChangePublicKeys(const QJsonObject& json, const
         return getErrorReply(action, ERROR_KEEPASS_CLIENT_PUBLIC_KEY_NOT_RECEIVED);
     }
 
+    const QByteArray clientKey = base64Decode(clientPublicKey);
+    if (clientKey.size() != static_cast<int>(crypto_box_PUBLICKEYBYTES)) {
+        return getErrorReply(action, ERROR_KEEPASS_CLIENT_PUBLIC_KEY_NOT_RECEIVED);
+    }
+
     m_associated = false;
     unsigned char pk[crypto_box_PUBLICKEYBYTES];
     unsigned char sk[crypto_box_SECRETKEYBYTES];
     crypto_box_keypair(pk, sk);
 
+    // Do the key agreement once per client, messages only need the shared key
+    std::vector<unsigned char> sharedKey(crypto_box_BEFORENMBYTES);
+    const int result = crypto_box_beforenm(sharedKey.data(), reinterpret_cast<const unsigned char*>(clientKey.constData()), sk);
+    sodium_memzero(sk, sizeof(sk));
+    if (result != 0) {
+        return getErrorReply(action, ERROR_KEEPASS_KEY_CHANGE_FAILED);
+    }
+
     const QString publicKey = getBase64FromKey(pk, crypto_box_PUBLICKEYBYTES);
-    const QString secretKey = getBase64FromKey(sk, crypto_box_SECRETKEYBYTES);
     m_clientPublicKey = clientPublicKey;
     m_publicKey = publicKey;
-    m_secretKey = secretKey;
+    if (!m_sharedKey.empty()) {
+        sodium_memzero(m_sharedKey.data(), m_sharedKey.size());
+    }
+    m_sharedKey.swap(sharedKey);
 
     QJsonObject response = buildMessage(incrementNonce(nonce));
     response["action"] = action;
@@ -166,14 +205,13 @@ QJsonObject BrowserAction::handleAssociate(const QJsonObject& json, const QStrin
         return getErrorReply(action, ERROR_KEEPASS_ASSOCIATION_FAILED);
     }
 
-    QMutexLocker locker(&m_mutex);
-    if (key.compare(m_clientPublicKey, Qt::CaseSensitive) == 0) {
+    if (key.compare(clientPublicKey(), Qt::CaseSensitive) == 0) {
         const QString id = m_browserService.storeKey(key);
         if (id.isEmpty()) {
             return getErrorReply(action, ERROR_KEEPASS_ACTION_CANCELLED_OR_DENIED);
         }
 
-        m_associated = true;
+        setAssociated(true);
         const QString newNonce = incrementNonce(nonce);
 
         QJsonObject message = buildMessage(newNonce);
@@ -202,13 +240,12 @@ QJsonObject BrowserAction::handleTestAssociate(const QJsonObject& json, const QS
         return getErrorReply(action, ERROR_KEEPASS_DATABASE_NOT_OPENED);
     }
 
-    QMutexLocker locker(&m_mutex);
     const QString key = m_browserService.getKey(id);
     if (key.isEmpty() || key.compare(responseKey, Qt::CaseSensitive) != 0) {
         return getErrorReply(action, ERROR_KEEPASS_ASSOCIATION_FAILED);
     }
 
-    m_associated = true;
+    setAssociated(true);
     const QString newNonce = incrementNonce(nonce);
 
     QJsonObject message = buildMessage(newNonce);
@@ -224,8 +261,7 @@ QJsonObject BrowserAction::handleGetLogins(const QJsonObject& json, const QStrin
     const QString nonce = json.value("nonce").toString();
     const QString encrypted = json.value("message").toString();
 
-    QMutexLocker locker(&m_mutex);
-    if (!m_associated) {
+    if (!isAssociated()) {
         return getErrorReply(action, ERROR_KEEPASS_ASSOCIATION_FAILED);
     }
 
@@ -288,8 +324,7 @@ QJsonObject BrowserAction::handleSetLogin(const QJsonObject& json, const QString
     const QString nonce = json.value("nonce").toString();
     const QString encrypted = json.value("message").toString();
 
-    QMutexLocker locker(&m_mutex);
-    if (!m_associated) {
+    if (!isAssociated()) {
         return getErrorReply(action, ERROR_KEEPASS_ASSOCIATION_FAILED);
     }
 
@@ -344,7 +379,6 @@ QJsonObject BrowserAction::handleLockDatabase(const QJsonObject& json, const QSt
 
     QString command = decrypted.value("action").toString();
     if (!command.isEmpty() && command.compare("lock-database", Qt::CaseSensitive) == 0) {
-        QMutexLocker locker(&m_mutex);
         m_browserService.lockDatabase();
 
         const QString newNonce = incrementNonce(nonce);
@@ -407,7 +441,6 @@ QString BrowserAction::getErrorMessage(const int errorCode) const
 
 QString BrowserAction::getDatabaseHash()
 {
-    QMutexLocker locker(&m_mutex);
     QByteArray hash = QCryptographicHash::hash(
         (m_browserService.getDatabaseRootUuid() + m_browserService.getDatabaseRecycleBinUuid()).toUtf8(),
          QCryptographicHash::Sha256).toHex();
@@ -447,23 +480,19 @@ QString BrowserAction::encrypt(const QString plaintext, const QString nonce)
     QMutexLocker locker(&m_mutex);
     const QByteArray ma = plaintext.toUtf8();
     const QByteArray na = base64Decode(nonce);
-    const QByteArray ca = base64Decode(m_clientPublicKey);
-    const QByteArray sa = base64Decode(m_secretKey);
-
-    std::vector<unsigned char> m(ma.cbegin(), ma.cend());
-    std::vector<unsigned char> n(na.cbegin(), na.cend());
-    std::vector<unsigned char> ck(ca.cbegin(), ca.cend());
-    std::vector<unsigned char> sk(sa.cbegin(), sa.cend());
-
-    std::vector<unsigned char> e;
-    e.resize(max_length);
 
-    if (m.empty() || n.empty() || ck.empty() || sk.empty()) {
+    if (ma.isEmpty() || na.size() != static_cast<int>(crypto_box_NONCEBYTES) || m_sharedKey.empty()) {
         return QString();
     }
 
-    if (crypto_box_easy(e.data(), m.data(), m.size(), n.data(), ck.data(), sk.data()) == 0) {
-       QByteArray res = getQByteArray(e.data(), (crypto_box_MACBYTES + ma.length()));
+    const size_t length = crypto_box_MACBYTES + ma.size();
+    if (m_buffer.size() < length) {
+        m_buffer.resize(length);
+    }
+
+    if (crypto_box_easy_afternm(m_buffer.data(), reinterpret_cast<const unsigned char*>(ma.constData()), ma.size(),
+                                reinterpret_cast<const unsigned char*>(na.constData()), m_sharedKey.data()) == 0) {
+       QByteArray res = getQByteArray(m_buffer.data(), length);
        return res.toBase64();
     }
 
@@ -475,23 +504,21 @@ QByteArray BrowserAction::decrypt(const QString encrypted, const QString nonce)
     QMutexLocker locker(&m_mutex);
     const QByteArray ma = base64Decode(encrypted);
     const QByteArray na = base64Decode(nonce);
-    const QByteArray ca = base64Decode(m_clientPublicKey);
-    const QByteArray sa = base64Decode(m_secretKey);
-
-    std::vector<unsigned char> m(ma.cbegin(), ma.cend());
-    std::vector<unsigned char> n(na.cbegin(), na.cend());
-    std::vector<unsigned char> ck(ca.cbegin(), ca.cend());
-    std::vector<unsigned char> sk(sa.cbegin(), sa.cend());
 
-    std::vector<unsigned char> d;
-    d.resize(max_length);
-
-    if (m.empty() || n.empty() || ck.empty() || sk.empty()) {
+    if (ma.size() <= static_cast<int>(crypto_box_MACBYTES) || na.size() != static_cast<int>(crypto_box_NONCEBYTES) || m_sharedKey.empty()) {
         return QByteArray();
     }
 
-    if (crypto_box_open_easy(d.data(), m.data(), ma.length(), n.data(), ck.data(), sk.data()) == 0) {
-        return getQByteArray(d.data(), std::char_traits<char>::length(reinterpret_cast<const char *>(d.data())));
+    const size_t length = ma.size() - crypto_box_MACBYTES;
+    if (m_buffer.size() < length) {
+        m_buffer.resize(length);
+    }
+
+    if (crypto_box_open_easy_afternm(m_buffer.data(), reinterpret_cast<const unsigned char*>(ma.constData()), ma.size(),
+                                     reinterpret_cast<const unsigned char*>(na.constData()), m_sharedKey.data()) == 0) {
+        QByteArray res = getQByteArray(m_buffer.data(), length);
+        sodium_memzero(m_buffer.data(), length);
+        return res;
     }
 
     return QByteArray();
@@ -541,14 +568,30 @@ QString BrowserAction::incrementNonce(const QString& nonce)
     return getQByteArray(n.data(), n.size()).toBase64();
 }
 
-void BrowserAction::removeSharedEncryptionKeys()
+QString BrowserAction::clientPublicKey()
 {
     QMutexLocker locker(&m_mutex);
+    return m_clientPublicKey;
+}
+
+bool BrowserAction::isAssociated()
+{
+    QMutexLocker locker(&m_mutex);
+    return m_associated;
+}
+
+void BrowserAction::setAssociated(bool associated)
+{
+    QMutexLocker locker(&m_mutex);
+    m_associated = associated;
+}
+
+void BrowserAction::removeSharedEncryptionKeys()
+{
     m_browserService.removeSharedEncryptionKeys();
 }
 
 void BrowserAction::removeStoredPermissions()
 {
-    QMutexLocker locker(&m_mutex);
     m_browserService.removeStoredPermissions();
 }
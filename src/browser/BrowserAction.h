@@ -23,6 +23,7 @@
 #include <QObject>
 #include <QJsonObject>
 #include <QMutex>
+#include <vector>
 #include "BrowserService.h"
 
 class BrowserAction : public QObject
@@ -49,7 +50,7 @@ class BrowserAction : public QObject
 
 public:
     BrowserAction(BrowserService& browserService);
-    ~BrowserAction() = default;
+    ~BrowserAction();
 
     QJsonObject readResponse(const QJsonObject& json);
 
@@ -85,13 +86,17 @@ private:
     QJsonObject getJsonObject(const QByteArray ba) const;
     QByteArray  base64Decode(const QString str);
     QString     incrementNonce(const QString& nonce);
+    QString     clientPublicKey();
+    bool        isAssociated();
+    void        setAssociated(bool associated);
 
 private:
     QMutex              m_mutex;
     BrowserService&     m_browserService;
     QString             m_clientPublicKey;
     QString             m_publicKey;
-    QString             m_secretKey;
+    std::vector<unsigned char> m_sharedKey;
+    std::vector<unsigned char> m_buffer;
     bool                m_associated;
 };
 
@@ -21,14 +21,19 @@
 #include <QInputDialog>
 #include <QProgressDialog>
 #include <QMessageBox>
+#include <QtConcurrent>
 #include "BrowserService.h"
 #include "BrowserSettings.h"
 #include "BrowserEntryConfig.h"
 #include "BrowserAccessControlDialog.h"
 #include "core/Database.h"
+#include "core/Global.h"
 #include "core/Group.h"
-#include "core/EntrySearcher.h"
+#include "core/GuiThreadDispatcher.h"
+#include "core/EntryHostIndex.h"
+#include "core/EntryRanker.h"
 #include "core/Metadata.h"
+#include "core/PublicSuffixList.h"
 #include "core/Uuid.h"
 #include "core/PasswordGenerator.h"
 #include "gui/MainWindow.h"
@@ -47,7 +52,11 @@ static int        KEEPASSXCBROWSER_DEFAULT_ICON = 1;
 
 BrowserService::BrowserService(DatabaseTabWidget* parent) :
     m_dbTabWidget(parent),
-    m_dialogActive(false)
+    m_dialogActive(false),
+    m_dispatcher(this),
+    m_responseCache(MaxCachedResponses),
+    m_cacheHits(0),
+    m_cacheMisses(0)
 {
     connect(m_dbTabWidget, SIGNAL(databaseLocked(DatabaseWidget*)), this, SLOT(databaseLocked(DatabaseWidget*)));
     connect(m_dbTabWidget, SIGNAL(databaseUnlocked(DatabaseWidget*)), this, SLOT(databaseUnlocked(DatabaseWidget*)));
@@ -56,6 +65,11 @@ BrowserService::BrowserService(DatabaseTabWidget* parent) :
 
 bool BrowserService::isDatabaseOpened() const
 {
+    bool result = false;
+    if (m_dispatcher.dispatch("isDatabaseOpened", GuiThreadDispatcher::Shared, Q_RETURN_ARG(bool, result))) {
+        return result;
+    }
+
     DatabaseWidget* dbWidget = m_dbTabWidget->currentDatabaseWidget();
     if (!dbWidget) {
         return false;
@@ -67,6 +81,12 @@ bool BrowserService::isDatabaseOpened() const
 
 bool BrowserService::openDatabase(bool triggerUnlock)
 {
+    bool result = false;
+    if (m_dispatcher.dispatch("openDatabase", GuiThreadDispatcher::Exclusive, Q_RETURN_ARG(bool, result),
+                              Q_ARG(bool, triggerUnlock))) {
+        return result;
+    }
+
     if (!BrowserSettings::unlockDatabase()) {
         return false;
     }
@@ -89,8 +109,8 @@ bool BrowserService::openDatabase(bool triggerUnlock)
 
 void BrowserService::lockDatabase()
 {
-    if (thread() != QThread::currentThread()) {
-        QMetaObject::invokeMethod(this, "lockDatabase", Qt::BlockingQueuedConnection);
+    if (m_dispatcher.dispatch("lockDatabase", GuiThreadDispatcher::Exclusive)) {
+        return;
     }
 
     DatabaseWidget* dbWidget = m_dbTabWidget->currentDatabaseWidget();
@@ -105,6 +125,11 @@ void BrowserService::lockDatabase()
 
 QString BrowserService::getDatabaseRootUuid()
 {
+    QString result;
+    if (m_dispatcher.dispatch("getDatabaseRootUuid", GuiThreadDispatcher::Shared, Q_RETURN_ARG(QString, result))) {
+        return result;
+    }
+
     Database* db = getDatabase();
     if (!db) {
         return QString();
@@ -120,6 +145,11 @@ QString BrowserService::getDatabaseRootUuid()
 
 QString BrowserService::getDatabaseRecycleBinUuid()
 {
+    QString result;
+    if (m_dispatcher.dispatch("getDatabaseRecycleBinUuid", GuiThreadDispatcher::Shared, Q_RETURN_ARG(QString, result))) {
+        return result;
+    }
+
     Database* db = getDatabase();
     if (!db) {
         return QString();
@@ -166,10 +196,8 @@ QString BrowserService::storeKey(const QString& key)
 {
     QString id;
 
-    if (thread() != QThread::currentThread()) {
-        QMetaObject::invokeMethod(this, "storeKey", Qt::BlockingQueuedConnection,
-                                  Q_RETURN_ARG(QString, id),
-                                  Q_ARG(const QString&, key));
+    if (m_dispatcher.dispatch("storeKey", GuiThreadDispatcher::Exclusive, Q_RETURN_ARG(QString, id),
+                              Q_ARG(const QString&, key))) {
         return id;
     }
 
@@ -216,6 +244,12 @@ QString BrowserService::storeKey(const QString& key)
 
 QString BrowserService::getKey(const QString& id)
 {
+    QString result;
+    if (m_dispatcher.dispatch("getKey", GuiThreadDispatcher::Shared, Q_RETURN_ARG(QString, result),
+                              Q_ARG(const QString&, id))) {
+        return result;
+    }
+
     Entry* config = getConfigEntry();
     if (!config) {
         return QString();
@@ -227,15 +261,28 @@ QString BrowserService::getKey(const QString& id)
 QJsonArray BrowserService::findMatchingEntries(const QString& id, const QString& url, const QString& submitUrl, const QString& realm)
 {
     QJsonArray result;
-    if (thread() != QThread::currentThread()) {
-        QMetaObject::invokeMethod(this, "findMatchingEntries", Qt::BlockingQueuedConnection,
-                                  Q_RETURN_ARG(QJsonArray, result),
-                                  Q_ARG(const QString&, id),
-                                  Q_ARG(const QString&, url),
-                                  Q_ARG(const QString&, submitUrl),
-                                  Q_ARG(const QString&, realm));
+    QJsonValue cached;
+    if (m_dispatcher.dispatch("findCachedEntries", GuiThreadDispatcher::Shared,
+                              Q_RETURN_ARG(QJsonValue, cached),
+                              Q_ARG(const QString&, id), Q_ARG(const QString&, url),
+                              Q_ARG(const QString&, submitUrl), Q_ARG(const QString&, realm))) {
+        // A cached reply never needs a confirmation, so it doesn't wait for
+        // another request's access dialog
+        if (cached.isArray()) {
+            return cached.toArray();
+        }
+        m_dispatcher.dispatch("findMatchingEntries", GuiThreadDispatcher::Exclusive,
+                              Q_RETURN_ARG(QJsonArray, result),
+                              Q_ARG(const QString&, id), Q_ARG(const QString&, url),
+                              Q_ARG(const QString&, submitUrl), Q_ARG(const QString&, realm));
+        return result;
+    }
+
+    const QString cacheKey = responseCacheKey(id, url, submitUrl, realm);
+    if (cachedResponse(cacheKey, result)) {
         return result;
     }
+    ++m_cacheMisses;
 
     const bool alwaysAllowAccess = BrowserSettings::alwaysAllowAccess();
     const QString host = QUrl(url).host();
@@ -263,28 +310,131 @@ QJsonArray BrowserService::findMatchingEntries(const QString& id, const QString&
         }
     }
 
+    // Replies that needed confirmation are not cached: the user has to be
+    // asked again unless the decision was remembered, which modifies the
+    // entries and invalidates the cache anyway
+    const bool cacheable = pwEntriesToConfirm.isEmpty();
+
     // Confirm entries
-    if (confirmEntries(pwEntriesToConfirm, url, host, submitHost, realm)) {
+    const QList<QPointer<Entry>> allowedEntries = GuiThreadDispatcher::guardEntries(pwEntries);
+    const bool confirmed = confirmEntries(pwEntriesToConfirm, url, host, submitHost, realm);
+    pwEntries = GuiThreadDispatcher::liveEntries(allowedEntries);
+    if (confirmed) {
         pwEntries.append(pwEntriesToConfirm);
     }
 
-    if (pwEntries.isEmpty()) {
-        return QJsonArray();
-    }
+    if (!pwEntries.isEmpty()) {
+        // Sort results
+        pwEntries = sortEntries(pwEntries, host, submitUrl);
 
-    // Sort results
-    pwEntries = sortEntries(pwEntries, host, submitUrl);
+        // Fill the list
+        for (Entry* entry : pwEntries) {
+            result << prepareEntry(entry);
+        }
+    }
 
-    // Fill the list
-    for (Entry* entry : pwEntries) {
-        result << prepareEntry(entry);
+    if (cacheable) {
+        cacheResponse(cacheKey, pwEntries);
     }
 
     return result;
 }
 
-void BrowserService::addEntry(const QString&, const QString& login, const QString& password, const QString& url, const QString& submitUrl, const QString& realm)
+/**
+ * The reply to a get-logins request if it is cached, an undefined value
+ * otherwise.
+ */
+QJsonValue BrowserService::findCachedEntries(const QString& id, const QString& url, const QString& submitUrl, const QString& realm)
+{
+    QJsonArray result;
+    if (!cachedResponse(responseCacheKey(id, url, submitUrl, realm), result)) {
+        return QJsonValue(QJsonValue::Undefined);
+    }
+    return result;
+}
+
+QString BrowserService::responseCacheKey(const QString& id, const QString& url, const QString& submitUrl, const QString& realm) const
+{
+    // The settings that affect the reply are part of the key, so changing
+    // them never returns a stale result
+    return QStringList({id, url, submitUrl, realm,
+                        QString::number(BrowserSettings::alwaysAllowAccess()),
+                        QString::number(BrowserSettings::searchInAllDatabases()),
+                        QString::number(BrowserSettings::sortByTitle()),
+                        QString::number(BrowserSettings::supportKphFields())}).join('\n');
+}
+
+bool BrowserService::cachedResponse(const QString& key, QJsonArray& result)
+{
+    // Only the matched entries are cached. The reply is built for every
+    // request as it contains placeholders like {TOTP} that change over time.
+    const CachedResponse* cached = m_responseCache.object(key);
+    if (!cached) {
+        return false;
+    }
+
+    ++m_cacheHits;
+    for (const QPointer<Entry>& entry : cached->entries) {
+        if (entry) {
+            result << prepareEntry(entry);
+        }
+    }
+    return true;
+}
+
+int BrowserService::cacheHits() const
+{
+    return m_cacheHits;
+}
+
+int BrowserService::cacheMisses() const
+{
+    return m_cacheMisses;
+}
+
+void BrowserService::cacheResponse(const QString& key, const QList<Entry*>& entries)
+{
+    CachedResponse* response = new CachedResponse();
+    for (Entry* entry : entries) {
+        response->entries << entry;
+    }
+
+    // Any change to a searched database can change the reply
+    for (Database* db : searchDatabases()) {
+        connect(db, SIGNAL(modifiedImmediate()), this, SLOT(databaseModified()), Qt::UniqueConnection);
+        connect(db, SIGNAL(destroyed()), this, SLOT(databaseModified()), Qt::UniqueConnection);
+        response->databases << db;
+    }
+
+    // A full cache drops the least recently used reply
+    m_responseCache.insert(key, response);
+}
+
+void BrowserService::clearResponseCache()
+{
+    m_responseCache.clear();
+}
+
+void BrowserService::databaseModified()
+{
+    const QObject* db = sender();
+    const QList<QString> keys = m_responseCache.keys();
+    for (const QString& key : keys) {
+        if (m_responseCache.object(key)->databases.contains(db)) {
+            m_responseCache.remove(key);
+        }
+    }
+}
+
+void BrowserService::addEntry(const QString& id, const QString& login, const QString& password, const QString& url, const QString& submitUrl, const QString& realm)
 {
+    if (m_dispatcher.dispatch("addEntry", GuiThreadDispatcher::Exclusive, QGenericReturnArgument(),
+                              Q_ARG(const QString&, id), Q_ARG(const QString&, login),
+                              Q_ARG(const QString&, password), Q_ARG(const QString&, url),
+                              Q_ARG(const QString&, submitUrl), Q_ARG(const QString&, realm))) {
+        return;
+    }
+
     Group* group = findCreateAddEntryGroup();
     if (!group) {
         return;
@@ -315,13 +465,11 @@ void BrowserService::addEntry(const QString&, const QString& login, const QStrin
 
 void BrowserService::updateEntry(const QString& id, const QString& uuid, const QString& login, const QString& password, const QString& url)
 {
-    if (thread() != QThread::currentThread()) {
-        QMetaObject::invokeMethod(this, "updateEntry", Qt::BlockingQueuedConnection,
-                                  Q_ARG(const QString&, id),
-                                  Q_ARG(const QString&, uuid),
-                                  Q_ARG(const QString&, login),
-                                  Q_ARG(const QString&, password),
-                                  Q_ARG(const QString&, url));
+    if (m_dispatcher.dispatch("updateEntry", GuiThreadDispatcher::Exclusive, QGenericReturnArgument(),
+                              Q_ARG(const QString&, id), Q_ARG(const QString&, uuid),
+                              Q_ARG(const QString&, login), Q_ARG(const QString&, password),
+                              Q_ARG(const QString&, url))) {
+        return;
     }
 
     Database* db = getDatabase();
@@ -359,53 +507,38 @@ void BrowserService::updateEntry(const QString& id, const QString& uuid, const Q
 
 QList<Entry*> BrowserService::searchEntries(Database* db, const QString& hostname)
 {
-    QList<Entry*> entries;
-    Group* rootGroup = db->rootGroup();
-    if (!rootGroup) {
-        return entries;
+    if (!db->rootGroup()) {
+        return QList<Entry*>();
     }
 
-    for (Entry* entry : EntrySearcher().search(hostname, rootGroup, Qt::CaseInsensitive)) {
-        QString title = entry->title();
-        QString url = entry->url();
-
-        // Filter to match hostname in Title and Url fields
-        if ((!title.isEmpty() && hostname.contains(title))
-            || (!url.isEmpty() && hostname.contains(url))
-            || (matchUrlScheme(title) && hostname.endsWith(QUrl(title).host()))
-            || (matchUrlScheme(url) && hostname.endsWith(QUrl(url).host())) ) {
-                entries.append(entry);
-        }
-    }
-
-    return entries;
+    return db->hostIndex()->entries(hostname);
 }
 
 QList<Entry*> BrowserService::searchEntries(const QString& text)
 {
-    // Get the list of databases to search
-    QList<Database*> databases;
-    if (BrowserSettings::searchInAllDatabases()) {
-        const int count = m_dbTabWidget->count();
-        for (int i = 0; i < count; ++i) {
-            if (DatabaseWidget* dbWidget = qobject_cast<DatabaseWidget*>(m_dbTabWidget->widget(i))) {
-                if (Database* db = dbWidget->database()) {
-                    databases << db;
-                }
-            }
+    const QList<Database*> databases = searchDatabases();
+
+    // Collect the hostname and its parent domains down to the registrable
+    // domain, most specific first
+    const QStringList hostnames = publicSuffixList()->hostLevels(QUrl(text).host());
+
+    // Match every database on the thread pool. This thread blocks until all
+    // lookups are done, so the databases can't be modified in the meantime.
+    QList<QFuture<QList<Entry*>>> futures;
+    for (Database* db : databases) {
+        if (!db->rootGroup()) {
+            continue;
         }
-    } else if (Database* db = getDatabase()) {
-        databases << db;
+        EntryHostIndex* index = db->hostIndex();
+        futures << QtConcurrent::run([index, hostnames]() {
+            return index->entries(hostnames);
+        });
     }
 
-    // Search entries matching the hostname
-    QString hostname = QUrl(text).host();
     QList<Entry*> entries;
-    do {
-        for (Database* db : databases) {
-            entries << searchEntries(db, hostname);
-        }
-    } while (entries.isEmpty() && removeFirstDomain(hostname));
+    for (QFuture<QList<Entry*>>& future : futures) {
+        entries << future.result();
+    }
 
     return entries;
 }
@@ -504,29 +637,8 @@ void BrowserService::removeStoredPermissions()
 
 QList<Entry*> BrowserService::sortEntries(QList<Entry*>& pwEntries, const QString& host, const QString& entryUrl)
 {
-    QUrl url(entryUrl);
-    if (url.scheme().isEmpty()) {
-        url.setScheme("http");
-    }
-
-    const QString submitUrl = url.toString(QUrl::StripTrailingSlash);
-    const QString baseSubmitUrl = url.toString(QUrl::StripTrailingSlash | QUrl::RemovePath | QUrl::RemoveQuery | QUrl::RemoveFragment);
-
-    QMultiMap<int, const Entry*> priorities;
-    for (const Entry* entry : pwEntries) {
-        priorities.insert(sortPriority(entry, host, submitUrl, baseSubmitUrl), entry);
-    }
-
-    QString field = BrowserSettings::sortByTitle() ? "Title" : "UserName";
-    std::sort(pwEntries.begin(), pwEntries.end(), [&priorities, &field](const Entry* left, const Entry* right) {
-        int res = priorities.key(left) - priorities.key(right);
-        if (res == 0) {
-            return QString::localeAwareCompare(left->attributes()->value(field), right->attributes()->value(field)) < 0;
-        }
-        return res < 0;
-    });
-
-    return pwEntries;
+    const QString field = BrowserSettings::sortByTitle() ? "Title" : "UserName";
+    return EntryRanker(host, entryUrl).sort(pwEntries, field);
 }
 
 bool BrowserService::confirmEntries(QList<Entry*>& pwEntriesToConfirm, const QString& url, const QString& host, const QString& submitHost, const QString& realm)
@@ -540,7 +652,9 @@ bool BrowserService::confirmEntries(QList<Entry*>& pwEntriesToConfirm, const QSt
     accessControlDialog.setUrl(url);
     accessControlDialog.setItems(pwEntriesToConfirm);
 
+    const QList<QPointer<Entry>> entries = GuiThreadDispatcher::guardEntries(pwEntriesToConfirm);
     int res = accessControlDialog.exec();
+    pwEntriesToConfirm = GuiThreadDispatcher::liveEntries(entries);
     if (accessControlDialog.remember()) {
         for (Entry* entry : pwEntriesToConfirm) {
             BrowserEntryConfig config;
@@ -639,74 +753,6 @@ Group* BrowserService::findCreateAddEntryGroup()
     return group;
 }
 
-int BrowserService::sortPriority(const Entry* entry, const QString& host, const QString& submitUrl, const QString& baseSubmitUrl) const
-{
-    QUrl url(entry->url());
-    if (url.scheme().isEmpty()) {
-        url.setScheme("http");
-    }
-    const QString entryURL = url.toString(QUrl::StripTrailingSlash);
-    const QString baseEntryURL = url.toString(QUrl::StripTrailingSlash | QUrl::RemovePath | QUrl::RemoveQuery | QUrl::RemoveFragment);
-
-    if (submitUrl == entryURL) {
-        return 100;
-    }
-    if (submitUrl.startsWith(entryURL) && entryURL != host && baseSubmitUrl != entryURL) {
-        return 90;
-    }
-    if (submitUrl.startsWith(baseEntryURL) && entryURL != host && baseSubmitUrl != baseEntryURL) {
-        return 80;
-    }
-    if (entryURL == host) {
-        return 70;
-    }
-    if (entryURL == baseSubmitUrl) {
-        return 60;
-    }
-    if (entryURL.startsWith(submitUrl)) {
-        return 50;
-    }
-    if (entryURL.startsWith(baseSubmitUrl) && baseSubmitUrl != host) {
-        return 40;
-    }
-    if (submitUrl.startsWith(entryURL)) {
-        return 30;
-    }
-    if (submitUrl.startsWith(baseEntryURL)) {
-        return 20;
-    }
-    if (entryURL.startsWith(host)) {
-        return 10;
-    }
-    if (host.startsWith(entryURL)) {
-        return 5;
-    }
-    return 0;
-}
-
-bool BrowserService::matchUrlScheme(const QString& url)
-{
-    QUrl address(url);
-    return !address.scheme().isEmpty();
-}
-
-bool BrowserService::removeFirstDomain(QString& hostname)
-{
-    int pos = hostname.indexOf(".");
-    if (pos < 0) {
-        return false;
-    }
-
-    // Don't remove the second-level domain if it's the only one
-    if (hostname.count(".") > 1) {
-        hostname = hostname.mid(pos + 1);
-        return !hostname.isEmpty();
-    }
-
-    // Nothing removed
-    return false;
-}
-
 Database* BrowserService::getDatabase()
 {
     if (DatabaseWidget* dbWidget = m_dbTabWidget->currentDatabaseWidget()) {
@@ -717,8 +763,27 @@ Database* BrowserService::getDatabase()
     return nullptr;
 }
 
+QList<Database*> BrowserService::searchDatabases()
+{
+    QList<Database*> databases;
+    if (BrowserSettings::searchInAllDatabases()) {
+        const int count = m_dbTabWidget->count();
+        for (int i = 0; i < count; ++i) {
+            if (DatabaseWidget* dbWidget = qobject_cast<DatabaseWidget*>(m_dbTabWidget->widget(i))) {
+                if (Database* db = dbWidget->database()) {
+                    databases << db;
+                }
+            }
+        }
+    } else if (Database* db = getDatabase()) {
+        databases << db;
+    }
+    return databases;
+}
+
 void BrowserService::databaseLocked(DatabaseWidget* dbWidget)
 {
+    clearResponseCache();
     if (dbWidget) {
         emit databaseLocked();
     }
@@ -726,6 +791,7 @@ void BrowserService::databaseLocked(DatabaseWidget* dbWidget)
 
 void BrowserService::databaseUnlocked(DatabaseWidget* dbWidget)
 {
+    clearResponseCache();
     if (dbWidget) {
         emit databaseUnlocked();
     }
@@ -733,6 +799,7 @@ void BrowserService::databaseUnlocked(DatabaseWidget* dbWidget)
 
 void BrowserService::activateDatabaseChanged(DatabaseWidget* dbWidget)
 {
+    clearResponseCache();
     if (dbWidget) {
         auto currentMode = dbWidget->currentMode();
         if (currentMode == DatabaseWidget::ViewMode || currentMode == DatabaseWidget::EditMode) {
@@ -24,6 +24,7 @@
 #include <QObject>
 #include "gui/DatabaseTabWidget.h"
 #include "core/Entry.h"
+#include "core/GuiThreadDispatcher.h"
 
 enum { max_length = 16*1024 };
 
@@ -34,19 +35,21 @@ class BrowserService : public QObject
 public:
     explicit        BrowserService(DatabaseTabWidget* parent);
 
-    bool            isDatabaseOpened() const;
-    bool            openDatabase(bool triggerUnlock);
-    QString         getDatabaseRootUuid();
-    QString         getDatabaseRecycleBinUuid();
     Entry*          getConfigEntry(bool create = false);
-    QString         getKey(const QString& id);
-    void            addEntry(const QString& id, const QString& login, const QString& password, const QString& url, const QString& submitUrl, const QString& realm);
     QList<Entry*>   searchEntries(Database* db, const QString& hostname);
     QList<Entry*>   searchEntries(const QString& text);
     void            removeSharedEncryptionKeys();
     void            removeStoredPermissions();
+    int             cacheHits() const;
+    int             cacheMisses() const;
 
 public slots:
+    bool            isDatabaseOpened() const;
+    bool            openDatabase(bool triggerUnlock);
+    QString         getDatabaseRootUuid();
+    QString         getDatabaseRecycleBinUuid();
+    QString         getKey(const QString& id);
+    void            addEntry(const QString& id, const QString& login, const QString& password, const QString& url, const QString& submitUrl, const QString& realm);
     QJsonArray      findMatchingEntries(const QString& id, const QString& url, const QString& submitUrl, const QString& realm);
     QString         storeKey(const QString& key);
     void            updateEntry(const QString& id, const QString& uuid, const QString& login, const QString& password, const QString& url);
@@ -54,6 +57,7 @@ public slots:
     void            databaseUnlocked(DatabaseWidget* dbWidget);
     void            activateDatabaseChanged(DatabaseWidget* dbWidget);
     void            lockDatabase();
+    void            clearResponseCache();
 
 signals:
     void            databaseLocked();
@@ -62,6 +66,17 @@ signals:
 
 private:
     enum Access     { Denied, Unknown, Allowed};
+    enum            { MaxCachedResponses = 256 };
+
+    struct CachedResponse
+    {
+        QList<QPointer<Entry>>  entries;
+        QList<const QObject*>   databases;
+    };
+
+private slots:
+    void            databaseModified();
+    QJsonValue      findCachedEntries(const QString& id, const QString& url, const QString& submitUrl, const QString& realm);
 
 private:
     QList<Entry*>   sortEntries(QList<Entry*>& pwEntries, const QString& host, const QString& submitUrl);
@@ -69,14 +84,19 @@ private:
     QJsonObject     prepareEntry(const Entry* entry);
     Access          checkAccess(const Entry* entry, const QString& host, const QString& submitHost, const QString& realm);
     Group*          findCreateAddEntryGroup();
-    int             sortPriority(const Entry* entry, const QString &host, const QString& submitUrl, const QString& baseSubmitUrl) const;
-    bool            matchUrlScheme(const QString& url);
-    bool            removeFirstDomain(QString& hostname);
     Database*       getDatabase();
+    QList<Database*> searchDatabases();
+    QString         responseCacheKey(const QString& id, const QString& url, const QString& submitUrl, const QString& realm) const;
+    bool            cachedResponse(const QString& key, QJsonArray& result);
+    void            cacheResponse(const QString& key, const QList<Entry*>& entries);
 
 private:
     DatabaseTabWidget* const    m_dbTabWidget;
     bool                        m_dialogActive;
+    GuiThreadDispatcher         m_dispatcher;
+    QCache<QString, CachedResponse> m_responseCache;
+    int                         m_cacheHits;
+    int                         m_cacheMisses;
 };
 
 #endif // BROWSERSERVICE_H
@@ -0,0 +1,132 @@
+/*
+*  Copyright (C) 2017 KeePassXC Team <team@keepassxc.org>
+*
+*  This program is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This program is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef NATIVEMESSAGEBUFFER_H
+#define NATIVEMESSAGEBUFFER_H
+
+#include <QByteArray>
+#include <cstring>
+
+/**
+ * Reassembles native messaging frames from a byte stream.
+ *
+ * A frame is a 32-bit message length in native byte order followed by the
+ * message. The browser uses this format on stdin/stdout and KeePassXC uses
+ * the same format on the proxy socket, so the proxy can relay bytes as they
+ * arrive without parsing them.
+ *
+ * Older versions of keepassxc-proxy send bare JSON messages over the socket,
+ * one per write, and expect bare JSON replies. Their first bytes can't start
+ * a valid frame, see isUnframed(). A newer proxy can't talk to an older
+ * KeePassXC, the proxy has to be updated together with the application.
+ */
+class NativeMessageBuffer
+{
+public:
+    enum { MaxMessageSize = 64 * 1024 * 1024 };
+
+    NativeMessageBuffer() : m_offset(0), m_error(false) {}
+
+    void append(const char* data, qint64 size)
+    {
+        if (m_offset > 0 && m_offset == m_data.size()) {
+            // everything was consumed, reuse the allocation
+            m_data.resize(0);
+            m_offset = 0;
+        }
+        m_data.append(data, static_cast<int>(size));
+    }
+
+    void append(const QByteArray& data)
+    {
+        append(data.constData(), data.size());
+    }
+
+    /**
+     * Take the next complete message out of the buffer.
+     *
+     * @return false if no complete message is buffered yet or the stream
+     *         announced a message larger than MaxMessageSize
+     */
+    bool takeMessage(QByteArray& message)
+    {
+        if (m_error || m_data.size() - m_offset < 4) {
+            return false;
+        }
+
+        quint32 length;
+        std::memcpy(&length, m_data.constData() + m_offset, sizeof(length));
+        if (length > static_cast<quint32>(MaxMessageSize)) {
+            m_error = true;
+            m_data.clear();
+            m_offset = 0;
+            return false;
+        }
+
+        if (static_cast<quint32>(m_data.size() - m_offset - 4) < length) {
+            return false;
+        }
+
+        message = m_data.mid(m_offset + 4, static_cast<int>(length));
+        m_offset += 4 + static_cast<int>(length);
+
+        // drop consumed frames once they make up most of the buffer
+        if (m_offset > m_data.size() / 2) {
+            m_data.remove(0, m_offset);
+            m_offset = 0;
+        }
+        return true;
+    }
+
+    bool hasError() const
+    {
+        return m_error;
+    }
+
+    /**
+     * Whether the data received first on a connection is a bare JSON message
+     * from an older proxy. Read as a frame its length would start with '{'
+     * and exceed MaxMessageSize. Needs at least the 4 bytes of a length prefix.
+     */
+    static bool isUnframed(const QByteArray& data)
+    {
+        if (data.size() < 4 || data.at(0) != '{') {
+            return false;
+        }
+
+        quint32 length;
+        std::memcpy(&length, data.constData(), sizeof(length));
+        return length > static_cast<quint32>(MaxMessageSize);
+    }
+
+    static QByteArray frame(const QByteArray& message)
+    {
+        const quint32 length = static_cast<quint32>(message.size());
+        QByteArray frame;
+        frame.reserve(4 + message.size());
+        frame.append(reinterpret_cast<const char*>(&length), sizeof(length));
+        frame.append(message);
+        return frame;
+    }
+
+private:
+    QByteArray  m_data;
+    int         m_offset;
+    bool        m_error;
+};
+
+#endif // NATIVEMESSAGEBUFFER_H
@@ -17,17 +17,11 @@
 */
 
 #include "NativeMessagingBase.h"
+#include "NativeMessageBuffer.h"
 #include <QStandardPaths>
 
-#if defined(Q_OS_UNIX) && !defined(Q_OS_LINUX)
-#include <sys/types.h>
-#include <sys/event.h>
-#include <sys/time.h>
-#include <unistd.h>
-#endif
-
-#ifdef Q_OS_LINUX
-#include <sys/epoll.h>
+#ifndef Q_OS_WIN
+#include <errno.h>
 #include <unistd.h>
 #endif
 
@@ -36,7 +30,8 @@
 #include <io.h>
 #endif
 
-NativeMessagingBase::NativeMessagingBase()
+NativeMessagingBase::NativeMessagingBase() :
+    m_readBuffer(ReadBufferSize)
 {
 #ifdef Q_OS_WIN
     _setmode(_fileno(stdin), _O_BINARY);
@@ -49,60 +44,46 @@ NativeMessagingBase::NativeMessagingBase()
 
 void NativeMessagingBase::newNativeMessage()
 {
-#if defined(Q_OS_UNIX) && !defined(Q_OS_LINUX)
-    struct kevent ev[1];
-    struct timespec ts = { 5, 0 };
-
-    int fd = kqueue();
-    if (fd == -1) {
-        m_notifier->setEnabled(false);
+#ifndef Q_OS_WIN
+    // The notifier stays installed for the whole session; read whatever is
+    // available in one go and let the subclass reassemble the frames
+    const ssize_t bytes = ::read(fileno(stdin), m_readBuffer.data(), m_readBuffer.size());
+    if (bytes < 0 && errno == EINTR) {
         return;
     }
 
-    EV_SET(ev, fileno(stdin), EVFILT_READ, EV_ADD, 0, 0, nullptr);
-    if (kevent(fd, ev, 1, nullptr, 0, &ts) == -1) {
+    if (bytes <= 0) {
         m_notifier->setEnabled(false);
+        stdInClosed();
         return;
     }
 
-    int ret = kevent(fd, NULL, 0, ev, 1, &ts);
-    if (ret < 1) {
-        m_notifier->setEnabled(false);
-        ::close(fd);
-        return;
-    }
-#elif defined(Q_OS_LINUX)
-    int fd = epoll_create(5);
-    struct epoll_event event;
-    event.events = EPOLLIN;
-    event.data.fd = 0;
-    if (epoll_ctl(fd, EPOLL_CTL_ADD, 0, &event) != 0) {
-        m_notifier->setEnabled(false);
-        return;
-    }
-
-    if (epoll_wait(fd, &event, 1, 5000) < 1) {
-        m_notifier->setEnabled(false);
-        ::close(fd);
-        return;
-    }
-#endif
-    readLength();
-#ifndef Q_OS_WIN
-    ::close(fd);
+    readStdIn(m_readBuffer.data(), bytes);
 #endif
 }
 
 void NativeMessagingBase::readNativeMessages()
 {
 #ifdef Q_OS_WIN
-    quint32 length = 0;
     while (m_running.load() && !std::cin.eof()) {
-        length = 0;
-        std::cin.read(reinterpret_cast<char*>(&length), 4);
-        readStdIn(length);
-        QThread::msleep(1);
+        quint32 length = 0;
+        if (!std::cin.read(reinterpret_cast<char*>(&length), sizeof(length))) {
+            break;
+        }
+        readStdIn(reinterpret_cast<const char*>(&length), sizeof(length));
+
+        // Pass the message on in buffer sized chunks
+        while (length > 0 && std::cin) {
+            const quint32 chunk = qMin(length, static_cast<quint32>(m_readBuffer.size()));
+            std::cin.read(m_readBuffer.data(), chunk);
+            const std::streamsize bytes = std::cin.gcount();
+            if (bytes > 0) {
+                readStdIn(m_readBuffer.data(), bytes);
+            }
+            length -= static_cast<quint32>(bytes);
+        }
     }
+    stdInClosed();
 #endif
 }
 
@@ -121,12 +102,17 @@ void NativeMessagingBase::sendReply(const QJsonObject& json)
 void NativeMessagingBase::sendReply(const QString& reply)
 {
     if (!reply.isEmpty()) {
-        uint len = reply.length();
-        std::cout << char(((len>>0) & 0xFF)) << char(((len>>8) & 0xFF)) << char(((len>>16) & 0xFF)) << char(((len>>24) & 0xFF));
-        std::cout << reply.toStdString() << std::flush;
+        const QByteArray frame = NativeMessageBuffer::frame(reply.toUtf8());
+        writeStdOut(frame.constData(), frame.size());
     }
 }
 
+void NativeMessagingBase::writeStdOut(const char* data, qint64 size)
+{
+    std::cout.write(data, size);
+    std::cout.flush();
+}
+
 QString NativeMessagingBase::getLocalServerPath() const
 {
 #if defined(Q_OS_WIN)
@@ -31,6 +31,7 @@
 #include <QAtomicInteger>
 #include <iostream>
 #include <unistd.h>
+#include <vector>
 
 class NativeMessagingBase : public QObject
 {
@@ -44,18 +45,22 @@ protected slots:
     void            newNativeMessage();
 
 protected:
-    virtual void    readLength() = 0;
-    virtual void    readStdIn(const quint32 length) = 0;
+    enum { ReadBufferSize = 64 * 1024 };
+
+    virtual void    readStdIn(const char* data, qint64 size) = 0;
+    virtual void    stdInClosed() = 0;
     void            readNativeMessages();
     QString         jsonToString(const QJsonObject& json) const;
     void            sendReply(const QJsonObject& json);
     void            sendReply(const QString& reply);
+    void            writeStdOut(const char* data, qint64 size);
     QString         getLocalServerPath() const;
 
 protected:
     QAtomicInteger<quint8>          m_running;
     QSharedPointer<QSocketNotifier> m_notifier;
     QFuture<void>                   m_future;
+    std::vector<char>               m_readBuffer;
 };
 
 #endif  // NATIVEMESSAGINGBASE_H
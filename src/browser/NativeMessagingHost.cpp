@@ -16,12 +16,16 @@
 *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <QEventLoop>
+#include <QFutureWatcher>
 #include <QMutexLocker>
+#include <QtConcurrent>
 #include <QtNetwork>
 #include <iostream>
 #include "sodium.h"
 #include "NativeMessagingHost.h"
 #include "BrowserSettings.h"
+#include "core/AsyncTask.h"
 
 NativeMessagingHost::NativeMessagingHost(DatabaseTabWidget* parent) :
     NativeMessagingBase(),
@@ -29,6 +33,7 @@ NativeMessagingHost::NativeMessagingHost(DatabaseTabWidget* parent) :
     m_browserClients(m_browserService),
     m_browserService(parent)
 {
+    m_threadPool.setMaxThreadCount(MaxRequestThreads);
     m_localServer.reset(new QLocalServer(this));
     m_localServer->setSocketOptions(QLocalServer::UserAccessOption);
     m_running.store(false);
@@ -87,6 +92,7 @@ void NativeMessagingHost::run()
 void NativeMessagingHost::stop()
 {
     databaseLocked();
+    waitForRequests();
     QMutexLocker locker(&m_mutex);
     m_socketList.clear();
     m_running.testAndSetOrdered(true, false);
@@ -94,31 +100,86 @@ void NativeMessagingHost::stop()
     m_localServer->close();
 }
 
-void NativeMessagingHost::readLength()
+void NativeMessagingHost::readStdIn(const char* data, qint64 size)
 {
-    quint32 length = 0;
-    std::cin.read(reinterpret_cast<char*>(&length), 4);
-    if (!std::cin.eof() && length > 0) {
-        readStdIn(length);
-    } else {
-    	m_notifier->setEnabled(false);
+    m_stdInBuffer.append(data, size);
+
+    QByteArray message;
+    while (m_stdInBuffer.takeMessage(message)) {
+        // On Windows stdin is read on its own thread, replies are always
+        // written from the GUI thread
+        QMetaObject::invokeMethod(this, "handleStdInMessage", Qt::AutoConnection, Q_ARG(QByteArray, message));
+    }
+
+    if (m_stdInBuffer.hasError()) {
+        stdInClosed();
     }
 }
 
-void NativeMessagingHost::readStdIn(const quint32 length)
+void NativeMessagingHost::stdInClosed()
 {
-    if (length > 0) {
-        QByteArray arr;
-        arr.reserve(length);
+    if (m_notifier) {
+        m_notifier->setEnabled(false);
+    }
+}
+
+void NativeMessagingHost::handleStdInMessage(const QByteArray& message)
+{
+    dispatchMessage(message, nullptr);
+}
 
-        for (quint32 i = 0; i < length; ++i) {
-            arr.append(getchar());
+/**
+ * Parse, decrypt and answer a request on the thread pool of the host, like
+ * the KeePassHTTP server does. BrowserService forwards the calls that touch
+ * databases or show dialogs to the GUI thread, see GuiThreadDispatcher, so a
+ * request waiting for an access confirmation only holds up requests that may
+ * show a dialog too. The pool keeps blocked requests off the global thread
+ * pool. Replies are sent as they complete and carry the incremented request
+ * nonce for correlation.
+ *
+ * @param socket the connection to reply to, or nullptr for stdout
+ */
+void NativeMessagingHost::dispatchMessage(const QByteArray& message, QLocalSocket* socket)
+{
+    // prune finished requests, only pending ones matter in stop()
+    for (auto it = m_requests.begin(); it != m_requests.end();) {
+        if (it->isFinished()) {
+            it = m_requests.erase(it);
+        } else {
+            ++it;
         }
+    }
 
-        if (arr.length() > 0) {
-            QMutexLocker locker(&m_mutex);
-            sendReply(m_browserClients.readResponse(arr));
+    // the watcher dies with the socket, so replies for closed connections are dropped
+    auto watcher = new QFutureWatcher<QJsonObject>(socket ? static_cast<QObject*>(socket) : this);
+    connect(watcher, &QFutureWatcher<QJsonObject>::finished, this, [this, watcher, socket]() {
+        const QJsonObject reply = watcher->result();
+        watcher->deleteLater();
+        if (socket) {
+            sendSocketReply(socket, reply);
+        } else {
+            sendReply(reply);
         }
+    });
+
+    BrowserClients* clients = &m_browserClients;
+    const QFuture<QJsonObject> future = AsyncTask::runOnPool(&m_threadPool, [clients, message]() {
+        return clients->readResponse(message);
+    });
+    watcher->setFuture(future);
+    m_requests.append(future);
+}
+
+void NativeMessagingHost::waitForRequests()
+{
+    // Pending requests may be blocked on calls into the GUI thread, keep
+    // serving them until they have finished
+    while (!m_requests.isEmpty()) {
+        QFutureWatcher<QJsonObject> watcher;
+        QEventLoop loop;
+        connect(&watcher, SIGNAL(finished()), &loop, SLOT(quit()));
+        watcher.setFuture(m_requests.takeFirst());
+        loop.exec(QEventLoop::ExcludeUserInputEvents);
     }
 }
 
@@ -139,46 +200,85 @@ void NativeMessagingHost::newLocalMessage()
         return;
     }
 
-    QByteArray arr = socket->readAll();
-    if (arr.isEmpty()) {
+    NativeMessageBuffer* buffer;
+    bool unframed;
+    QByteArray data;
+    {
+        QMutexLocker locker(&m_mutex);
+        if (!m_socketBuffers.contains(socket)) {
+            // Tell an older proxy sending bare JSON from a framed stream
+            // once the first length prefix is complete
+            if (socket->bytesAvailable() < 4) {
+                return;
+            }
+            data = socket->readAll();
+            if (NativeMessageBuffer::isUnframed(data)) {
+                m_unframedSockets.insert(socket);
+            }
+        } else {
+            data = socket->readAll();
+        }
+
+        if (!m_socketList.contains(socket)) {
+            m_socketList.push_back(socket);
+        }
+        buffer = &m_socketBuffers[socket];
+        unframed = m_unframedSockets.contains(socket);
+    }
+
+    if (unframed) {
+        dispatchMessage(data, socket);
         return;
     }
 
-    QMutexLocker locker(&m_mutex);
-    if (!m_socketList.contains(socket)) {
-        m_socketList.push_back(socket);
+    // The proxy relays the browser's length-prefixed frames unchanged, a
+    // single read may contain several messages or only part of one
+    buffer->append(data);
+
+    QByteArray message;
+    while (buffer->takeMessage(message)) {
+        dispatchMessage(message, socket);
     }
 
-    QString reply = jsonToString(m_browserClients.readResponse(arr));
-    if (socket && socket->isValid() && socket->state() == QLocalSocket::ConnectedState) {
-        QByteArray arr = reply.toUtf8();
-        socket->write(arr.constData(), arr.length());
-        socket->flush();
+    if (buffer->hasError()) {
+        socket->disconnectFromServer();
     }
 }
 
 void NativeMessagingHost::sendReplyToAllClients(const QJsonObject& json)
 {
-    QString reply = jsonToString(json);
     QMutexLocker locker(&m_mutex);
     for (const auto socket : m_socketList) {
         if (socket && socket->isValid() && socket->state() == QLocalSocket::ConnectedState) {
-            QByteArray arr = reply.toUtf8();
-            socket->write(arr.constData(), arr.length());
+            socket->write(socketMessage(socket, json));
             socket->flush();
         }
     }
 }
 
+void NativeMessagingHost::sendSocketReply(QLocalSocket* socket, const QJsonObject& json)
+{
+    if (!json.isEmpty() && socket->isValid() && socket->state() == QLocalSocket::ConnectedState) {
+        socket->write(socketMessage(socket, json));
+        socket->flush();
+    }
+}
+
+QByteArray NativeMessagingHost::socketMessage(QLocalSocket* socket, const QJsonObject& json)
+{
+    const QByteArray message = jsonToString(json).toUtf8();
+
+    QMutexLocker locker(&m_mutex);
+    return m_unframedSockets.contains(socket) ? message : NativeMessageBuffer::frame(message);
+}
+
 void NativeMessagingHost::disconnectSocket()
 {
     QLocalSocket* socket(qobject_cast<QLocalSocket*>(QObject::sender()));
     QMutexLocker locker(&m_mutex);
-    for (auto s : m_socketList) {
-        if (s == socket) {
-            m_socketList.removeOne(s);
-        }
-    }
+    m_socketList.removeAll(socket);
+    m_socketBuffers.remove(socket);
+    m_unframedSockets.remove(socket);
 }
 
 void NativeMessagingHost::removeSharedEncryptionKeys()
@@ -19,7 +19,11 @@
 #ifndef NATIVEMESSAGINGHOST_H
 #define NATIVEMESSAGINGHOST_H
 
+#include <QFuture>
+#include <QSet>
+#include <QThreadPool>
 #include "NativeMessagingBase.h"
+#include "NativeMessageBuffer.h"
 #include "BrowserClients.h"
 #include "BrowserService.h"
 #include "gui/DatabaseTabWidget.h"
@@ -30,6 +34,8 @@ class NativeMessagingHost : public NativeMessagingBase
 
     typedef QList<QLocalSocket*> SocketList;
 
+    enum { MaxRequestThreads = 4 };
+
 public:
     explicit    NativeMessagingHost(DatabaseTabWidget* parent = 0);
     ~NativeMessagingHost();
@@ -45,15 +51,20 @@ signals:
     void        quit();
 
 private:
-    void        readLength();
-    void        readStdIn(const quint32 length);
+    void        readStdIn(const char* data, qint64 size);
+    void        stdInClosed();
     void        sendReplyToAllClients(const QJsonObject& json);
+    void        sendSocketReply(QLocalSocket* socket, const QJsonObject& json);
+    QByteArray  socketMessage(QLocalSocket* socket, const QJsonObject& json);
+    void        dispatchMessage(const QByteArray& message, QLocalSocket* socket);
+    void        waitForRequests();
 
 private slots:
     void        databaseLocked();
     void        databaseUnlocked();
     void        newLocalConnection();
     void        newLocalMessage();
+    void        handleStdInMessage(const QByteArray& message);
     void        disconnectSocket();
 
 private:
@@ -62,6 +73,11 @@ private:
     BrowserService                  m_browserService;
     QSharedPointer<QLocalServer>    m_localServer;
     SocketList                      m_socketList;
+    QHash<QLocalSocket*, NativeMessageBuffer> m_socketBuffers;
+    QSet<QLocalSocket*>             m_unframedSockets;
+    NativeMessageBuffer             m_stdInBuffer;
+    QList<QFuture<QJsonObject>>     m_requests;
+    QThreadPool                     m_threadPool;
 };
 
 #endif // NATIVEMESSAGINGHOST_H
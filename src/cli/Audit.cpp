@@ -0,0 +1,138 @@
+/*
+ *  Copyright (C) 2017 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <cstdlib>
+#include <stdio.h>
+
+#include "Audit.h"
+
+#include <QCommandLineParser>
+#include <QEventLoop>
+#include <QTextStream>
+
+#include "core/Database.h"
+#include "core/Entry.h"
+#include "core/PasswordAudit.h"
+
+Audit::Audit()
+{
+    this->name = QString("audit");
+    this->description = QObject::tr("Check the passwords of all database entries.");
+}
+
+Audit::~Audit()
+{
+}
+
+int Audit::execute(QStringList arguments)
+{
+    QTextStream out(stdout);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(this->description);
+    parser.addPositionalArgument("database", QObject::tr("Path of the database."));
+    QCommandLineOption keyFile(QStringList() << "k"
+                                             << "key-file",
+                               QObject::tr("Key file of the database."),
+                               QObject::tr("path"));
+    parser.addOption(keyFile);
+    QCommandLineOption all(QStringList() << "a"
+                                         << "all",
+                           QObject::tr("Also list entries without any issue."));
+    parser.addOption(all);
+    QCommandLineOption staleDays(QStringList() << "s"
+                                               << "stale-days",
+                                 QObject::tr("Report entries not modified for more than this many days, "
+                                             "0 to disable. Default is 365."),
+                                 QObject::tr("days"));
+    parser.addOption(staleDays);
+    parser.process(arguments);
+
+    const QStringList args = parser.positionalArguments();
+    if (args.size() != 1) {
+        out << parser.helpText().replace("keepassxc-cli", "keepassxc-cli audit");
+        return EXIT_FAILURE;
+    }
+
+    PasswordAudit audit;
+    if (parser.isSet(staleDays)) {
+        bool ok;
+        const int days = parser.value(staleDays).toInt(&ok);
+        if (!ok || days < 0) {
+            qCritical("Invalid number of days %s.", qPrintable(parser.value(staleDays)));
+            return EXIT_FAILURE;
+        }
+        audit.setStaleDays(days);
+    }
+
+    Database* db = Database::unlockFromStdin(args.at(0), parser.value(keyFile));
+    if (db == nullptr) {
+        return EXIT_FAILURE;
+    }
+
+    int weak = 0;
+    int reused = 0;
+    int expired = 0;
+    int stale = 0;
+    const bool listAll = parser.isSet(all);
+
+    // print results as they come in, the order depends on the estimation
+    QObject::connect(&audit, &PasswordAudit::resultReady, [&](const PasswordAudit::Result& result) {
+        QStringList issues;
+        issues << QObject::tr("Entropy %1").arg(QString::number(result.entropy, 'f', 3));
+        if (result.flags & PasswordAudit::WeakPassword) {
+            issues << QObject::tr("weak");
+            ++weak;
+        }
+        if (result.flags & PasswordAudit::ReusedPassword) {
+            issues << QObject::tr("used by %1 entries").arg(result.reuseCount);
+            ++reused;
+        }
+        if (result.flags & PasswordAudit::ExpiredEntry) {
+            issues << QObject::tr("expired");
+            ++expired;
+        }
+        if (result.flags & PasswordAudit::StaleEntry) {
+            issues << QObject::tr("stale");
+            ++stale;
+        }
+        if (!listAll && result.flags == PasswordAudit::NoFlags) {
+            return;
+        }
+
+        out << result.entry->title() << "\t" << issues.join(", ") << "\n";
+        out.flush();
+    });
+
+    QEventLoop loop;
+    QObject::connect(&audit, SIGNAL(finished()), &loop, SLOT(quit()));
+    audit.start(db);
+    loop.exec();
+
+    out << QObject::tr("%1 entries: %2 weak, %3 reused, %4 expired, %5 stale")
+               .arg(audit.entryCount())
+               .arg(weak)
+               .arg(reused)
+               .arg(expired)
+               .arg(stale)
+        << "\n";
+    out.flush();
+
+    delete db;
+    return EXIT_SUCCESS;
+}
@@ -23,6 +23,7 @@
 #include "Command.h"
 
 #include "Add.h"
+#include "Audit.h"
 #include "Clip.h"
 #include "Edit.h"
 #include "Estimate.h"
@@ -60,6 +61,7 @@ void populateCommands()
 {
     if (commands.isEmpty()) {
         commands.insert(QString("add"), new Add());
+        commands.insert(QString("audit"), new Audit());
         commands.insert(QString("clip"), new Clip());
         commands.insert(QString("edit"), new Edit());
         commands.insert(QString("estimate"), new Estimate());
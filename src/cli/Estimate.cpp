@@ -42,15 +42,15 @@ Estimate::~Estimate()
 {
 }
 
-static void estimate(const char* pwd, bool advanced)
+static void estimate(const char* pwd, int len, bool advanced)
 {
     double e;
-    int len = strlen(pwd);
     if (!advanced) {
         e = ZxcvbnMatch(pwd, 0, 0);
         printf("Length %d\tEntropy %.3f\tLog10 %.3f\n", len, e, e * 0.301029996);
     } else {
         int ChkLen;
+        int PwdLen = strlen(pwd);
         ZxcMatch_t *info, *p;
         double m = 0.0;
         e = ZxcvbnMatch(pwd, 0, &info);
@@ -132,8 +132,9 @@ static void estimate(const char* pwd, bool advanced)
             p = p->Next;
         }
         ZxcvbnFreeInfo(info);
-        if (ChkLen != len) {
-            printf("*** Password length (%d) != sum of length of parts (%d) ***\n", len, ChkLen);
+        // the parts are measured in UTF-8 bytes
+        if (ChkLen != PwdLen) {
+            printf("*** Password length (%d) != sum of length of parts (%d) ***\n", PwdLen, ChkLen);
         }
     }
 }
@@ -165,6 +166,7 @@ int Estimate::execute(QStringList arguments)
         password = inputTextStream.readLine();
     }
 
-    estimate(password.toLatin1(), parser.isSet(advancedOption));
+    // zxcvbn takes UTF-8, but the length shown is the number of characters
+    estimate(password.toUtf8(), password.length(), parser.isSet(advancedOption));
     return EXIT_SUCCESS;
 }
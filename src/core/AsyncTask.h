@@ -19,7 +19,10 @@
 #define KEEPASSXC_ASYNCTASK_HPP
 
 #include <QFuture>
+#include <QFutureInterface>
 #include <QFutureWatcher>
+#include <QRunnable>
+#include <QThreadPool>
 #include <QtConcurrent>
 
 
@@ -58,6 +61,55 @@ typename std::result_of<FunctionObject()>::type runAndWaitForFuture(FunctionObje
     return waitForFuture<FunctionObject>(QtConcurrent::run(task));
 }
 
+/**
+ * Runnable reporting the result of a task to a future, like the tasks of
+ * QtConcurrent::run().
+ */
+template<typename FunctionObject>
+class PoolTask : public QRunnable
+{
+public:
+    typedef typename std::result_of<FunctionObject()>::type ResultType;
+
+    explicit PoolTask(FunctionObject task)
+        : m_task(task)
+    {
+    }
+
+    QFuture<ResultType> start(QThreadPool* pool)
+    {
+        m_futureInterface.reportStarted();
+        QFuture<ResultType> future = m_futureInterface.future();
+        pool->start(this);
+        return future;
+    }
+
+    void run() override
+    {
+        m_futureInterface.reportResult(m_task());
+        m_futureInterface.reportFinished();
+    }
+
+private:
+    FunctionObject m_task;
+    QFutureInterface<ResultType> m_futureInterface;
+};
+
+/**
+ * Run a given task on the given thread pool instead of the global one. Tasks
+ * that block for a long time, e.g. on calls into the GUI thread, use their
+ * own pool so they don't hold up the computations on the global one.
+ *
+ * @param pool thread pool to run the task on
+ * @param task std::function object to run
+ * @return future for the task result
+ */
+template<typename FunctionObject>
+QFuture<typename std::result_of<FunctionObject()>::type> runOnPool(QThreadPool* pool, FunctionObject task)
+{
+    return (new PoolTask<FunctionObject>(task))->start(pool);
+}
+
 };  // namespace AsyncTask
 
 #endif //KEEPASSXC_ASYNCTASK_HPP
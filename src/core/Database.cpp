@@ -25,6 +25,7 @@
 #include <QXmlStreamReader>
 
 #include "cli/Utils.h"
+#include "core/EntryHostIndex.h"
 #include "core/Group.h"
 #include "core/Metadata.h"
 #include "crypto/kdf/AesKdf.h"
@@ -38,6 +39,7 @@ QHash<Uuid, Database*> Database::m_uuidMap;
 
 Database::Database()
     : m_metadata(new Metadata(this))
+    , m_hostIndex(nullptr)
     , m_timer(new QTimer(this))
     , m_emitModified(false)
     , m_uuid(Uuid::random())
@@ -181,6 +183,18 @@ Group* Database::resolveGroup(const Uuid& uuid)
     return findGroupRecursive(uuid, m_rootGroup);
 }
 
+/**
+ * The index of entries by host name, created on first use.
+ * Must be called from the thread owning the database.
+ */
+EntryHostIndex* Database::hostIndex()
+{
+    if (!m_hostIndex) {
+        m_hostIndex = new EntryHostIndex(this);
+    }
+    return m_hostIndex;
+}
+
 Group* Database::findGroupRecursive(const Uuid& uuid, Group* group)
 {
     if (group->uuid() == uuid) {
@@ -370,11 +384,10 @@ void Database::merge(const Database* other)
 {
     m_rootGroup->merge(other->rootGroup());
 
-    for (Uuid customIconId : other->metadata()->customIcons().keys()) {
-        QImage customIcon = other->metadata()->customIcon(customIconId);
+    for (const Uuid& customIconId : other->metadata()->customIconsOrder()) {
         if (!this->metadata()->containsCustomIcon(customIconId)) {
             qDebug("Adding custom icon %s to database.", qPrintable(customIconId.toHex()));
-            this->metadata()->addCustomIcon(customIconId, customIcon);
+            this->metadata()->addCustomIcon(customIconId, other->metadata()->customIconData(customIconId));
         }
     }
 
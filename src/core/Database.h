@@ -28,6 +28,7 @@
 #include "keys/CompositeKey.h"
 
 class Entry;
+class EntryHostIndex;
 enum class EntryReferenceType;
 class Group;
 class Metadata;
@@ -85,6 +86,7 @@ public:
     Entry* resolveEntry(const Uuid& uuid);
     Entry* resolveEntry(const QString& text, EntryReferenceType referenceType);
     Group* resolveGroup(const Uuid& uuid);
+    EntryHostIndex* hostIndex();
     QList<DeletedObject> deletedObjects();
     void addDeletedObject(const DeletedObject& delObj);
     void addDeletedObject(const Uuid& uuid);
@@ -147,6 +149,7 @@ private:
 
     Metadata* const m_metadata;
     Group* m_rootGroup;
+    EntryHostIndex* m_hostIndex;
     QList<DeletedObject> m_deletedObjects;
     QTimer* m_timer;
     DatabaseData m_data;
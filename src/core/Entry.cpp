@@ -867,7 +867,8 @@ void Entry::setGroup(Group* group)
             if (!iconUuid().isNull() && group->database()
                     && m_group->database()->metadata()->containsCustomIcon(iconUuid())
                     && !group->database()->metadata()->containsCustomIcon(iconUuid())) {
-                group->database()->metadata()->addCustomIcon(iconUuid(), icon());
+                group->database()->metadata()->addCustomIcon(
+                        iconUuid(), m_group->database()->metadata()->customIconData(iconUuid()));
             }
         }
     }
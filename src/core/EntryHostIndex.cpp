@@ -0,0 +1,268 @@
+/*
+ *  Copyright (C) 2017 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "EntryHostIndex.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutexLocker>
+#include <QRegExp>
+#include <QUrl>
+
+#include "core/Database.h"
+#include "core/Entry.h"
+#include "core/Group.h"
+
+namespace
+{
+    // Per entry settings of the browser integrations, their "Allow" list
+    // names the hosts an entry has been granted to
+    const char* const EntryConfigAttributes[] = {
+        "KeePassXC-Browser Settings",
+        "KeePassHttp Settings"
+    };
+}
+
+EntryHostIndex::EntryHostIndex(Database* db)
+    : QObject(db)
+    , m_db(db)
+{
+    connect(m_db, SIGNAL(groupAboutToAdd(Group*,int)), SLOT(groupAboutToAdd(Group*)));
+    connect(m_db, SIGNAL(groupAboutToRemove(Group*)), SLOT(groupAboutToRemove(Group*)));
+
+    rebuild();
+}
+
+/**
+ * Entries that refer to exactly the given host name. Entries inside groups
+ * that are excluded from searching (like the recycle bin) are skipped.
+ */
+QList<Entry*> EntryHostIndex::entries(const QString& host)
+{
+    QMutexLocker locker(&m_mutex);
+    update();
+    return searchableEntries(host.toLower());
+}
+
+/**
+ * Entries that refer to any of the given host names, as returned by
+ * PublicSuffixList::hostLevels(). An entry for a parent domain matches all of
+ * its subdomains, so the result is the union of all levels, most specific
+ * host name first and without duplicates.
+ */
+QList<Entry*> EntryHostIndex::entries(const QStringList& hostLevels)
+{
+    QMutexLocker locker(&m_mutex);
+    update();
+
+    QList<Entry*> result;
+    QSet<Entry*> seen;
+    for (const QString& host : hostLevels) {
+        for (Entry* entry : searchableEntries(host.toLower())) {
+            if (!seen.contains(entry)) {
+                seen.insert(entry);
+                result.append(entry);
+            }
+        }
+    }
+    return result;
+}
+
+/**
+ * Normalize a URL or bare host name to the lower case host used as index key.
+ * Returns an empty string for values that don't look like a host.
+ */
+QString EntryHostIndex::hostKey(const QString& value)
+{
+    QString url = value.trimmed();
+    if (url.isEmpty()) {
+        return QString();
+    }
+
+    if (!url.contains("://")) {
+        if (!url.contains('.') || url.contains(QRegExp("\\s"))) {
+            return QString();
+        }
+        url.prepend("http://");
+    }
+
+    return QUrl(url).host().toLower();
+}
+
+void EntryHostIndex::groupAboutToAdd(Group* group)
+{
+    addGroup(group);
+}
+
+void EntryHostIndex::groupAboutToRemove(Group* group)
+{
+    removeGroup(group);
+}
+
+void EntryHostIndex::entryAdded(Entry* entry)
+{
+    indexEntry(entry);
+}
+
+void EntryHostIndex::entryAboutToRemove(Entry* entry)
+{
+    unindexEntry(entry);
+}
+
+void EntryHostIndex::entryModified()
+{
+    Entry* entry = qobject_cast<Entry*>(sender());
+    if (entry && m_entryHosts.contains(entry)) {
+        m_dirtyEntries.insert(entry);
+    }
+}
+
+void EntryHostIndex::update()
+{
+    if (m_db->rootGroup() != m_rootGroup) {
+        rebuild();
+    }
+
+    const QSet<Entry*> dirtyEntries = m_dirtyEntries + m_dynamicEntries;
+    for (Entry* entry : dirtyEntries) {
+        unindexEntry(entry);
+        indexEntry(entry);
+    }
+}
+
+void EntryHostIndex::rebuild()
+{
+    if (m_rootGroup) {
+        removeGroup(m_rootGroup);
+    }
+
+    m_hosts.clear();
+    m_entryHosts.clear();
+    m_dirtyEntries.clear();
+    m_dynamicEntries.clear();
+
+    m_rootGroup = m_db->rootGroup();
+    if (m_rootGroup) {
+        addGroup(m_rootGroup);
+    }
+}
+
+void EntryHostIndex::addGroup(Group* group)
+{
+    for (Group* child : group->groupsRecursive(true)) {
+        connect(child, SIGNAL(entryAdded(Entry*)), SLOT(entryAdded(Entry*)));
+        connect(child, SIGNAL(entryAboutToRemove(Entry*)), SLOT(entryAboutToRemove(Entry*)));
+
+        for (Entry* entry : child->entries()) {
+            indexEntry(entry);
+        }
+    }
+}
+
+void EntryHostIndex::removeGroup(Group* group)
+{
+    for (Group* child : group->groupsRecursive(true)) {
+        child->disconnect(this);
+
+        for (Entry* entry : child->entries()) {
+            unindexEntry(entry);
+        }
+    }
+}
+
+void EntryHostIndex::indexEntry(Entry* entry)
+{
+    if (m_entryHosts.contains(entry)) {
+        return;
+    }
+
+    connect(entry, SIGNAL(modified()), SLOT(entryModified()), Qt::UniqueConnection);
+
+    const QStringList hosts = entryHosts(entry);
+    for (const QString& host : hosts) {
+        m_hosts[host].append(entry);
+    }
+    m_entryHosts.insert(entry, hosts);
+
+    if (entry->url().contains('{')) {
+        m_dynamicEntries.insert(entry);
+    }
+}
+
+void EntryHostIndex::unindexEntry(Entry* entry)
+{
+    if (!m_entryHosts.contains(entry)) {
+        return;
+    }
+
+    entry->disconnect(this);
+    m_dirtyEntries.remove(entry);
+    m_dynamicEntries.remove(entry);
+
+    const QStringList hosts = m_entryHosts.take(entry);
+    for (const QString& host : hosts) {
+        QList<Entry*>& entries = m_hosts[host];
+        entries.removeOne(entry);
+        if (entries.isEmpty()) {
+            m_hosts.remove(host);
+        }
+    }
+}
+
+QList<Entry*> EntryHostIndex::searchableEntries(const QString& host) const
+{
+    QList<Entry*> result;
+    for (Entry* entry : m_hosts.value(host)) {
+        if (isSearchable(entry)) {
+            result.append(entry);
+        }
+    }
+    return result;
+}
+
+QStringList EntryHostIndex::entryHosts(const Entry* entry)
+{
+    QStringList hosts;
+    hosts << hostKey(entry->webUrl()) << hostKey(entry->title());
+
+    for (const char* attribute : EntryConfigAttributes) {
+        const QString config = entry->attributes()->value(QLatin1String(attribute));
+        if (config.isEmpty()) {
+            continue;
+        }
+        const QJsonArray allowed = QJsonDocument::fromJson(config.toUtf8()).object().value("Allow").toArray();
+        for (const QJsonValue& host : allowed) {
+            hosts << host.toString().trimmed().toLower();
+        }
+    }
+
+    hosts.removeAll(QString());
+    hosts.removeDuplicates();
+    return hosts;
+}
+
+bool EntryHostIndex::isSearchable(const Entry* entry)
+{
+    // same rule as EntrySearcher: a disabled group hides its whole subtree
+    for (const Group* group = entry->group(); group; group = group->parentGroup()) {
+        if (group->searchingEnabled() == Group::Disable) {
+            return false;
+        }
+    }
+    return true;
+}
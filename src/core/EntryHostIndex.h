@@ -0,0 +1,86 @@
+/*
+ *  Copyright (C) 2017 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSX_ENTRYHOSTINDEX_H
+#define KEEPASSX_ENTRYHOSTINDEX_H
+
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QPointer>
+#include <QSet>
+#include <QStringList>
+
+class Database;
+class Entry;
+class Group;
+
+/**
+ * Maps normalized host names to the entries of a database that refer to them
+ * through their URL, their title or the allow-list of their browser
+ * integration settings. URLs are indexed with placeholders and references
+ * resolved, like Entry::webUrl().
+ *
+ * Each database owns one index, see Database::hostIndex(). It follows entry
+ * and group changes, re-indexing modified entries lazily on the next lookup.
+ * Entries whose URL contains placeholders are re-indexed on every lookup as
+ * the entries they refer to may have changed.
+ *
+ * entries() may be called from a worker thread as long as the thread owning
+ * the database is blocked until it returns.
+ */
+class EntryHostIndex : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit EntryHostIndex(Database* db);
+
+    QList<Entry*> entries(const QString& host);
+    QList<Entry*> entries(const QStringList& hostLevels);
+
+    static QString hostKey(const QString& value);
+
+private slots:
+    void groupAboutToAdd(Group* group);
+    void groupAboutToRemove(Group* group);
+    void entryAdded(Entry* entry);
+    void entryAboutToRemove(Entry* entry);
+    void entryModified();
+
+private:
+    void update();
+    void rebuild();
+    QList<Entry*> searchableEntries(const QString& host) const;
+    void addGroup(Group* group);
+    void removeGroup(Group* group);
+    void indexEntry(Entry* entry);
+    void unindexEntry(Entry* entry);
+    static QStringList entryHosts(const Entry* entry);
+    static bool isSearchable(const Entry* entry);
+
+    Database* const m_db;
+    QMutex m_mutex;
+    QPointer<Group> m_rootGroup;
+    QHash<QString, QList<Entry*>> m_hosts;
+    QHash<Entry*, QStringList> m_entryHosts;
+    QSet<Entry*> m_dirtyEntries;
+    QSet<Entry*> m_dynamicEntries;
+};
+
+#endif // KEEPASSX_ENTRYHOSTINDEX_H
@@ -0,0 +1,128 @@
+/*
+ *  Copyright (C) 2017 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "EntryRanker.h"
+
+#include <QCollator>
+#include <QUrl>
+
+#include <algorithm>
+#include <vector>
+
+#include "core/Entry.h"
+
+namespace
+{
+    struct RankedEntry
+    {
+        int priority;
+        QCollatorSortKey key;
+        int position;
+        Entry* entry;
+    };
+}
+
+EntryRanker::EntryRanker(const QString& host, const QString& submitUrl)
+    : m_host(host)
+{
+    QUrl url(submitUrl);
+    if (url.scheme().isEmpty()) {
+        url.setScheme("http");
+    }
+
+    m_submitUrl = url.toString(QUrl::StripTrailingSlash);
+    m_baseSubmitUrl = url.toString(QUrl::StripTrailingSlash | QUrl::RemovePath | QUrl::RemoveQuery | QUrl::RemoveFragment);
+}
+
+int EntryRanker::priority(const Entry* entry) const
+{
+    QUrl url(entry->url());
+    if (url.scheme().isEmpty()) {
+        url.setScheme("http");
+    }
+    const QString entryURL = url.toString(QUrl::StripTrailingSlash);
+    const QString baseEntryURL = url.toString(QUrl::StripTrailingSlash | QUrl::RemovePath | QUrl::RemoveQuery | QUrl::RemoveFragment);
+
+    if (m_submitUrl == entryURL) {
+        return 100;
+    }
+    if (m_submitUrl.startsWith(entryURL) && entryURL != m_host && m_baseSubmitUrl != entryURL) {
+        return 90;
+    }
+    if (m_submitUrl.startsWith(baseEntryURL) && entryURL != m_host && m_baseSubmitUrl != baseEntryURL) {
+        return 80;
+    }
+    if (entryURL == m_host) {
+        return 70;
+    }
+    if (entryURL == m_baseSubmitUrl) {
+        return 60;
+    }
+    if (entryURL.startsWith(m_submitUrl)) {
+        return 50;
+    }
+    if (entryURL.startsWith(m_baseSubmitUrl) && m_baseSubmitUrl != m_host) {
+        return 40;
+    }
+    if (m_submitUrl.startsWith(entryURL)) {
+        return 30;
+    }
+    if (m_submitUrl.startsWith(baseEntryURL)) {
+        return 20;
+    }
+    if (entryURL.startsWith(m_host)) {
+        return 10;
+    }
+    if (m_host.startsWith(entryURL)) {
+        return 5;
+    }
+    return 0;
+}
+
+/**
+ * Sort entries by ascending priority and, for equal priorities, by the
+ * attribute named field in locale-aware order.
+ */
+QList<Entry*> EntryRanker::sort(const QList<Entry*>& entries, const QString& field) const
+{
+    QCollator collator;
+
+    std::vector<RankedEntry> ranked;
+    ranked.reserve(entries.size());
+    for (int i = 0; i < entries.size(); ++i) {
+        Entry* entry = entries.at(i);
+        ranked.push_back({priority(entry), collator.sortKey(entry->attributes()->value(field)), i, entry});
+    }
+
+    std::sort(ranked.begin(), ranked.end(), [](const RankedEntry& left, const RankedEntry& right) {
+        if (left.priority != right.priority) {
+            return left.priority < right.priority;
+        }
+        int res = left.key.compare(right.key);
+        if (res != 0) {
+            return res < 0;
+        }
+        return left.position < right.position;
+    });
+
+    QList<Entry*> result;
+    result.reserve(static_cast<int>(ranked.size()));
+    for (const RankedEntry& rankedEntry : ranked) {
+        result.append(rankedEntry.entry);
+    }
+    return result;
+}
@@ -0,0 +1,47 @@
+/*
+ *  Copyright (C) 2017 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSX_ENTRYRANKER_H
+#define KEEPASSX_ENTRYRANKER_H
+
+#include <QList>
+#include <QString>
+
+class Entry;
+
+/**
+ * Orders entries found for a browser request by how closely their URL
+ * matches the submit URL, then by the given attribute in locale order.
+ *
+ * The priority and the collation key of every entry are computed once
+ * before sorting, so comparisons only look at precomputed values.
+ */
+class EntryRanker
+{
+public:
+    EntryRanker(const QString& host, const QString& submitUrl);
+
+    int priority(const Entry* entry) const;
+    QList<Entry*> sort(const QList<Entry*>& entries, const QString& field) const;
+
+private:
+    const QString m_host;
+    QString m_submitUrl;
+    QString m_baseSubmitUrl;
+};
+
+#endif // KEEPASSX_ENTRYRANKER_H
@@ -0,0 +1,173 @@
+/*
+ *  Copyright (C) 2017 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "EntrySearchTask.h"
+
+#include <QElapsedTimer>
+#include <QTimer>
+
+#include "core/Entry.h"
+#include "core/Group.h"
+
+const int EntrySearchTask::TimeSliceMs = 15;
+
+EntrySearchTask::EntrySearchTask(QObject* parent)
+    : QObject(parent)
+    , m_timer(new QTimer(this))
+    , m_caseSensitivity(Qt::CaseInsensitive)
+    , m_position(0)
+    , m_reported(0)
+    , m_complete(false)
+{
+    m_timer->setInterval(0);
+    connect(m_timer, SIGNAL(timeout()), SLOT(processBatch()));
+}
+
+void EntrySearchTask::start(const QString& searchTerm, Group* group, Qt::CaseSensitivity caseSensitivity)
+{
+    Q_ASSERT(group);
+
+    const bool refine = canRefine(searchTerm, group, caseSensitivity);
+
+    m_timer->stop();
+    m_candidates.clear();
+
+    if (refine) {
+        // every match of the new term also matched the previous one
+        m_candidates = m_results;
+    } else if (group->resolveSearchingEnabled()) {
+        const QList<Entry*> entries = group->entriesRecursive();
+        m_candidates.reserve(entries.size());
+        for (Entry* entry : entries) {
+            m_candidates.append(entry);
+        }
+    }
+
+    m_searchTerm = searchTerm;
+    m_words = EntrySearcher::splitSearchTerm(searchTerm);
+    m_group = group;
+    m_caseSensitivity = caseSensitivity;
+    m_results.clear();
+    m_position = 0;
+    m_reported = 0;
+    m_complete = false;
+
+    m_timer->start();
+}
+
+void EntrySearchTask::cancel()
+{
+    if (isRunning()) {
+        m_timer->stop();
+        m_candidates.clear();
+        // a partial result can't be refined later on
+        m_searchTerm.clear();
+        m_results.clear();
+    }
+}
+
+/**
+ * Stop the running search and forget the previous results.
+ */
+void EntrySearchTask::clear()
+{
+    m_timer->stop();
+    m_candidates.clear();
+    m_results.clear();
+    m_searchTerm.clear();
+    m_complete = false;
+}
+
+/**
+ * Forget the previous results so the next search scans the whole group again.
+ * A running search is restarted on the modified data and still emits finished().
+ * Needs to be called whenever the database has been modified.
+ */
+void EntrySearchTask::invalidate()
+{
+    m_complete = false;
+
+    if (isRunning() && m_group) {
+        start(m_searchTerm, m_group, m_caseSensitivity);
+    }
+}
+
+bool EntrySearchTask::isRunning() const
+{
+    return m_timer->isActive();
+}
+
+QList<Entry*> EntrySearchTask::results() const
+{
+    QList<Entry*> results;
+    for (const QPointer<Entry>& entry : m_results) {
+        if (entry) {
+            results.append(entry.data());
+        }
+    }
+    return results;
+}
+
+bool EntrySearchTask::canRefine(const QString& searchTerm, const Group* group,
+                                Qt::CaseSensitivity caseSensitivity) const
+{
+    return m_complete && !m_searchTerm.isEmpty() && m_group.data() == group
+            && m_caseSensitivity == caseSensitivity
+            && searchTerm.startsWith(m_searchTerm, caseSensitivity);
+}
+
+void EntrySearchTask::processBatch()
+{
+    if (!m_group) {
+        clear();
+        emit resultsReady(QList<Entry*>(), true);
+        emit finished(0);
+        return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    while (m_position < m_candidates.size()) {
+        Entry* entry = m_candidates.at(m_position++).data();
+        if (entry && m_searcher.isMatch(m_words, entry, m_group, m_caseSensitivity)) {
+            m_results.append(entry);
+        }
+
+        if ((m_position % 64) == 0 && timer.elapsed() >= TimeSliceMs) {
+            break;
+        }
+    }
+
+    const bool done = m_position >= m_candidates.size();
+    const bool firstBatch = m_reported == 0;
+    if (m_results.size() > m_reported || (done && firstBatch)) {
+        QList<Entry*> batch;
+        for (int i = m_reported; i < m_results.size(); ++i) {
+            batch.append(m_results.at(i).data());
+        }
+        m_reported = m_results.size();
+        emit resultsReady(batch, firstBatch);
+    }
+
+    if (done) {
+        m_timer->stop();
+        m_candidates.clear();
+        m_complete = true;
+        emit finished(m_results.size());
+    }
+}
@@ -0,0 +1,80 @@
+/*
+ *  Copyright (C) 2017 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSX_ENTRYSEARCHTASK_H
+#define KEEPASSX_ENTRYSEARCHTASK_H
+
+#include <QList>
+#include <QObject>
+#include <QPointer>
+#include <QStringList>
+
+#include "core/EntrySearcher.h"
+
+class Entry;
+class Group;
+class QTimer;
+
+/**
+ * Runs an entry search in small time slices on the event loop so that
+ * the GUI stays responsive while typing. Results are reported in batches.
+ *
+ * Starting a new search cancels the running one. A search term that extends
+ * the previous one only rescans the entries found by the previous search.
+ */
+class EntrySearchTask : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit EntrySearchTask(QObject* parent = nullptr);
+
+    void start(const QString& searchTerm, Group* group, Qt::CaseSensitivity caseSensitivity);
+    void cancel();
+    bool isRunning() const;
+    QList<Entry*> results() const;
+    void clear();
+
+public slots:
+    void invalidate();
+
+signals:
+    void resultsReady(const QList<Entry*>& entries, bool firstBatch);
+    void finished(int resultCount);
+
+private slots:
+    void processBatch();
+
+private:
+    bool canRefine(const QString& searchTerm, const Group* group, Qt::CaseSensitivity caseSensitivity) const;
+
+    static const int TimeSliceMs;
+
+    QTimer* m_timer;
+    EntrySearcher m_searcher;
+    QString m_searchTerm;
+    QStringList m_words;
+    QPointer<Group> m_group;
+    Qt::CaseSensitivity m_caseSensitivity;
+    QList<QPointer<Entry>> m_candidates;
+    QList<QPointer<Entry>> m_results;
+    int m_position;
+    int m_reported;
+    bool m_complete;
+};
+
+#endif // KEEPASSX_ENTRYSEARCHTASK_H
@@ -18,6 +18,7 @@
 
 #include "EntrySearcher.h"
 
+#include "core/Global.h"
 #include "core/Group.h"
 
 QList<Entry*> EntrySearcher::search(const QString& searchTerm, const Group* group,
@@ -27,26 +28,72 @@ QList<Entry*> EntrySearcher::search(const QString& searchTerm, const Group* grou
         return QList<Entry*>();
     }
 
-    return searchEntries(searchTerm, group, caseSensitivity);
+    return searchEntries(splitSearchTerm(searchTerm), group, caseSensitivity);
 }
 
-QList<Entry*> EntrySearcher::searchEntries(const QString& searchTerm, const Group* group,
+/**
+ * Check whether a single entry would be part of the result of a search
+ * below searchRoot. The caller is responsible for checking that searching
+ * is enabled for searchRoot itself.
+ *
+ * @param words search term split with splitSearchTerm()
+ * @param entry entry inside searchRoot
+ * @param searchRoot group the search was started from
+ * @param caseSensitivity case sensitivity of the search
+ * @return true if search() would include the entry
+ */
+bool EntrySearcher::isMatch(const QStringList& words, Entry* entry, const Group* searchRoot,
+                            Qt::CaseSensitivity caseSensitivity)
+{
+    QList<const Group*> groups;
+    const Group* group = entry->group();
+    while (group && group != searchRoot) {
+        groups.prepend(group);
+        group = group->parentGroup();
+    }
+
+    if (!group) {
+        // entry is not (or no longer) inside the search root
+        return false;
+    }
+
+    // walk down from the search root the same way searchEntries() does
+    for (const Group* parent : asConst(groups)) {
+        if (parent->searchingEnabled() == Group::Disable) {
+            return false;
+        }
+        if (matchGroup(words, parent, caseSensitivity)) {
+            return true;
+        }
+    }
+
+    return matchEntry(words, entry, caseSensitivity);
+}
+
+QStringList EntrySearcher::splitSearchTerm(const QString& searchTerm)
+{
+    return searchTerm.split(QRegExp("\\s"), QString::SkipEmptyParts);
+}
+
+QList<Entry*> EntrySearcher::searchEntries(const QStringList& words, const Group* group,
                                            Qt::CaseSensitivity caseSensitivity)
 {
     QList<Entry*> searchResult;
 
     const QList<Entry*> entryList = group->entries();
     for (Entry* entry : entryList) {
-       searchResult.append(matchEntry(searchTerm, entry, caseSensitivity));
+        if (matchEntry(words, entry, caseSensitivity)) {
+            searchResult.append(entry);
+        }
     }
 
     const QList<Group*> children = group->children();
     for (Group* childGroup : children) {
         if (childGroup->searchingEnabled() != Group::Disable) {
-            if (matchGroup(searchTerm, childGroup, caseSensitivity)) {
+            if (matchGroup(words, childGroup, caseSensitivity)) {
                 searchResult.append(childGroup->entriesRecursive());
             } else {
-                searchResult.append(searchEntries(searchTerm, childGroup, caseSensitivity));
+                searchResult.append(searchEntries(words, childGroup, caseSensitivity));
             }
         }
     }
@@ -54,17 +101,15 @@ QList<Entry*> EntrySearcher::searchEntries(const QString& searchTerm, const Grou
     return searchResult;
 }
 
-QList<Entry*> EntrySearcher::matchEntry(const QString& searchTerm, Entry* entry,
-                                        Qt::CaseSensitivity caseSensitivity)
+bool EntrySearcher::matchEntry(const QStringList& words, Entry* entry, Qt::CaseSensitivity caseSensitivity)
 {
-    const QStringList wordList = searchTerm.split(QRegExp("\\s"), QString::SkipEmptyParts);
-    for (const QString& word : wordList) {
+    for (const QString& word : words) {
         if (!wordMatch(word, entry, caseSensitivity)) {
-            return QList<Entry*>();
+            return false;
         }
     }
 
-    return QList<Entry*>() << entry;
+    return true;
 }
 
 bool EntrySearcher::wordMatch(const QString& word, Entry* entry, Qt::CaseSensitivity caseSensitivity)
@@ -75,10 +120,9 @@ bool EntrySearcher::wordMatch(const QString& word, Entry* entry, Qt::CaseSensiti
             entry->resolvePlaceholder(entry->notes()).contains(word, caseSensitivity);
 }
 
-bool EntrySearcher::matchGroup(const QString& searchTerm, const Group* group, Qt::CaseSensitivity caseSensitivity)
+bool EntrySearcher::matchGroup(const QStringList& words, const Group* group, Qt::CaseSensitivity caseSensitivity)
 {
-    const QStringList wordList = searchTerm.split(QRegExp("\\s"), QString::SkipEmptyParts);
-    for (const QString& word : wordList) {
+    for (const QString& word : words) {
         if (!wordMatch(word, group, caseSensitivity)) {
             return false;
         }
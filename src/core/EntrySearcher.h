@@ -20,6 +20,7 @@
 #define KEEPASSX_ENTRYSEARCHER_H
 
 #include <QString>
+#include <QStringList>
 
 
 class Group;
@@ -29,12 +30,16 @@ class EntrySearcher
 {
 public:
     QList<Entry*> search(const QString& searchTerm, const Group* group, Qt::CaseSensitivity caseSensitivity);
+    bool isMatch(const QStringList& words, Entry* entry, const Group* searchRoot,
+                 Qt::CaseSensitivity caseSensitivity);
+
+    static QStringList splitSearchTerm(const QString& searchTerm);
 
 private:
-    QList<Entry*> searchEntries(const QString& searchTerm, const Group* group, Qt::CaseSensitivity caseSensitivity);
-    QList<Entry*> matchEntry(const QString& searchTerm, Entry* entry, Qt::CaseSensitivity caseSensitivity);
+    QList<Entry*> searchEntries(const QStringList& words, const Group* group, Qt::CaseSensitivity caseSensitivity);
+    bool matchEntry(const QStringList& words, Entry* entry, Qt::CaseSensitivity caseSensitivity);
     bool wordMatch(const QString& word, Entry* entry, Qt::CaseSensitivity caseSensitivity);
-    bool matchGroup(const QString& searchTerm, const Group* group, Qt::CaseSensitivity caseSensitivity);
+    bool matchGroup(const QStringList& words, const Group* group, Qt::CaseSensitivity caseSensitivity);
     bool wordMatch(const QString& word, const Group* group, Qt::CaseSensitivity caseSensitivity);
 };
 
@@ -51,6 +51,9 @@ QString FilePath::pluginPath(const QString& name)
     // for TestAutoType
     pluginPaths << QCoreApplication::applicationDirPath() + "/../src/autotype/test";
 
+    // for TestGuiAutoTypeX11
+    pluginPaths << QCoreApplication::applicationDirPath() + "/../../src/autotype/xcb";
+
 #if defined(Q_OS_MAC) && defined(WITH_APP_BUNDLE)
     pluginPaths << QCoreApplication::applicationDirPath() + "/../PlugIns";
 #endif
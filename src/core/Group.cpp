@@ -32,7 +32,8 @@ Entry::CloneFlags Group::DefaultEntryCloneFlags = static_cast<Entry::CloneFlags>
     Entry::CloneNewUuid | Entry::CloneResetTimeInfo);
 
 Group::Group()
-    : m_updateTimeinfo(true)
+    : m_indexInParent(-1)
+    , m_updateTimeinfo(true)
 {
     m_data.iconNumber = DefaultIconNumber;
     m_data.isExpanded = true;
@@ -361,6 +362,16 @@ const Group* Group::parentGroup() const
     return m_parent;
 }
 
+/**
+ * Position of this group in parentGroup()->children(), kept up to date
+ * on every insert, move and removal so models can map groups to rows
+ * without searching the sibling list. Returns -1 for a root group.
+ */
+int Group::indexInParent() const
+{
+    return m_parent ? m_indexInParent : -1;
+}
+
 void Group::setParent(Group* parent, int index)
 {
     Q_ASSERT(parent);
@@ -378,7 +389,7 @@ void Group::setParent(Group* parent, int index)
         }
     }
 
-    if (m_parent == parent && parent->children().indexOf(this) == index) {
+    if (m_parent == parent && m_indexInParent == index) {
         return;
     }
 
@@ -392,7 +403,7 @@ void Group::setParent(Group* parent, int index)
             if (!iconUuid().isNull() && parent->m_db
                     && m_db->metadata()->containsCustomIcon(iconUuid())
                     && !parent->m_db->metadata()->containsCustomIcon(iconUuid())) {
-                parent->m_db->metadata()->addCustomIcon(iconUuid(), icon());
+                parent->m_db->metadata()->addCustomIcon(iconUuid(), m_db->metadata()->customIconData(iconUuid()));
             }
         }
         if (m_db != parent->m_db) {
@@ -402,14 +413,22 @@ void Group::setParent(Group* parent, int index)
         emit aboutToAdd(this, index);
         Q_ASSERT(index <= parent->m_children.size());
         parent->m_children.insert(index, this);
+        parent->updateChildIndexes(index);
     }
     else {
         emit aboutToMove(this, parent, index);
-        m_parent->m_children.removeAll(this);
+        int oldIndex = m_indexInParent;
+        bool sameParent = (m_parent == parent);
+        Q_ASSERT(m_parent->m_children.at(oldIndex) == this);
+        m_parent->m_children.removeAt(oldIndex);
+        if (!sameParent) {
+            m_parent->updateChildIndexes(oldIndex);
+        }
         m_parent = parent;
         QObject::setParent(parent);
         Q_ASSERT(index <= parent->m_children.size());
         parent->m_children.insert(index, this);
+        parent->updateChildIndexes(sameParent ? qMin(oldIndex, index) : index);
     }
 
     if (m_updateTimeinfo) {
@@ -873,12 +892,22 @@ void Group::cleanupParent()
 {
     if (m_parent) {
         emit aboutToRemove(this);
-        m_parent->m_children.removeAll(this);
+        Q_ASSERT(m_parent->m_children.at(m_indexInParent) == this);
+        m_parent->m_children.removeAt(m_indexInParent);
+        m_parent->updateChildIndexes(m_indexInParent);
+        m_indexInParent = -1;
         emit modified();
         emit removed();
     }
 }
 
+void Group::updateChildIndexes(int from)
+{
+    for (int i = from; i < m_children.size(); i++) {
+        m_children.at(i)->m_indexInParent = i;
+    }
+}
+
 void Group::recCreateDelObjects()
 {
     if (m_db) {
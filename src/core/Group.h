@@ -116,6 +116,7 @@ public:
 
     Group* parentGroup();
     const Group* parentGroup() const;
+    int indexInParent() const;
     void setParent(Group* parent, int index = -1);
     QStringList hierarchy();
 
@@ -175,6 +176,7 @@ private:
 
     void recSetDatabase(Database* db);
     void cleanupParent();
+    void updateChildIndexes(int from);
     void recCreateDelObjects();
     void updateTimeinfo();
 
@@ -186,6 +188,7 @@ private:
     QList<Entry*> m_entries;
 
     QPointer<Group> m_parent;
+    int m_indexInParent;
 
     bool m_updateTimeinfo;
 
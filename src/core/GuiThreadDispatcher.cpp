@@ -0,0 +1,76 @@
+/*
+ *  Copyright (C) 2017 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "GuiThreadDispatcher.h"
+
+#include <QMutexLocker>
+#include <QThread>
+
+#include "core/Entry.h"
+
+GuiThreadDispatcher::GuiThreadDispatcher(QObject* target)
+    : m_target(target)
+{
+}
+
+/**
+ * Invoke the given slot of the target on its thread and wait for it to
+ * return. The arguments are the same as for QMetaObject::invokeMethod().
+ *
+ * @return false if called on the target's thread, the caller then has to
+ *         handle the call itself
+ */
+bool GuiThreadDispatcher::dispatch(const char* method, CallMode mode, QGenericReturnArgument ret,
+                                   QGenericArgument val0, QGenericArgument val1, QGenericArgument val2,
+                                   QGenericArgument val3, QGenericArgument val4, QGenericArgument val5) const
+{
+    if (m_target->thread() == QThread::currentThread()) {
+        return false;
+    }
+
+    QMutexLocker locker(mode == Exclusive ? &m_exclusiveMutex : nullptr);
+    QMetaObject::invokeMethod(m_target, method, Qt::BlockingQueuedConnection, ret,
+                              val0, val1, val2, val3, val4, val5);
+    return true;
+}
+
+/**
+ * Track entries across a dialog. Its event loop may delete them, for example
+ * when the database gets locked meanwhile.
+ */
+QList<QPointer<Entry>> GuiThreadDispatcher::guardEntries(const QList<Entry*>& entries)
+{
+    QList<QPointer<Entry>> guarded;
+    for (Entry* entry : entries) {
+        guarded << entry;
+    }
+    return guarded;
+}
+
+/**
+ * The entries guarded by guardEntries() that still exist.
+ */
+QList<Entry*> GuiThreadDispatcher::liveEntries(const QList<QPointer<Entry>>& guarded)
+{
+    QList<Entry*> entries;
+    for (const QPointer<Entry>& entry : guarded) {
+        if (entry) {
+            entries << entry.data();
+        }
+    }
+    return entries;
+}
@@ -0,0 +1,68 @@
+/*
+ *  Copyright (C) 2017 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSX_GUITHREADDISPATCHER_H
+#define KEEPASSX_GUITHREADDISPATCHER_H
+
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QPointer>
+
+class Entry;
+
+/**
+ * Forwards calls of a browser integration service from the worker threads
+ * answering requests to the thread owning the service, usually the GUI
+ * thread, which owns the databases and shows the dialogs. The worker thread
+ * blocks until the call returns.
+ *
+ * Exclusive calls may show a dialog or modify a database. They run one at a
+ * time, so none starts in the event loop of another one's dialog. Shared
+ * calls only read and may run at any time.
+ */
+class GuiThreadDispatcher
+{
+public:
+    enum CallMode
+    {
+        Shared,
+        Exclusive
+    };
+
+    explicit GuiThreadDispatcher(QObject* target);
+
+    bool dispatch(const char* method, CallMode mode,
+                  QGenericReturnArgument ret = QGenericReturnArgument(),
+                  QGenericArgument val0 = QGenericArgument(),
+                  QGenericArgument val1 = QGenericArgument(),
+                  QGenericArgument val2 = QGenericArgument(),
+                  QGenericArgument val3 = QGenericArgument(),
+                  QGenericArgument val4 = QGenericArgument(),
+                  QGenericArgument val5 = QGenericArgument()) const;
+
+    static QList<QPointer<Entry>> guardEntries(const QList<Entry*>& entries);
+    static QList<Entry*> liveEntries(const QList<QPointer<Entry>>& guarded);
+
+private:
+    QObject* const m_target;
+    mutable QMutex m_exclusiveMutex;
+
+    Q_DISABLE_COPY(GuiThreadDispatcher)
+};
+
+#endif // KEEPASSX_GUITHREADDISPATCHER_H
@@ -18,6 +18,8 @@
 #include <QtCore/QCryptographicHash>
 #include "Metadata.h"
 
+#include <QBuffer>
+
 #include "core/Entry.h"
 #include "core/Group.h"
 #include "core/Tools.h"
@@ -159,6 +161,22 @@ bool Metadata::protectNotes() const
 }
 
 QImage Metadata::customIcon(const Uuid& uuid) const
+{
+    if (!m_customIcons.contains(uuid)) {
+        return QImage();
+    }
+
+    auto it = m_customIconsDecoded.constFind(uuid);
+    if (it != m_customIconsDecoded.constEnd()) {
+        return it.value();
+    }
+
+    QImage icon = QImage::fromData(m_customIcons.value(uuid));
+    m_customIconsDecoded.insert(uuid, icon);
+    return icon;
+}
+
+QByteArray Metadata::customIconData(const Uuid& uuid) const
 {
     return m_customIcons.value(uuid);
 }
@@ -174,7 +192,7 @@ QPixmap Metadata::customIconPixmap(const Uuid& uuid) const
     QPixmapCache::Key& cacheKey = m_customIconCacheKeys[uuid];
 
     if (!QPixmapCache::find(cacheKey, &pixmap)) {
-        pixmap = QPixmap::fromImage(m_customIcons.value(uuid));
+        pixmap = QPixmap::fromImage(customIcon(uuid));
         cacheKey = QPixmapCache::insert(pixmap);
     }
 
@@ -192,7 +210,7 @@ QPixmap Metadata::customIconScaledPixmap(const Uuid& uuid) const
     QPixmapCache::Key& cacheKey = m_customIconScaledCacheKeys[uuid];
 
     if (!QPixmapCache::find(cacheKey, &pixmap)) {
-        QImage image = m_customIcons.value(uuid).scaled(16, 16, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+        QImage image = customIcon(uuid).scaled(16, 16, Qt::KeepAspectRatio, Qt::SmoothTransformation);
         pixmap = QPixmap::fromImage(image);
         cacheKey = QPixmapCache::insert(pixmap);
     }
@@ -207,7 +225,13 @@ bool Metadata::containsCustomIcon(const Uuid& uuid) const
 
 QHash<Uuid, QImage> Metadata::customIcons() const
 {
-    return m_customIcons;
+    QHash<Uuid, QImage> result;
+
+    for (const Uuid& uuid : m_customIconsOrder) {
+        result.insert(uuid, customIcon(uuid));
+    }
+
+    return result;
 }
 
 QHash<Uuid, QPixmap> Metadata::customIconsScaledPixmaps() const
@@ -372,17 +396,25 @@ void Metadata::setProtectNotes(bool value)
 }
 
 void Metadata::addCustomIcon(const Uuid& uuid, const QImage& icon)
+{
+    addCustomIcon(uuid, encodeImage(icon));
+    // keep the original image, no need to decode it again
+    m_customIconsDecoded.insert(uuid, icon);
+}
+
+void Metadata::addCustomIcon(const Uuid& uuid, const QByteArray& iconData)
 {
     Q_ASSERT(!uuid.isNull());
     Q_ASSERT(!m_customIcons.contains(uuid));
 
-    m_customIcons.insert(uuid, icon);
+    m_customIcons.insert(uuid, iconData);
     // reset cache in case there is also an icon with that uuid
+    m_customIconsDecoded.remove(uuid);
     m_customIconCacheKeys[uuid] = QPixmapCache::Key();
     m_customIconScaledCacheKeys[uuid] = QPixmapCache::Key();
     m_customIconsOrder.append(uuid);
-    // Associate image hash to uuid
-    QByteArray hash = hashImage(icon);
+    // Associate icon data hash to uuid
+    QByteArray hash = hashIconData(iconData);
     m_customIconsHashes[hash] = uuid;
     Q_ASSERT(m_customIcons.count() == m_customIconsOrder.count());
     emit modified();
@@ -410,12 +442,13 @@ void Metadata::removeCustomIcon(const Uuid& uuid)
     Q_ASSERT(m_customIcons.contains(uuid));
 
     // Remove hash record only if this is the same uuid
-    QByteArray hash = hashImage(m_customIcons[uuid]);
+    QByteArray hash = hashIconData(m_customIcons[uuid]);
     if (m_customIconsHashes.contains(hash) && m_customIconsHashes[hash] == uuid) {
         m_customIconsHashes.remove(hash);
     }
 
     m_customIcons.remove(uuid);
+    m_customIconsDecoded.remove(uuid);
     QPixmapCache::remove(m_customIconCacheKeys.value(uuid));
     m_customIconCacheKeys.remove(uuid);
     QPixmapCache::remove(m_customIconScaledCacheKeys.value(uuid));
@@ -425,9 +458,9 @@ void Metadata::removeCustomIcon(const Uuid& uuid)
     emit modified();
 }
 
-Uuid Metadata::findCustomIcon(const QImage &candidate)
+Uuid Metadata::findCustomIcon(const QByteArray& candidateData)
 {
-    QByteArray hash = hashImage(candidate);
+    QByteArray hash = hashIconData(candidateData);
     return m_customIconsHashes.value(hash, Uuid());
 }
 
@@ -437,15 +470,24 @@ void Metadata::copyCustomIcons(const QSet<Uuid>& iconList, const Metadata* other
         Q_ASSERT(otherMetadata->containsCustomIcon(uuid));
 
         if (!containsCustomIcon(uuid) && otherMetadata->containsCustomIcon(uuid)) {
-            addCustomIcon(uuid, otherMetadata->customIcon(uuid));
+            addCustomIcon(uuid, otherMetadata->customIconData(uuid));
         }
     }
 }
 
-QByteArray Metadata::hashImage(const QImage& image)
+QByteArray Metadata::encodeImage(const QImage& image)
+{
+    QByteArray data;
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+    image.save(&buffer, "PNG");
+    buffer.close();
+    return data;
+}
+
+QByteArray Metadata::hashIconData(const QByteArray& iconData)
 {
-    auto data = QByteArray(reinterpret_cast<const char*>(image.bits()), image.byteCount());
-    return QCryptographicHash::hash(data, QCryptographicHash::Md5);
+    return QCryptographicHash::hash(iconData, QCryptographicHash::Md5);
 }
 
 void Metadata::setRecycleBinEnabled(bool value)
@@ -78,6 +78,7 @@ public:
     bool protectUrl() const;
     bool protectNotes() const;
     QImage customIcon(const Uuid& uuid) const;
+    QByteArray customIconData(const Uuid& uuid) const;
     QPixmap customIconPixmap(const Uuid& uuid) const;
     QPixmap customIconScaledPixmap(const Uuid& uuid) const;
     bool containsCustomIcon(const Uuid& uuid) const;
@@ -118,10 +119,11 @@ public:
     void setProtectUrl(bool value);
     void setProtectNotes(bool value);
     void addCustomIcon(const Uuid& uuid, const QImage& icon);
+    void addCustomIcon(const Uuid& uuid, const QByteArray& iconData);
     void addCustomIconScaled(const Uuid& uuid, const QImage& icon);
     void removeCustomIcon(const Uuid& uuid);
     void copyCustomIcons(const QSet<Uuid>& iconList, const Metadata* otherMetadata);
-    Uuid findCustomIcon(const QImage& candidate);
+    Uuid findCustomIcon(const QByteArray& candidateData);
     void setRecycleBinEnabled(bool value);
     void setRecycleBin(Group* group);
     void setRecycleBinChanged(const QDateTime& value);
@@ -155,11 +157,14 @@ private:
     template <class P, class V> bool set(P& property, const V& value);
     template <class P, class V> bool set(P& property, const V& value, QDateTime& dateTime);
 
-    QByteArray hashImage(const QImage& image);
+    static QByteArray encodeImage(const QImage& image);
+    static QByteArray hashIconData(const QByteArray& iconData);
 
     MetadataData m_data;
 
-    QHash<Uuid, QImage> m_customIcons;
+    // custom icons are kept encoded and only decoded on first use
+    QHash<Uuid, QByteArray> m_customIcons;
+    mutable QHash<Uuid, QImage> m_customIconsDecoded;
     mutable QHash<Uuid, QPixmapCache::Key> m_customIconCacheKeys;
     mutable QHash<Uuid, QPixmapCache::Key> m_customIconScaledCacheKeys;
     QList<Uuid> m_customIconsOrder;
@@ -0,0 +1,241 @@
+/*
+ *  Copyright (C) 2017 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PasswordAudit.h"
+
+#include <QDateTime>
+#include <QtConcurrent>
+#include <zxcvbn.h>
+
+#include "core/Database.h"
+#include "core/Entry.h"
+#include "core/Global.h"
+#include "core/Group.h"
+#include "core/Metadata.h"
+#include "crypto/CryptoHash.h"
+#include "crypto/Random.h"
+
+namespace
+{
+    bool isRecycled(const Entry* entry, const Group* recycleBin)
+    {
+        for (const Group* group = entry->group(); group; group = group->parentGroup()) {
+            if (group == recycleBin) {
+                return true;
+            }
+        }
+        return false;
+    }
+}
+
+PasswordAudit::PasswordAudit(QObject* parent)
+    : QObject(parent)
+    , m_watcher(new QFutureWatcher<Score>(this))
+    , m_hashKey(randomGen()->randomArray(32))
+    , m_staleDays(365)
+{
+    connect(m_watcher, SIGNAL(resultReadyAt(int)), SLOT(scoreReady(int)));
+    connect(m_watcher, SIGNAL(finished()), SLOT(scoresFinished()));
+}
+
+PasswordAudit::~PasswordAudit()
+{
+    cancel();
+}
+
+/**
+ * Audit all entries of the database that have a password, except for those in
+ * the recycle bin. Results of entries whose password didn't change since the
+ * previous audit are reported right away, the others once their password has
+ * been estimated. finished() is emitted after the last result.
+ */
+void PasswordAudit::start(Database* db)
+{
+    Q_ASSERT(db);
+
+    cancel();
+
+    const QDateTime now = QDateTime::currentDateTimeUtc();
+    const Group* recycleBin = db->metadata()->recycleBin();
+    QHash<QByteArray, double> knownEntropy;
+    QHash<Uuid, Score> cache;
+    QList<Password> passwords;
+
+    for (Entry* entry : db->rootGroup()->entriesRecursive()) {
+        if (recycleBin && isRecycled(entry, recycleBin)) {
+            continue;
+        }
+
+        const QString password = entry->resolveMultiplePlaceholders(entry->password());
+        if (password.isEmpty()) {
+            continue;
+        }
+
+        AuditedEntry audited;
+        audited.entry = entry;
+        audited.uuid = entry->uuid();
+        audited.hash = CryptoHash::hmac(password.toUtf8(), m_hashKey, CryptoHash::Sha256);
+        audited.flags = NoFlags;
+        if (entry->isExpired()) {
+            audited.flags |= ExpiredEntry;
+        }
+        if (m_staleDays > 0 && entry->timeInfo().lastModificationTime().daysTo(now) > m_staleDays) {
+            audited.flags |= StaleEntry;
+        }
+
+        const Score cached = m_cache.value(audited.uuid);
+        if (cached.hash == audited.hash) {
+            // same password as in the previous audit
+            knownEntropy.insert(cached.hash, cached.entropy);
+            cache.insert(audited.uuid, cached);
+        }
+
+        QList<int>& bucket = m_buckets[audited.hash];
+        if (bucket.isEmpty()) {
+            Password job;
+            job.hash = audited.hash;
+            job.password = password.toUtf8();
+            passwords.append(job);
+        }
+        bucket.append(m_entries.size());
+        m_entries.append(audited);
+    }
+
+    // forget deleted entries
+    m_cache = cache;
+
+    QList<Password> jobs;
+    for (const Password& job : asConst(passwords)) {
+        if (!knownEntropy.contains(job.hash)) {
+            jobs.append(job);
+            continue;
+        }
+        const QList<int> entryIndexes = m_buckets.value(job.hash);
+        for (int index : entryIndexes) {
+            report(m_entries.at(index), knownEntropy.value(job.hash));
+        }
+    }
+
+    // an empty sequence still finishes through the watcher
+    m_watcher->setFuture(QtConcurrent::mapped(jobs, &PasswordAudit::estimate));
+}
+
+void PasswordAudit::cancel()
+{
+    if (isRunning()) {
+        m_watcher->cancel();
+        m_watcher->waitForFinished();
+    }
+    m_entries.clear();
+    m_buckets.clear();
+}
+
+bool PasswordAudit::isRunning() const
+{
+    return m_watcher->isRunning();
+}
+
+/**
+ * Number of entries the running or last audit reports results for.
+ */
+int PasswordAudit::entryCount() const
+{
+    return m_entries.size();
+}
+
+int PasswordAudit::staleDays() const
+{
+    return m_staleDays;
+}
+
+/**
+ * Flag entries that have not been modified for more than the given number of
+ * days as stale. Zero disables the check.
+ */
+void PasswordAudit::setStaleDays(int days)
+{
+    m_staleDays = days;
+}
+
+void PasswordAudit::clearCache()
+{
+    m_cache.clear();
+}
+
+/**
+ * Same rating as shown by the password generator.
+ */
+PasswordAudit::Quality PasswordAudit::quality(double entropy)
+{
+    if (entropy < 40) {
+        return Poor;
+    } else if (entropy < 65) {
+        return Weak;
+    } else if (entropy < 100) {
+        return Good;
+    }
+    return Excellent;
+}
+
+void PasswordAudit::scoreReady(int index)
+{
+    const Score score = m_watcher->resultAt(index);
+    const QList<int> entryIndexes = m_buckets.value(score.hash);
+    for (int entryIndex : entryIndexes) {
+        report(m_entries.at(entryIndex), score.entropy);
+    }
+}
+
+void PasswordAudit::scoresFinished()
+{
+    if (!m_watcher->isCanceled()) {
+        emit finished();
+    }
+}
+
+void PasswordAudit::report(const AuditedEntry& audited, double entropy)
+{
+    Score score;
+    score.hash = audited.hash;
+    score.entropy = entropy;
+    m_cache.insert(audited.uuid, score);
+
+    if (!audited.entry) {
+        return;
+    }
+
+    Result result;
+    result.entry = audited.entry;
+    result.entropy = entropy;
+    result.reuseCount = m_buckets.value(audited.hash).size();
+    result.flags = audited.flags;
+    if (quality(entropy) <= Weak) {
+        result.flags |= WeakPassword;
+    }
+    if (result.reuseCount > 1) {
+        result.flags |= ReusedPassword;
+    }
+    emit resultReady(result);
+}
+
+PasswordAudit::Score PasswordAudit::estimate(const Password& password)
+{
+    Score score;
+    score.hash = password.hash;
+    score.entropy = ZxcvbnMatch(password.password.constData(), nullptr, nullptr);
+    return score;
+}
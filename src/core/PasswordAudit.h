@@ -0,0 +1,133 @@
+/*
+ *  Copyright (C) 2017 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSX_PASSWORDAUDIT_H
+#define KEEPASSX_PASSWORDAUDIT_H
+
+#include <QByteArray>
+#include <QFutureWatcher>
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QPointer>
+
+#include "core/Uuid.h"
+
+class Database;
+class Entry;
+
+/**
+ * Checks the passwords of all entries of a database: their zxcvbn entropy,
+ * whether other entries use the same password and whether the entry has
+ * expired or has not been changed for a long time.
+ *
+ * Passwords are estimated on the global thread pool and results are reported
+ * one entry at a time as they become available. Each distinct password is
+ * estimated once per audit, and the entropy of an entry is cached until its
+ * password changes, so auditing again only estimates modified entries.
+ * Passwords are compared by their HMAC under a key that is generated for each
+ * audit object, so the cache holds no unsalted password hashes.
+ */
+class PasswordAudit : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Quality
+    {
+        Poor,
+        Weak,
+        Good,
+        Excellent
+    };
+
+    enum Flag
+    {
+        NoFlags = 0,
+        WeakPassword = 0x1,
+        ReusedPassword = 0x2,
+        ExpiredEntry = 0x4,
+        StaleEntry = 0x8
+    };
+    Q_DECLARE_FLAGS(Flags, Flag)
+
+    struct Result
+    {
+        QPointer<Entry> entry;
+        double entropy;
+        int reuseCount;
+        Flags flags;
+    };
+
+    explicit PasswordAudit(QObject* parent = nullptr);
+    ~PasswordAudit() override;
+
+    void start(Database* db);
+    void cancel();
+    bool isRunning() const;
+    int entryCount() const;
+
+    int staleDays() const;
+    void setStaleDays(int days);
+    void clearCache();
+
+    static Quality quality(double entropy);
+
+signals:
+    void resultReady(const PasswordAudit::Result& result);
+    void finished();
+
+private slots:
+    void scoreReady(int index);
+    void scoresFinished();
+
+private:
+    struct Password
+    {
+        QByteArray hash;
+        QByteArray password;
+    };
+
+    struct Score
+    {
+        QByteArray hash;
+        double entropy;
+    };
+
+    struct AuditedEntry
+    {
+        QPointer<Entry> entry;
+        Uuid uuid;
+        QByteArray hash;
+        Flags flags;
+    };
+
+    void report(const AuditedEntry& audited, double entropy);
+    static Score estimate(const Password& password);
+
+    QFutureWatcher<Score>* m_watcher;
+    const QByteArray m_hashKey;
+    int m_staleDays;
+    QList<AuditedEntry> m_entries;
+    QHash<QByteArray, QList<int>> m_buckets;
+    QHash<Uuid, Score> m_cache;
+};
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(PasswordAudit::Flags)
+Q_DECLARE_METATYPE(PasswordAudit::Result)
+
+#endif // KEEPASSX_PASSWORDAUDIT_H
@@ -30,7 +30,7 @@ PasswordGenerator::PasswordGenerator()
 
 double PasswordGenerator::calculateEntropy(QString password)
 {
-    return ZxcvbnMatch(password.toLatin1(), 0, 0);
+    return ZxcvbnMatch(password.toUtf8(), 0, 0);
 }
 
 void PasswordGenerator::setLength(int length)
@@ -0,0 +1,103 @@
+/*
+ *  Copyright (C) 2017 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PasswordStrengthTask.h"
+
+#include <QtConcurrent>
+#include <zxcvbn.h>
+
+PasswordStrengthTask::PasswordStrengthTask(QObject* parent)
+    : QObject(parent)
+    , m_watcher(new QFutureWatcher<double>(this))
+    , m_state(ZxcvbnNewState())
+    , m_hasPending(false)
+{
+    connect(m_watcher, SIGNAL(finished()), SLOT(estimateFinished()));
+}
+
+PasswordStrengthTask::~PasswordStrengthTask()
+{
+    // the worker uses the state until it returns
+    cancel();
+    m_watcher->waitForFinished();
+    ZxcvbnFreeState(m_state);
+}
+
+/**
+ * Estimate the entropy of the given password. The result is reported by
+ * finished() unless another estimate is started or cancel() is called first.
+ */
+void PasswordStrengthTask::start(const QString& password)
+{
+    m_pending = password.toUtf8();
+    m_hasPending = true;
+
+    if (isRunning()) {
+        // continued by estimateFinished() once the worker gave up
+        m_cancelled.store(1);
+    } else {
+        startPending();
+    }
+}
+
+void PasswordStrengthTask::cancel()
+{
+    m_pending.clear();
+    m_hasPending = false;
+    if (isRunning()) {
+        m_cancelled.store(1);
+    }
+}
+
+bool PasswordStrengthTask::isRunning() const
+{
+    return m_watcher->isRunning();
+}
+
+void PasswordStrengthTask::estimateFinished()
+{
+    const bool cancelled = m_cancelled.load() != 0;
+    if (m_hasPending) {
+        startPending();
+        return;
+    }
+
+    const double entropy = m_watcher->result();
+    if (!cancelled && entropy >= 0.0) {
+        emit finished(entropy);
+    }
+}
+
+void PasswordStrengthTask::startPending()
+{
+    const QByteArray password = m_pending;
+    m_pending.clear();
+    m_hasPending = false;
+    m_cancelled.store(0);
+
+    m_watcher->setFuture(QtConcurrent::run(&PasswordStrengthTask::estimate, m_state, password, &m_cancelled));
+}
+
+double PasswordStrengthTask::estimate(ZxcState_t* state, const QByteArray& password, QAtomicInt* cancelled)
+{
+    return ZxcvbnMatchState(password.constData(), nullptr, nullptr, state, &PasswordStrengthTask::isCancelled, cancelled);
+}
+
+int PasswordStrengthTask::isCancelled(void* cancelled)
+{
+    return static_cast<QAtomicInt*>(cancelled)->load();
+}
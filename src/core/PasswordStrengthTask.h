@@ -0,0 +1,66 @@
+/*
+ *  Copyright (C) 2017 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSX_PASSWORDSTRENGTHTASK_H
+#define KEEPASSX_PASSWORDSTRENGTHTASK_H
+
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QFutureWatcher>
+#include <QObject>
+
+typedef struct ZxcState ZxcState_t;
+
+/**
+ * Estimates the entropy of a password on a worker thread while it is being
+ * typed, so that the GUI stays responsive.
+ *
+ * Starting a new estimate cancels the running one. The matches found in the
+ * previous password are reused for the parts the new one has in common with
+ * it; the result is the same as from a full evaluation.
+ */
+class PasswordStrengthTask : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit PasswordStrengthTask(QObject* parent = nullptr);
+    ~PasswordStrengthTask() override;
+
+    void start(const QString& password);
+    void cancel();
+    bool isRunning() const;
+
+signals:
+    void finished(double entropy);
+
+private slots:
+    void estimateFinished();
+
+private:
+    void startPending();
+    static double estimate(ZxcState_t* state, const QByteArray& password, QAtomicInt* cancelled);
+    static int isCancelled(void* cancelled);
+
+    QFutureWatcher<double>* m_watcher;
+    ZxcState_t* m_state;
+    QAtomicInt m_cancelled;
+    QByteArray m_pending;
+    bool m_hasPending;
+};
+
+#endif // KEEPASSX_PASSWORDSTRENGTHTASK_H
@@ -0,0 +1,211 @@
+/*
+ *  Copyright (C) 2017 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PublicSuffixList.h"
+
+#include <QFile>
+#include <QHostAddress>
+#include <QRegExp>
+#include <QTextStream>
+#include <QUrl>
+
+#include "core/FilePath.h"
+
+PublicSuffixList* PublicSuffixList::m_instance(nullptr);
+
+/**
+ * Compile the rules of a list in the publicsuffix.org format. A missing file
+ * leaves the list empty, every host then only has its top-level domain as
+ * public suffix.
+ */
+PublicSuffixList::PublicSuffixList(const QString& fileName)
+{
+    m_nodes.append(Node());
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return;
+    }
+
+    QTextStream stream(&file);
+    stream.setCodec("UTF-8");
+    while (!stream.atEnd()) {
+        const QString line = stream.readLine().trimmed();
+        if (line.isEmpty() || line.startsWith("//")) {
+            continue;
+        }
+        // a rule ends at the first white space
+        addRule(line.section(QRegExp("\\s"), 0, 0));
+    }
+}
+
+bool PublicSuffixList::isEmpty() const
+{
+    return m_edges.isEmpty();
+}
+
+/**
+ * The public suffix of a host name, e.g. "co.uk" for "www.example.co.uk".
+ */
+QString PublicSuffixList::publicSuffix(const QString& host) const
+{
+    const QStringList labels = splitHost(host);
+    if (labels.isEmpty()) {
+        return QString();
+    }
+    return QStringList(labels.mid(labels.size() - suffixLabels(labels))).join('.');
+}
+
+/**
+ * The public suffix plus one label, e.g. "example.co.uk" for
+ * "www.example.co.uk". Empty if the host is a public suffix itself.
+ */
+QString PublicSuffixList::registrableDomain(const QString& host) const
+{
+    const QStringList labels = splitHost(host);
+    const int length = suffixLabels(labels) + 1;
+    if (labels.size() < length) {
+        return QString();
+    }
+    return QStringList(labels.mid(labels.size() - length)).join('.');
+}
+
+/**
+ * The host name followed by its parent domains down to the registrable
+ * domain, most specific first: "a.b.example.co.uk", "b.example.co.uk",
+ * "example.co.uk". IP addresses and public suffixes only yield themselves.
+ */
+QStringList PublicSuffixList::hostLevels(const QString& host) const
+{
+    const QStringList labels = splitHost(host);
+    if (labels.isEmpty()) {
+        return QStringList();
+    }
+
+    // the levels keep the spelling of the host (lower case, as in the entry
+    // host index) rather than its ACE form used for the lookup
+    QString name = host.trimmed().toLower();
+    if (name.endsWith('.')) {
+        name.chop(1);
+    }
+    if (!QHostAddress(name).isNull()) {
+        return QStringList(name);
+    }
+
+    const int lastLevel = labels.size() - suffixLabels(labels) - 1;
+    QStringList levels(name);
+    int pos = 0;
+    for (int i = 0; i < lastLevel; ++i) {
+        pos = name.indexOf('.', pos) + 1;
+        levels.append(name.mid(pos));
+    }
+    return levels;
+}
+
+PublicSuffixList* PublicSuffixList::instance()
+{
+    if (!m_instance) {
+        m_instance = new PublicSuffixList(filePath()->dataPath("publicsuffix/public_suffix_list.dat"));
+    }
+
+    return m_instance;
+}
+
+void PublicSuffixList::addRule(const QString& rule)
+{
+    bool exception = rule.startsWith('!');
+    const QStringList labels = splitHost(exception ? rule.mid(1) : rule);
+    if (labels.isEmpty()) {
+        return;
+    }
+
+    int node = 0;
+    for (int i = labels.size() - 1; i >= 0; --i) {
+        const QPair<int, QString> edge(node, labels.at(i));
+        int next = m_edges.value(edge, -1);
+        if (next < 0) {
+            next = m_nodes.size();
+            m_nodes.append(Node());
+            m_edges.insert(edge, next);
+        }
+        node = next;
+    }
+
+    if (exception) {
+        m_nodes[node].isException = true;
+    } else {
+        m_nodes[node].isRule = true;
+    }
+}
+
+int PublicSuffixList::child(int node, const QString& label) const
+{
+    return m_edges.value(qMakePair(node, label), -1);
+}
+
+/**
+ * Number of trailing labels that form the public suffix, following the
+ * publicsuffix.org algorithm: the longest matching rule wins, exceptions
+ * beat wildcards and unlisted top-level domains are suffixes on their own.
+ * Rules below a wildcard label are not supported, the list has none.
+ */
+int PublicSuffixList::suffixLabels(const QStringList& labels) const
+{
+    int suffix = 1;
+    int node = 0;
+    for (int i = 0; i < labels.size(); ++i) {
+        const QString& label = labels.at(labels.size() - 1 - i);
+        const int next = child(node, label);
+        if (next >= 0 && m_nodes.at(next).isException) {
+            return i;
+        }
+        if (child(node, "*") >= 0) {
+            suffix = i + 1;
+        }
+        if (next < 0) {
+            break;
+        }
+        if (m_nodes.at(next).isRule) {
+            suffix = i + 1;
+        }
+        node = next;
+    }
+    return qMin(suffix, labels.size());
+}
+
+QStringList PublicSuffixList::splitHost(const QString& host)
+{
+    QString name = host.trimmed().toLower();
+    if (name.endsWith('.')) {
+        name.chop(1);
+    }
+
+    QStringList labels = name.split('.');
+    for (QString& label : labels) {
+        if (label.isEmpty()) {
+            return QStringList();
+        }
+        if (label != "*") {
+            const QByteArray ace = QUrl::toAce(label);
+            if (ace.isEmpty()) {
+                return QStringList();
+            }
+            label = QString::fromLatin1(ace);
+        }
+    }
+    return labels;
+}
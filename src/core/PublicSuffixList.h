@@ -0,0 +1,72 @@
+/*
+ *  Copyright (C) 2017 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSX_PUBLICSUFFIXLIST_H
+#define KEEPASSX_PUBLICSUFFIXLIST_H
+
+#include <QHash>
+#include <QPair>
+#include <QStringList>
+#include <QVector>
+
+/**
+ * Public suffix list (https://publicsuffix.org) compiled into a trie of
+ * reversed host name labels.
+ *
+ * Used to tell registrable domains (example.co.uk) from public suffixes
+ * (co.uk), so matching never falls back to a domain that anyone can
+ * register names under. Host names are compared in their ACE form.
+ */
+class PublicSuffixList
+{
+public:
+    explicit PublicSuffixList(const QString& fileName);
+
+    bool isEmpty() const;
+    QString publicSuffix(const QString& host) const;
+    QString registrableDomain(const QString& host) const;
+    QStringList hostLevels(const QString& host) const;
+
+    static PublicSuffixList* instance();
+
+private:
+    struct Node
+    {
+        Node() : isRule(false), isException(false) {}
+
+        bool isRule;
+        bool isException;
+    };
+
+    void addRule(const QString& rule);
+    int child(int node, const QString& label) const;
+    int suffixLabels(const QStringList& labels) const;
+    static QStringList splitHost(const QString& host);
+
+    static PublicSuffixList* m_instance;
+
+    QVector<Node> m_nodes;
+    QHash<QPair<int, QString>, int> m_edges;
+
+    Q_DISABLE_COPY(PublicSuffixList)
+};
+
+inline PublicSuffixList* publicSuffixList() {
+    return PublicSuffixList::instance();
+}
+
+#endif // KEEPASSX_PUBLICSUFFIXLIST_H
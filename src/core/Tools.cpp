@@ -162,6 +162,18 @@ bool isBase64(const QByteArray& ba)
     return regexp.exactMatch(base64);
 }
 
+/**
+ * Overwrite memory with zeros in a way the compiler can't optimize away,
+ * even if the memory is never read again.
+ */
+void wipeBuffer(void* data, int len)
+{
+    volatile char* p = static_cast<volatile char*>(data);
+    while (len-- > 0) {
+        *p++ = 0;
+    }
+}
+
 void sleep(int ms)
 {
     Q_ASSERT(ms >= 0);
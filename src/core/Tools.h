@@ -38,6 +38,7 @@ bool readAllFromDevice(QIODevice* device, QByteArray& data);
 QString imageReaderFilter();
 bool isHex(const QByteArray& ba);
 bool isBase64(const QByteArray& ba);
+void wipeBuffer(void* data, int len);
 void sleep(int ms);
 void wait(int ms);
 void disableCoreDumps();
@@ -17,6 +17,9 @@
 
 #include "CryptoHash.h"
 
+#include <QHash>
+#include <QThreadStorage>
+
 #include <gcrypt.h>
 
 #include "crypto/Crypto.h"
@@ -28,6 +31,26 @@ public:
     int hashLen;
 };
 
+namespace
+{
+    /**
+     * Hash contexts owned by a single thread. They are reused by the static
+     * one-shot helpers so that hashing many small buffers (e.g. one per
+     * stream block) does not open and close a gcrypt context every time.
+     */
+    struct ThreadHashContexts
+    {
+        ~ThreadHashContexts()
+        {
+            qDeleteAll(contexts);
+        }
+
+        QHash<int, CryptoHash*> contexts;
+    };
+
+    QThreadStorage<ThreadHashContexts*> threadHashContexts;
+}
+
 CryptoHash::CryptoHash(Algorithm algo, bool hmac)
     : d_ptr(new CryptoHashPrivate())
 {
@@ -113,19 +136,76 @@ QByteArray CryptoHash::result() const
     return QByteArray(result, d->hashLen);
 }
 
+CryptoHash& CryptoHash::threadContext(Algorithm algo, bool hmac)
+{
+    if (!threadHashContexts.hasLocalData()) {
+        threadHashContexts.setLocalData(new ThreadHashContexts());
+    }
+
+    QHash<int, CryptoHash*>& contexts = threadHashContexts.localData()->contexts;
+    const int key = (static_cast<int>(algo) << 1) | (hmac ? 1 : 0);
+    CryptoHash* cryptoHash = contexts.value(key, nullptr);
+    if (!cryptoHash) {
+        cryptoHash = new CryptoHash(algo, hmac);
+        contexts.insert(key, cryptoHash);
+    }
+
+    return *cryptoHash;
+}
+
 QByteArray CryptoHash::hash(const QByteArray& data, Algorithm algo)
 {
-    // replace with gcry_md_hash_buffer()?
-    CryptoHash cryptoHash(algo);
+    CryptoHash& cryptoHash = threadContext(algo, false);
     cryptoHash.addData(data);
-    return cryptoHash.result();
+    QByteArray result = cryptoHash.result();
+    cryptoHash.reset();
+    return result;
 }
 
 QByteArray CryptoHash::hmac(const QByteArray& data, const QByteArray& key, Algorithm algo)
 {
-    // replace with gcry_md_hash_buffer()?
-    CryptoHash cryptoHash(algo, true);
+    CryptoHash& cryptoHash = threadContext(algo, true);
     cryptoHash.setKey(key);
     cryptoHash.addData(data);
-    return cryptoHash.result();
+    QByteArray result = cryptoHash.result();
+    // drop the key material from the cached context
+    cryptoHash.setKey(QByteArray());
+    return result;
+}
+
+/**
+ * Hash the concatenation of the given parts. The parts are fed to the
+ * context one by one, so no joined copy of them is left on the heap.
+ */
+QByteArray CryptoHash::hash(const QList<QByteArray>& parts, Algorithm algo)
+{
+    CryptoHash& cryptoHash = threadContext(algo, false);
+    for (const QByteArray& part : parts) {
+        cryptoHash.addData(part);
+    }
+    QByteArray result = cryptoHash.result();
+    cryptoHash.reset();
+    return result;
+}
+
+/**
+ * Hash a batch of independent buffers with a single context.
+ *
+ * @param buffers data to hash, each buffer yields its own digest
+ * @param algo hash algorithm
+ * @return digests in the same order as the input buffers
+ */
+QList<QByteArray> CryptoHash::hashMultiple(const QList<QByteArray>& buffers, Algorithm algo)
+{
+    QList<QByteArray> results;
+    results.reserve(buffers.size());
+
+    CryptoHash& cryptoHash = threadContext(algo, false);
+    for (const QByteArray& buffer : buffers) {
+        cryptoHash.addData(buffer);
+        results.append(cryptoHash.result());
+        cryptoHash.reset();
+    }
+
+    return results;
 }
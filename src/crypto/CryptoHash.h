@@ -19,6 +19,7 @@
 #define KEEPASSX_CRYPTOHASH_H
 
 #include <QByteArray>
+#include <QList>
 
 class CryptoHashPrivate;
 
@@ -40,11 +41,16 @@ public:
 
     static QByteArray hash(const QByteArray& data, Algorithm algo);
     static QByteArray hmac(const QByteArray& data, const QByteArray& key, Algorithm algo);
+    static QByteArray hash(const QList<QByteArray>& parts, Algorithm algo);
+    static QList<QByteArray> hashMultiple(const QList<QByteArray>& buffers, Algorithm algo);
 
 private:
+    static CryptoHash& threadContext(Algorithm algo, bool hmac);
+
     CryptoHashPrivate* const d_ptr;
 
     Q_DECLARE_PRIVATE(CryptoHash)
+    Q_DISABLE_COPY(CryptoHash)
 };
 
 #endif // KEEPASSX_CRYPTOHASH_H
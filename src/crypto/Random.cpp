@@ -18,14 +18,34 @@
 #include "Random.h"
 
 #include <gcrypt.h>
+#include <cstring>
 
 #include "core/Global.h"
+#include "core/Tools.h"
 #include "crypto/Crypto.h"
 
-class RandomBackendGcrypt : public RandomBackend
+class RandomBackendGcrypt::Generator
 {
 public:
-    void randomize(void* data, int len) override;
+    Generator();
+    ~Generator();
+    bool read(quint8* data, int len);
+
+private:
+    bool refill();
+    bool setKey(const quint8* key);
+
+    // ChaCha20 keystream produced per key
+    static const int BufferSize = 1024;
+    static const int KeySize = 32;
+    static const int NonceSize = 12;
+    static const int ReseedInterval = 1024 * 1024;
+
+    gcry_cipher_hd_t m_cipher;
+    // in gcrypt's secure memory, so the keystream is never swapped out
+    quint8* m_buffer;
+    int m_pos;
+    int m_untilReseed;
 };
 
 Random* Random::m_instance(nullptr);
@@ -94,5 +114,98 @@ void RandomBackendGcrypt::randomize(void* data, int len)
 {
     Q_ASSERT(Crypto::initalized());
 
-    gcry_randomize(data, len, GCRY_STRONG_RANDOM);
+    if (!m_generators.hasLocalData()) {
+        m_generators.setLocalData(new Generator());
+    }
+
+    if (!m_generators.localData()->read(static_cast<quint8*>(data), len)) {
+        gcry_randomize(data, len, GCRY_STRONG_RANDOM);
+    }
+}
+
+RandomBackendGcrypt::Generator::Generator()
+    : m_cipher(nullptr)
+    , m_buffer(static_cast<quint8*>(gcry_malloc_secure(BufferSize)))
+    , m_pos(BufferSize)
+    , m_untilReseed(0)
+{
+    // without a buffer refill() fails and every read falls back to gcry_randomize()
+    if (m_buffer && gcry_cipher_open(&m_cipher, GCRY_CIPHER_CHACHA20, GCRY_CIPHER_MODE_STREAM,
+                                     GCRY_CIPHER_SECURE) != 0) {
+        m_cipher = nullptr;
+    }
+}
+
+RandomBackendGcrypt::Generator::~Generator()
+{
+    if (m_cipher) {
+        gcry_cipher_close(m_cipher);
+    }
+    if (m_buffer) {
+        Tools::wipeBuffer(m_buffer, BufferSize);
+        gcry_free(m_buffer);
+    }
+}
+
+/**
+ * Fill data with len bytes of keystream. Returns false if gcrypt failed, in
+ * which case the caller has to fall back to gcry_randomize().
+ */
+bool RandomBackendGcrypt::Generator::read(quint8* data, int len)
+{
+    while (len > 0) {
+        if (m_pos == BufferSize && !refill()) {
+            return false;
+        }
+
+        const int count = qMin(len, BufferSize - m_pos);
+        std::memcpy(data, m_buffer + m_pos, count);
+        Tools::wipeBuffer(m_buffer + m_pos, count);
+        m_pos += count;
+        data += count;
+        len -= count;
+    }
+    return true;
+}
+
+bool RandomBackendGcrypt::Generator::refill()
+{
+    if (!m_cipher) {
+        return false;
+    }
+
+    if (m_untilReseed <= 0) {
+        quint8 seed[KeySize];
+        gcry_randomize(seed, KeySize, GCRY_STRONG_RANDOM);
+        const bool keyed = setKey(seed);
+        Tools::wipeBuffer(seed, KeySize);
+        if (!keyed) {
+            return false;
+        }
+        m_untilReseed = ReseedInterval;
+    }
+
+    std::memset(m_buffer, 0, BufferSize);
+    if (gcry_cipher_encrypt(m_cipher, m_buffer, BufferSize, nullptr, 0) != 0) {
+        m_untilReseed = 0;
+        return false;
+    }
+
+    // the start of the keystream becomes the next key and is never handed out
+    if (!setKey(m_buffer)) {
+        m_untilReseed = 0;
+        return false;
+    }
+    Tools::wipeBuffer(m_buffer, KeySize);
+    m_pos = KeySize;
+    m_untilReseed -= BufferSize;
+    return true;
+}
+
+bool RandomBackendGcrypt::Generator::setKey(const quint8* key)
+{
+    // every key only produces a single buffer, so the nonce can stay fixed
+    static const quint8 nonce[NonceSize] = {};
+
+    return gcry_cipher_setkey(m_cipher, key, KeySize) == 0 && gcry_cipher_setiv(m_cipher, nonce, NonceSize) == 0;
 }
@@ -20,6 +20,7 @@
 
 #include <QByteArray>
 #include <QScopedPointer>
+#include <QThreadStorage>
 
 class RandomBackend
 {
@@ -28,6 +29,24 @@ public:
     virtual ~RandomBackend() {}
 };
 
+/**
+ * Default backend. Every thread gets its own ChaCha20 keystream generator,
+ * keyed from the gcrypt random pool, so small requests need neither a call
+ * into gcrypt nor a lock. Each buffer of output rekeys the generator and
+ * served bytes are erased, so earlier output can't be recovered. The key is
+ * replaced with fresh gcrypt randomness after every megabyte.
+ */
+class RandomBackendGcrypt : public RandomBackend
+{
+public:
+    void randomize(void* data, int len) override;
+
+private:
+    class Generator;
+
+    QThreadStorage<Generator*> m_generators;
+};
+
 class Random
 {
 public:
@@ -343,7 +343,7 @@ void KdbxXmlReader::parseIcon()
     Q_ASSERT(m_xml.isStartElement() && m_xml.name() == "Icon");
 
     Uuid uuid;
-    QImage icon;
+    QByteArray iconData;
     bool uuidSet = false;
     bool iconSet = false;
 
@@ -352,7 +352,8 @@ void KdbxXmlReader::parseIcon()
             uuid = readUuid();
             uuidSet = !uuid.isNull();
         } else if (m_xml.name() == "Data") {
-            icon.loadFromData(readBinary());
+            // decoding is deferred until the icon is displayed
+            iconData = readBinary();
             iconSet = true;
         } else {
             skipCurrentElement();
@@ -360,7 +361,7 @@ void KdbxXmlReader::parseIcon()
     }
 
     if (uuidSet && iconSet) {
-        m_meta->addCustomIcon(uuid, icon);
+        m_meta->addCustomIcon(uuid, iconData);
         return;
     }
 
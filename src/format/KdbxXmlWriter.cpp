@@ -153,25 +153,19 @@ void KdbxXmlWriter::writeCustomIcons()
 
     const QList<Uuid> customIconsOrder = m_meta->customIconsOrder();
     for (const Uuid& uuid : customIconsOrder) {
-        writeIcon(uuid, m_meta->customIcon(uuid));
+        writeIcon(uuid, m_meta->customIconData(uuid));
     }
 
     m_xml.writeEndElement();
 }
 
-void KdbxXmlWriter::writeIcon(const Uuid& uuid, const QImage& icon)
+void KdbxXmlWriter::writeIcon(const Uuid& uuid, const QByteArray& iconData)
 {
     m_xml.writeStartElement("Icon");
 
     writeUuid("UUID", uuid);
-
-    QByteArray ba;
-    QBuffer buffer(&ba);
-    buffer.open(QIODevice::WriteOnly);
-    // TODO: check !icon.save()
-    icon.save(&buffer, "PNG");
-    buffer.close();
-    writeBinary("Data", ba);
+    // icons are stored encoded, no need to decode and re-encode them
+    writeBinary("Data", iconData);
 
     m_xml.writeEndElement();
 }
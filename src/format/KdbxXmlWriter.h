@@ -49,7 +49,7 @@ private:
     void writeMetadata();
     void writeMemoryProtection();
     void writeCustomIcons();
-    void writeIcon(const Uuid& uuid, const QImage& icon);
+    void writeIcon(const Uuid& uuid, const QByteArray& iconData);
     void writeBinaries();
     void writeCustomData();
     void writeCustomDataItem(const QString& key, const QString& value);
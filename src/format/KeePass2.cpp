@@ -57,11 +57,8 @@ const QList<QPair<Uuid, QString>> KeePass2::KDFS{
 };
 
 QByteArray KeePass2::hmacKey(QByteArray masterSeed, QByteArray transformedMasterKey) {
-    CryptoHash hmacKeyHash(CryptoHash::Sha512);
-    hmacKeyHash.addData(masterSeed);
-    hmacKeyHash.addData(transformedMasterKey);
-    hmacKeyHash.addData(QByteArray(1, '\x01'));
-    return hmacKeyHash.result();
+    return CryptoHash::hash(QList<QByteArray>() << masterSeed << transformedMasterKey << QByteArray(1, '\x01'),
+                            CryptoHash::Sha512);
 }
 
 /**
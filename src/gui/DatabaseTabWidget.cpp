@@ -449,6 +449,11 @@ void DatabaseTabWidget::changeDatabaseSettings()
     currentDatabaseWidget()->switchToDatabaseSettings();
 }
 
+void DatabaseTabWidget::auditPasswords()
+{
+    currentDatabaseWidget()->auditPasswords();
+}
+
 bool DatabaseTabWidget::readOnly(int index)
 {
     if (index == -1) {
@@ -73,6 +73,7 @@ public slots:
     bool closeAllDatabases();
     void changeMasterKey();
     void changeDatabaseSettings();
+    void auditPasswords();
     bool readOnly(int index = -1);
     bool canSave(int index = -1);
     bool isModified(int index = -1);
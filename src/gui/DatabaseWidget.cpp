@@ -34,7 +34,7 @@
 
 #include "autotype/AutoType.h"
 #include "core/Config.h"
-#include "core/EntrySearcher.h"
+#include "core/EntrySearchTask.h"
 #include "core/FilePath.h"
 #include "core/Group.h"
 #include "core/Metadata.h"
@@ -43,6 +43,7 @@
 #include "gui/ChangeMasterKeyWidget.h"
 #include "gui/Clipboard.h"
 #include "gui/CloneDialog.h"
+#include "gui/PasswordAuditDialog.h"
 #include "gui/SetupTotpDialog.h"
 #include "gui/TotpDialog.h"
 #include "gui/DatabaseOpenWidget.h"
@@ -216,13 +217,18 @@ DatabaseWidget::DatabaseWidget(Database* db, QWidget* parent)
     m_fileWatchUnblockTimer.setSingleShot(true);
     m_ignoreAutoReload = false;
 
+    m_searchTask = new EntrySearchTask(this);
     m_searchCaseSensitive = false;
     m_searchLimitGroup = config()->get("SearchLimitGroup", false).toBool();
+    connect(m_searchTask, SIGNAL(resultsReady(QList<Entry*>,bool)), SLOT(searchResultsReady(QList<Entry*>,bool)));
+    connect(m_searchTask, SIGNAL(finished(int)), SLOT(searchFinished(int)));
+    // results of previous searches can't be refined once the database changed
+    connect(m_db, SIGNAL(modifiedImmediate()), m_searchTask, SLOT(invalidate()));
 
 #ifdef WITH_XC_SSHAGENT
     if (config()->get("SSHAgent", false).toBool()) {
         connect(this, SIGNAL(currentModeChanged(DatabaseWidget::Mode)), SSHAgent::instance(), SLOT(databaseModeChanged(DatabaseWidget::Mode)));
-        connect(this, SIGNAL(closeRequest()), SSHAgent::instance(), SLOT(databaseModeChanged()));
+        connect(this, SIGNAL(closeRequest()), SSHAgent::instance(), SLOT(databaseCloseRequested()));
     }
 #endif
 
@@ -374,6 +380,8 @@ void DatabaseWidget::replaceDatabase(Database* db)
     Database* oldDb = m_db;
     m_db = db;
     m_groupView->changeDatabase(m_db);
+    m_searchTask->clear();
+    connect(m_db, SIGNAL(modifiedImmediate()), m_searchTask, SLOT(invalidate()));
     emit databaseChanged(m_db, m_databaseModified);
     delete oldDb;
 }
@@ -954,6 +962,13 @@ void DatabaseWidget::switchToDatabaseSettings()
     setCurrentWidget(m_databaseSettingsWidget);
 }
 
+void DatabaseWidget::auditPasswords()
+{
+    auto auditDialog = new PasswordAuditDialog(this, m_db);
+    connect(auditDialog, SIGNAL(entryActivated(Entry*)), SLOT(switchToEntryEdit(Entry*)));
+    auditDialog->show();
+}
+
 void DatabaseWidget::switchToOpenDatabase(const QString& filePath)
 {
     updateFilePath(filePath);
@@ -1022,6 +1037,7 @@ void DatabaseWidget::databaseSaved()
 
 void DatabaseWidget::refreshSearch() {
     if (isInSearchMode()) {
+        m_searchTask->clear();
         search(m_lastSearchText);
     }
 }
@@ -1040,22 +1056,36 @@ void DatabaseWidget::search(const QString& searchtext)
 
     Group* searchGroup = m_searchLimitGroup ? currentGroup() : m_db->rootGroup();
 
-    QList<Entry*> searchResult = EntrySearcher().search(searchtext, searchGroup, caseSensitive);
-
-    m_entryView->setEntryList(searchResult);
+    // Results are delivered in batches to searchResultsReady(),
+    // a newer search cancels the one still running
+    m_searchTask->start(searchtext, searchGroup, caseSensitive);
     m_lastSearchText = searchtext;
+}
+
+void DatabaseWidget::searchResultsReady(const QList<Entry*>& entries, bool firstBatch)
+{
+    if (firstBatch || !m_entryView->inEntryListMode()) {
+        m_entryView->setEntryList(entries);
+        m_searchingLabel->setText(tr("Searching..."));
+        m_searchingLabel->setVisible(true);
+        emit searchModeActivated();
+    }
+    else {
+        m_entryView->appendEntries(entries);
+    }
+}
 
+void DatabaseWidget::searchFinished(int resultCount)
+{
     // Display a label detailing our search results
-    if (searchResult.size() > 0) {
-        m_searchingLabel->setText(tr("Search Results (%1)").arg(searchResult.size()));
+    if (resultCount > 0) {
+        m_searchingLabel->setText(tr("Search Results (%1)").arg(resultCount));
     }
     else {
         m_searchingLabel->setText(tr("No Results"));
     }
 
     m_searchingLabel->setVisible(true);
-
-    emit searchModeActivated();
 }
 
 void DatabaseWidget::setSearchCaseSensitive(bool state)
@@ -1086,6 +1116,8 @@ QString DatabaseWidget::getCurrentSearch()
 
 void DatabaseWidget::endSearch()
 {
+    m_searchTask->cancel();
+
     if (isInSearchMode())
     {
         emit listModeAboutToActivate();
@@ -37,6 +37,7 @@ class Database;
 class EditEntryWidget;
 class EditGroupWidget;
 class Entry;
+class EntrySearchTask;
 class EntryView;
 class Group;
 class GroupView;
@@ -155,6 +156,7 @@ public slots:
     void switchToGroupEdit();
     void switchToMasterKeyChange(bool disableCancel = false);
     void switchToDatabaseSettings();
+    void auditPasswords();
     void switchToOpenDatabase(const QString& filePath);
     void switchToOpenDatabase(const QString& filePath, const QString& password, const QString& keyFile);
     void switchToImportCsv(const QString& filePath);
@@ -177,6 +179,8 @@ public slots:
     void hideMessage();
 
 private slots:
+    void searchResultsReady(const QList<Entry*>& entries, bool firstBatch);
+    void searchFinished(int resultCount);
     void entryActivationSignalReceived(Entry* entry, EntryModel::ModelColumn column);
     void switchBackToEntryEdit();
     void switchToHistoryView(Entry* entry);
@@ -232,6 +236,7 @@ private:
     DetailsWidget* m_detailsView;
 
     // Search state
+    EntrySearchTask* m_searchTask;
     QString m_lastSearchText;
     bool m_searchCaseSensitive;
     bool m_searchLimitGroup;
@@ -20,7 +20,6 @@
 #include "ui_DetailsWidget.h"
 
 #include <QDebug>
-#include <QTimer>
 #include <QDir>
 #include <QDesktopServices>
 #include <QTemporaryFile>
@@ -31,6 +30,7 @@
 #include "gui/Clipboard.h"
 #include "gui/DatabaseWidget.h"
 #include "entry/EntryAttachmentsModel.h"
+#include "totp/TotpService.h"
 
 DetailsWidget::DetailsWidget(QWidget* parent)
     : QWidget(parent)
@@ -38,7 +38,6 @@ DetailsWidget::DetailsWidget(QWidget* parent)
     , m_locked(false)
     , m_currentEntry(nullptr)
     , m_currentGroup(nullptr)
-    , m_timer(nullptr)
     , m_attributesTabWidget(nullptr)
     , m_attachmentsTabWidget(nullptr)
     , m_autotypeTabWidget(nullptr)
@@ -57,6 +56,7 @@ DetailsWidget::DetailsWidget(QWidget* parent)
     connect(m_ui->totpButton, SIGNAL(toggled(bool)), SLOT(showTotp(bool)));
     connect(m_ui->closeButton, SIGNAL(toggled(bool)), SLOT(hideDetails()));
     connect(m_ui->tabWidget, SIGNAL(tabBarClicked(int)), SLOT(updateTabIndex(int)));
+    connect(totpService(), SIGNAL(codesChanged()), SLOT(updateTotp()));
 
     m_ui->attachmentsWidget->setReadOnly(true);
     m_ui->attachmentsWidget->setButtonsVisible(false);
@@ -152,16 +152,8 @@ void DetailsWidget::getSelectedEntry(Entry* selectedEntry)
     }
 
     if (m_currentEntry->hasTotp()) {
-        m_step = m_currentEntry->totpStep();
-
-        if (nullptr != m_timer) {
-            m_timer->stop();
-        }
-        m_timer = new QTimer(this);
-        connect(m_timer, SIGNAL(timeout()), this, SLOT(updateTotp()));
-        updateTotp();
-        m_timer->start(m_step * 10);
         m_ui->totpButton->show();
+        updateTotp();
     }
 
     QString notes = m_currentEntry->notes();
@@ -283,13 +275,12 @@ void DetailsWidget::getSelectedGroup(Group* selectedGroup)
 
 void DetailsWidget::updateTotp()
 {
-    if (!m_locked) {
-        QString totpCode = m_currentEntry->totp();
+    // the button is only shown while the current entry has TOTP
+    if (!m_locked && m_currentEntry && !m_ui->totpButton->isHidden()) {
+        QString totpCode = totpService()->code(m_currentEntry);
         QString firstHalf = totpCode.left(totpCode.size() / 2);
         QString secondHalf = totpCode.mid(totpCode.size() / 2);
         m_ui->totpLabel->setText(firstHalf + " " + secondHalf);
-    } else if (nullptr != m_timer) {
-        m_timer->stop();
     }
 }
 
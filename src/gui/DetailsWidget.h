@@ -66,8 +66,6 @@ private:
     bool m_locked;
     Entry* m_currentEntry;
     Group* m_currentGroup;
-    quint8 m_step;
-    QTimer* m_timer;
     QWidget* m_attributesTabWidget;
     QWidget* m_attachmentsTabWidget;
     QWidget* m_autotypeTabWidget;
@@ -19,6 +19,7 @@
 #include "EditWidgetIcons.h"
 #include "ui_EditWidgetIcons.h"
 
+#include <QFile>
 #include <QFileDialog>
 #include <QMessageBox>
 #include <QFileDialog>
@@ -180,11 +181,11 @@ void EditWidgetIcons::fetchFavicon(const QUrl& url)
         response->onEnd([this, response, &url]() {
             int status = response->status();
             if (200 == status) {
-                QImage image;
-                image.loadFromData(response->collectedData());
+                QByteArray iconData = response->collectedData();
+                QImage image = QImage::fromData(iconData);
 
                 if (!image.isNull()) {
-                    addCustomIcon(image);
+                    addCustomIcon(iconData);
                     resetFaviconDownload();
                 } else {
                     fetchFaviconFromGoogle(url.host());
@@ -271,9 +272,13 @@ void EditWidgetIcons::addCustomIconFromFile()
         QString filename = QFileDialog::getOpenFileName(
                     this, tr("Select Image"), "", filter);
         if (!filename.isEmpty()) {
-            auto icon = QImage(filename);
-            if (!icon.isNull()) {
-                addCustomIcon(QImage(filename));
+            QFile file(filename);
+            QByteArray iconData;
+            if (file.open(QIODevice::ReadOnly)) {
+                iconData = file.readAll();
+            }
+            if (!QImage::fromData(iconData).isNull()) {
+                addCustomIcon(iconData);
             } else {
                 emit messageEditEntry(tr("Can't read icon"), MessageWidget::Error);
             }
@@ -281,17 +286,18 @@ void EditWidgetIcons::addCustomIconFromFile()
     }
 }
 
-void EditWidgetIcons::addCustomIcon(const QImage &icon)
+void EditWidgetIcons::addCustomIcon(const QByteArray& iconData)
 {
     if (m_database) {
-        Uuid uuid = m_database->metadata()->findCustomIcon(icon);
+        Uuid uuid = m_database->metadata()->findCustomIcon(iconData);
         if (uuid.isNull()) {
             uuid = Uuid::random();
-            // Don't add an icon larger than 128x128, but retain original size if smaller
+            QImage icon = QImage::fromData(iconData);
+            // Don't add an icon larger than 128x128, but retain original data if smaller
             if (icon.width() > 128 || icon.height() > 128) {
                 m_database->metadata()->addCustomIcon(uuid, icon.scaled(128, 128));
             } else {
-                m_database->metadata()->addCustomIcon(uuid, icon);
+                m_database->metadata()->addCustomIcon(uuid, iconData);
             }
 
             m_customIconModel->setIcons(m_database->metadata()->customIconsScaledPixmaps(),
@@ -79,7 +79,7 @@ private slots:
     void resetFaviconDownload(bool clearRedirect = true);
 #endif
     void addCustomIconFromFile();
-    void addCustomIcon(const QImage& icon);
+    void addCustomIcon(const QByteArray& iconData);
     void removeCustomIcon();
     void updateWidgetsDefaultIcons(bool checked);
     void updateWidgetsCustomIcons(bool checked);
@@ -0,0 +1,98 @@
+/*
+ *  Copyright (C) 2017 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PasswordAuditDialog.h"
+#include "ui_PasswordAuditDialog.h"
+
+#include <QHeaderView>
+#include <QPushButton>
+#include <QSortFilterProxyModel>
+
+#include "core/Database.h"
+#include "core/Entry.h"
+#include "core/PasswordAudit.h"
+#include "gui/entry/PasswordAuditModel.h"
+
+PasswordAuditDialog::PasswordAuditDialog(DatabaseWidget* parent, Database* db)
+    : QDialog(parent)
+    , m_ui(new Ui::PasswordAuditDialog())
+    , m_db(db)
+    , m_audit(new PasswordAudit(this))
+    , m_model(new PasswordAuditModel(m_audit, this))
+    , m_sortModel(new QSortFilterProxyModel(this))
+{
+    m_ui->setupUi(this);
+
+    setAttribute(Qt::WA_DeleteOnClose);
+
+    m_sortModel->setSourceModel(m_model);
+    m_sortModel->setSortRole(PasswordAuditModel::SortRole);
+    m_sortModel->setDynamicSortFilter(true);
+    m_ui->auditView->setModel(m_sortModel);
+    m_ui->auditView->sortByColumn(PasswordAuditModel::Entropy, Qt::AscendingOrder);
+    m_ui->auditView->horizontalHeader()->setSectionResizeMode(PasswordAuditModel::Title, QHeaderView::Stretch);
+
+    QPushButton* auditButton = m_ui->buttonBox->addButton(tr("Audit again"), QDialogButtonBox::ActionRole);
+
+    connect(auditButton, SIGNAL(clicked()), SLOT(startAudit()));
+    connect(m_ui->buttonBox, SIGNAL(rejected()), SLOT(close()));
+    connect(m_ui->auditView, SIGNAL(activated(QModelIndex)), SLOT(emitEntryActivated(QModelIndex)));
+    connect(m_audit, SIGNAL(resultReady(PasswordAudit::Result)), SLOT(updateStatus()));
+    connect(m_audit, SIGNAL(finished()), SLOT(updateStatus()));
+    connect(parent, SIGNAL(currentModeChanged(DatabaseWidget::Mode)), SLOT(modeChanged(DatabaseWidget::Mode)));
+
+    startAudit();
+}
+
+PasswordAuditDialog::~PasswordAuditDialog()
+{
+}
+
+void PasswordAuditDialog::startAudit()
+{
+    m_audit->cancel();
+    m_model->clear();
+    m_audit->start(m_db);
+    updateStatus();
+}
+
+void PasswordAuditDialog::updateStatus()
+{
+    if (m_audit->isRunning()) {
+        m_ui->statusLabel->setText(tr("Auditing passwords: %1 of %2 entries")
+                                   .arg(m_model->rowCount()).arg(m_audit->entryCount()));
+    } else {
+        m_ui->statusLabel->setText(tr("%n entries audited", "", m_model->rowCount()));
+    }
+}
+
+void PasswordAuditDialog::emitEntryActivated(const QModelIndex& index)
+{
+    Entry* entry = m_model->entryFromIndex(m_sortModel->mapToSource(index));
+    if (entry) {
+        emit entryActivated(entry);
+    }
+}
+
+void PasswordAuditDialog::modeChanged(DatabaseWidget::Mode mode)
+{
+    // the entries are gone once the database is locked
+    if (mode == DatabaseWidget::LockedMode) {
+        m_audit->cancel();
+        close();
+    }
+}
@@ -0,0 +1,65 @@
+/*
+ *  Copyright (C) 2017 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSX_PASSWORDAUDITDIALOG_H
+#define KEEPASSX_PASSWORDAUDITDIALOG_H
+
+#include <QDialog>
+#include <QScopedPointer>
+
+#include "gui/DatabaseWidget.h"
+
+namespace Ui {
+    class PasswordAuditDialog;
+}
+
+class Database;
+class Entry;
+class PasswordAudit;
+class PasswordAuditModel;
+class QSortFilterProxyModel;
+
+/**
+ * Audits the passwords of a database and lists the results as they arrive.
+ * Activating a row opens the entry for editing.
+ */
+class PasswordAuditDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit PasswordAuditDialog(DatabaseWidget* parent, Database* db);
+    ~PasswordAuditDialog();
+
+signals:
+    void entryActivated(Entry* entry);
+
+private slots:
+    void startAudit();
+    void updateStatus();
+    void emitEntryActivated(const QModelIndex& index);
+    void modeChanged(DatabaseWidget::Mode mode);
+
+private:
+    QScopedPointer<Ui::PasswordAuditDialog> m_ui;
+    Database* const m_db;
+    PasswordAudit* const m_audit;
+    PasswordAuditModel* const m_model;
+    QSortFilterProxyModel* const m_sortModel;
+};
+
+#endif // KEEPASSX_PASSWORDAUDITDIALOG_H
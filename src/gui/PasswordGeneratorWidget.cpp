@@ -25,6 +25,7 @@
 
 #include "core/Config.h"
 #include "core/PasswordGenerator.h"
+#include "core/PasswordStrengthTask.h"
 #include "core/FilePath.h"
 #include "gui/Clipboard.h"
 
@@ -34,6 +35,7 @@ PasswordGeneratorWidget::PasswordGeneratorWidget(QWidget* parent)
     , m_passwordGenerator(new PasswordGenerator())
     , m_dicewareGenerator(new PassphraseGenerator())
     , m_ui(new Ui::PasswordGeneratorWidget())
+    , m_strengthTask(new PasswordStrengthTask(this))
 {
     m_ui->setupUi(this);
 
@@ -41,6 +43,7 @@ PasswordGeneratorWidget::PasswordGeneratorWidget(QWidget* parent)
 
     connect(m_ui->editNewPassword, SIGNAL(textChanged(QString)), SLOT(updateButtonsEnabled(QString)));
     connect(m_ui->editNewPassword, SIGNAL(textChanged(QString)), SLOT(updatePasswordStrength(QString)));
+    connect(m_strengthTask, SIGNAL(finished(double)), SLOT(showPasswordStrength(double)));
     connect(m_ui->togglePasswordButton, SIGNAL(toggled(bool)), SLOT(togglePasswordShown(bool)));
     connect(m_ui->buttonApply, SIGNAL(clicked()), SLOT(applyPassword()));
     connect(m_ui->buttonCopy, SIGNAL(clicked()), SLOT(copyPassword()));
@@ -191,13 +194,17 @@ void PasswordGeneratorWidget::updateButtonsEnabled(const QString& password)
 
 void PasswordGeneratorWidget::updatePasswordStrength(const QString& password)
 {
-    double entropy = 0.0;
     if (m_ui->tabWidget->currentIndex() == Password) {
-        entropy = m_passwordGenerator->calculateEntropy(password);
+        // reported by showPasswordStrength() once the estimate is done
+        m_strengthTask->start(password);
     } else {
-        entropy = m_dicewareGenerator->calculateEntropy(password);
+        m_strengthTask->cancel();
+        showPasswordStrength(m_dicewareGenerator->calculateEntropy(password));
     }
+}
 
+void PasswordGeneratorWidget::showPasswordStrength(double entropy)
+{
     m_ui->entropyLabel->setText(tr("Entropy: %1 bit").arg(QString::number(entropy, 'f', 2)));
 
     if (entropy > m_ui->entropyProgressBar->maximum()) {
@@ -32,6 +32,7 @@ namespace Ui {
 
 class PasswordGenerator;
 class PassphraseGenerator;
+class PasswordStrengthTask;
 
 class PasswordGeneratorWidget : public QWidget
 {
@@ -61,6 +62,7 @@ private slots:
     void copyPassword();
     void updateButtonsEnabled(const QString& password);
     void updatePasswordStrength(const QString& password);
+    void showPasswordStrength(double entropy);
     void togglePasswordShown(bool hidden);
 
     void passwordSliderMoved();
@@ -81,6 +83,7 @@ private:
     const QScopedPointer<PasswordGenerator> m_passwordGenerator;
     const QScopedPointer<PassphraseGenerator> m_dicewareGenerator;
     const QScopedPointer<Ui::PasswordGeneratorWidget> m_ui;
+    PasswordStrengthTask* const m_strengthTask;
 
 protected:
     void keyPressEvent(QKeyEvent* e) override;
@@ -23,6 +23,7 @@
 #include "core/Entry.h"
 #include "gui/DatabaseWidget.h"
 #include "gui/Clipboard.h"
+#include "totp/TotpService.h"
 
 #include <QTimer>
 #include <QDateTime>
@@ -47,6 +48,7 @@ TotpDialog::TotpDialog(DatabaseWidget* parent, Entry* entry)
     connect(timer, SIGNAL(timeout()), this, SLOT(updateSeconds()));
     timer->start(m_step * 10);
 
+    connect(totpService(), SIGNAL(codesChanged()), SLOT(updateTotp()));
     updateTotp();
 
     setAttribute(Qt::WA_DeleteOnClose);
@@ -59,7 +61,7 @@ TotpDialog::TotpDialog(DatabaseWidget* parent, Entry* entry)
 
 void TotpDialog::copyToClipboard()
 {
-    clipboard()->setText(m_entry->totp());
+    clipboard()->setText(totpService()->code(m_entry));
     if (config()->get("MinimizeOnCopy").toBool()) {
         m_parent->window()->showMinimized();
     }
@@ -72,7 +74,6 @@ void TotpDialog::updateProgressBar()
         m_ui->progressBar->update();
         uCounter++;
     } else {
-        updateTotp();
         uCounter = resetCounter();
     }
 }
@@ -86,7 +87,7 @@ void TotpDialog::updateSeconds()
 
 void TotpDialog::updateTotp()
 {
-    QString totpCode = m_entry->totp();
+    QString totpCode = totpService()->code(m_entry);
     QString firstHalf = totpCode.left(totpCode.size() / 2);
     QString secondHalf = totpCode.mid(totpCode.size() / 2);
     m_ui->totpLabel->setText(firstHalf + " " + secondHalf);
@@ -21,24 +21,35 @@
 #include <QMimeData>
 #include <QPalette>
 
+#include <limits>
+
 #include "core/DatabaseIcons.h"
 #include "core/Entry.h"
 #include "core/Global.h"
 #include "core/Group.h"
 #include "core/Metadata.h"
 
+const int EntryModel::FetchBatchSize = 500;
+
 EntryModel::EntryModel(QObject* parent)
     : QAbstractTableModel(parent)
     , m_group(nullptr)
+    , m_loadedCount(0)
+    , m_insertPending(false)
+    , m_removePending(false)
 {
 }
 
 Entry* EntryModel::entryFromIndex(const QModelIndex& index) const
 {
-    Q_ASSERT(index.isValid() && index.row() < m_entries.size());
+    Q_ASSERT(index.isValid() && index.row() < m_loadedCount);
     return m_entries.at(index.row());
 }
 
+/**
+ * Returns an invalid index if the entry has not been fetched yet,
+ * see canFetchMore() and fetchMore().
+ */
 QModelIndex EntryModel::indexFromEntry(Entry* entry) const
 {
     int row = m_entries.indexOf(entry);
@@ -58,8 +69,11 @@ void EntryModel::setGroup(Group* group)
 
     m_group = group;
     m_allGroups.clear();
+    m_databases.clear();
     m_entries = group->entries();
     m_orgEntries.clear();
+    m_loadedCount = m_entries.size();
+    m_displayCache.clear();
 
     makeConnections(group);
 
@@ -75,33 +89,41 @@ void EntryModel::setEntryList(const QList<Entry*>& entries)
 
     m_group = nullptr;
     m_allGroups.clear();
+    m_databases.clear();
     m_entries = entries;
     m_orgEntries = entries;
+    // large lists are populated incrementally through fetchMore()
+    m_loadedCount = qMin(m_entries.size(), FetchBatchSize);
+    m_displayCache.clear();
 
-    QSet<Database*> databases;
+    connectDatabases(m_entries);
 
-    for (Entry* entry : asConst(m_entries)) {
-        databases.insert(entry->group()->database());
+    endResetModel();
+    emit switchedToEntryListMode();
+}
+
+/**
+ * Add entries to the end of the list set with setEntryList().
+ * Used to show search results while the search is still running.
+ */
+void EntryModel::appendEntries(const QList<Entry*>& entries)
+{
+    Q_ASSERT(!m_group);
+    if (m_group || entries.isEmpty()) {
+        return;
     }
 
-    for (Database* db : asConst(databases)) {
-        Q_ASSERT(db);
-        const QList<Group*> groupList = db->rootGroup()->groupsRecursive(true);
-        for (const Group* group : groupList) {
-            m_allGroups.append(group);
-        }
+    connectDatabases(entries);
 
-        if (db->metadata()->recycleBin()) {
-            m_allGroups.removeOne(db->metadata()->recycleBin());
-        }
-    }
+    m_entries.append(entries);
+    m_orgEntries.append(entries);
 
-    for (const Group* group : asConst(m_allGroups)) {
-        makeConnections(group);
+    int loadedCount = qMin(m_entries.size(), qMax(m_loadedCount, FetchBatchSize));
+    if (loadedCount > m_loadedCount) {
+        beginInsertRows(QModelIndex(), m_loadedCount, loadedCount - 1);
+        m_loadedCount = loadedCount;
+        endInsertRows();
     }
-
-    endResetModel();
-    emit switchedToEntryListMode();
 }
 
 int EntryModel::rowCount(const QModelIndex& parent) const
@@ -110,7 +132,7 @@ int EntryModel::rowCount(const QModelIndex& parent) const
         return 0;
     }
     else {
-        return m_entries.size();
+        return m_loadedCount;
     }
 }
 
@@ -128,10 +150,8 @@ QVariant EntryModel::data(const QModelIndex& index, int role) const
     }
 
     Entry* entry = entryFromIndex(index);
-    EntryAttributes* attr = entry->attributes();
 
     if (role == Qt::DisplayRole) {
-        QString result;
         switch (index.column()) {
         case ParentGroup:
             if (entry->group()) {
@@ -139,23 +159,11 @@ QVariant EntryModel::data(const QModelIndex& index, int role) const
             }
             break;
         case Title:
-            result = entry->resolveMultiplePlaceholders(entry->title());
-            if (attr->isReference(EntryAttributes::TitleKey)) {
-                result.prepend(tr("Ref: ","Reference abbreviation"));
-            }
-            return result;
+            return displayData(entry).title;
         case Username:
-            result = entry->resolveMultiplePlaceholders(entry->username());
-            if (attr->isReference(EntryAttributes::UserNameKey)) {
-                result.prepend(tr("Ref: ","Reference abbreviation"));
-            }
-            return result;
+            return displayData(entry).username;
         case Url:
-            result = entry->displayUrl();
-            if (attr->isReference(EntryAttributes::URLKey)) {
-                result.prepend(tr("Ref: ","Reference abbreviation"));
-            }
-            return result;
+            return displayData(entry).url;
         }
     }
     else if (role == Qt::DecorationRole) {
@@ -166,23 +174,23 @@ QVariant EntryModel::data(const QModelIndex& index, int role) const
             }
             break;
         case Title:
-            if (entry->isExpired()) {
+            if (isExpired(displayData(entry))) {
                 return databaseIcons()->iconPixmap(DatabaseIcons::ExpiredIconIndex);
             }
             else {
-                return entry->iconScaledPixmap();
+                return displayData(entry).icon;
             }
         }
     }
     else if (role == Qt::FontRole) {
         QFont font;
-        if (entry->isExpired()) {
+        if (isExpired(displayData(entry))) {
             font.setStrikeOut(true);
         }
         return font;
     }
     else if (role == Qt::TextColorRole) {
-        if (entry->hasReferences()) {
+        if (displayData(entry).hasReferences) {
             QPalette p;
             return QVariant(p.color(QPalette::Active, QPalette::Mid));
         }
@@ -190,6 +198,48 @@ QVariant EntryModel::data(const QModelIndex& index, int role) const
 
     return QVariant();
 }
+
+/**
+ * Computes the values shown for an entry once and caches them until
+ * the entry changes. Resolving placeholders is too expensive to be
+ * repeated on every paint.
+ */
+const EntryModel::DisplayData& EntryModel::displayData(Entry* entry) const
+{
+    auto it = m_displayCache.find(entry);
+    if (it != m_displayCache.end()) {
+        return it.value();
+    }
+
+    EntryAttributes* attr = entry->attributes();
+    DisplayData data;
+
+    data.title = entry->resolveMultiplePlaceholders(entry->title());
+    if (attr->isReference(EntryAttributes::TitleKey)) {
+        data.title.prepend(tr("Ref: ","Reference abbreviation"));
+    }
+    data.username = entry->resolveMultiplePlaceholders(entry->username());
+    if (attr->isReference(EntryAttributes::UserNameKey)) {
+        data.username.prepend(tr("Ref: ","Reference abbreviation"));
+    }
+    data.url = entry->displayUrl();
+    if (attr->isReference(EntryAttributes::URLKey)) {
+        data.url.prepend(tr("Ref: ","Reference abbreviation"));
+    }
+    data.icon = entry->iconScaledPixmap();
+    data.expiryTime = entry->timeInfo().expires()
+            ? entry->timeInfo().expiryTime().toMSecsSinceEpoch()
+            : std::numeric_limits<qint64>::max();
+    data.hasReferences = entry->hasReferences();
+
+    return m_displayCache.insert(entry, data).value();
+}
+
+bool EntryModel::isExpired(const DisplayData& displayData) const
+{
+    return displayData.expiryTime < QDateTime::currentMSecsSinceEpoch();
+}
+
 QVariant EntryModel::headerData(int section, Qt::Orientation orientation, int role) const
 {
     if (orientation == Qt::Horizontal && role == Qt::DisplayRole) {
@@ -208,6 +258,31 @@ QVariant EntryModel::headerData(int section, Qt::Orientation orientation, int ro
     return QVariant();
 }
 
+bool EntryModel::canFetchMore(const QModelIndex& parent) const
+{
+    if (parent.isValid()) {
+        return false;
+    }
+
+    return m_loadedCount < m_entries.size();
+}
+
+void EntryModel::fetchMore(const QModelIndex& parent)
+{
+    if (parent.isValid()) {
+        return;
+    }
+
+    int count = qMin(m_entries.size() - m_loadedCount, FetchBatchSize);
+    if (count <= 0) {
+        return;
+    }
+
+    beginInsertRows(QModelIndex(), m_loadedCount, m_loadedCount + count - 1);
+    m_loadedCount += count;
+    endInsertRows();
+}
+
 Qt::DropActions EntryModel::supportedDropActions() const
 {
     return 0;
@@ -277,44 +352,88 @@ void EntryModel::entryAboutToAdd(Entry* entry)
         return;
     }
 
-    beginInsertRows(QModelIndex(), m_entries.size(), m_entries.size());
+    // rows that have not been fetched yet stay behind the loaded ones
+    beginInsertRows(QModelIndex(), m_loadedCount, m_loadedCount);
     if (!m_group) {
-        m_entries.append(entry);
+        m_entries.insert(m_loadedCount, entry);
+        ++m_loadedCount;
     }
+    m_insertPending = true;
 }
 
 void EntryModel::entryAdded(Entry* entry)
 {
-    if (!m_group && !m_orgEntries.contains(entry)) {
+    Q_UNUSED(entry);
+
+    if (!m_insertPending) {
         return;
     }
 
     if (m_group) {
         m_entries = m_group->entries();
+        m_loadedCount = m_entries.size();
     }
+    m_insertPending = false;
     endInsertRows();
 }
 
 void EntryModel::entryAboutToRemove(Entry* entry)
 {
-    beginRemoveRows(QModelIndex(), m_entries.indexOf(entry), m_entries.indexOf(entry));
+    m_displayCache.remove(entry);
+
+    int row = m_entries.indexOf(entry);
+    if (row == -1) {
+        return;
+    }
+
+    if (row >= m_loadedCount) {
+        // not visible yet, no need to notify views
+        m_entries.removeAt(row);
+        return;
+    }
+
+    beginRemoveRows(QModelIndex(), row, row);
     if (!m_group) {
-        m_entries.removeAll(entry);
+        m_entries.removeAt(row);
+        --m_loadedCount;
     }
+    m_removePending = true;
 }
 
 void EntryModel::entryRemoved()
 {
+    if (!m_removePending) {
+        return;
+    }
+
     if (m_group) {
         m_entries = m_group->entries();
+        m_loadedCount = m_entries.size();
     }
 
+    m_removePending = false;
     endRemoveRows();
 }
 
 void EntryModel::entryDataChanged(Entry* entry)
 {
+    m_displayCache.remove(entry);
+
+    // placeholders of other entries may reference this one
+    for (auto it = m_displayCache.begin(); it != m_displayCache.end();) {
+        if (it.value().hasReferences) {
+            it = m_displayCache.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+
     int row = m_entries.indexOf(entry);
+    if (row == -1 || row >= m_loadedCount) {
+        return;
+    }
+
     emit dataChanged(index(row, 0), index(row, columnCount()-1));
 }
 
@@ -329,6 +448,38 @@ void EntryModel::severConnections()
     }
 }
 
+void EntryModel::connectDatabases(const QList<Entry*>& entries)
+{
+    QSet<Database*> databases;
+
+    for (Entry* entry : entries) {
+        Database* db = entry->group()->database();
+        if (!m_databases.contains(db)) {
+            databases.insert(db);
+        }
+    }
+
+    for (Database* db : asConst(databases)) {
+        Q_ASSERT(db);
+        m_databases.insert(db);
+
+        QList<const Group*> groups;
+        const QList<Group*> groupList = db->rootGroup()->groupsRecursive(true);
+        for (const Group* group : groupList) {
+            groups.append(group);
+        }
+
+        if (db->metadata()->recycleBin()) {
+            groups.removeOne(db->metadata()->recycleBin());
+        }
+
+        for (const Group* group : asConst(groups)) {
+            makeConnections(group);
+        }
+        m_allGroups.append(groups);
+    }
+}
+
 void EntryModel::makeConnections(const Group* group)
 {
     connect(group, SIGNAL(entryAboutToAdd(Entry*)), SLOT(entryAboutToAdd(Entry*)));
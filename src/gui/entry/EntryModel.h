@@ -19,7 +19,11 @@
 #define KEEPASSX_ENTRYMODEL_H
 
 #include <QAbstractTableModel>
+#include <QHash>
+#include <QPixmap>
+#include <QSet>
 
+class Database;
 class Entry;
 class Group;
 
@@ -44,6 +48,8 @@ public:
     int columnCount(const QModelIndex& parent = QModelIndex()) const override;
     QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
     QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+    bool canFetchMore(const QModelIndex& parent) const override;
+    void fetchMore(const QModelIndex& parent) override;
     Qt::DropActions supportedDropActions() const override;
     Qt::DropActions supportedDragActions() const override;
     Qt::ItemFlags flags(const QModelIndex& modelIndex) const override;
@@ -51,6 +57,7 @@ public:
     QMimeData* mimeData(const QModelIndexList& indexes) const override;
 
     void setEntryList(const QList<Entry*>& entries);
+    void appendEntries(const QList<Entry*>& entries);
 
 signals:
     void switchedToEntryListMode();
@@ -67,13 +74,33 @@ private slots:
     void entryDataChanged(Entry* entry);
 
 private:
+    struct DisplayData
+    {
+        QString title;
+        QString username;
+        QString url;
+        QPixmap icon;
+        qint64 expiryTime;
+        bool hasReferences;
+    };
+
     void severConnections();
     void makeConnections(const Group* group);
+    void connectDatabases(const QList<Entry*>& entries);
+    const DisplayData& displayData(Entry* entry) const;
+    bool isExpired(const DisplayData& displayData) const;
+
+    static const int FetchBatchSize;
 
     Group* m_group;
     QList<Entry*> m_entries;
     QList<Entry*> m_orgEntries;
     QList<const Group*> m_allGroups;
+    QSet<const Database*> m_databases;
+    int m_loadedCount;
+    bool m_insertPending;
+    bool m_removePending;
+    mutable QHash<const Entry*, DisplayData> m_displayCache;
 };
 
 #endif // KEEPASSX_ENTRYMODEL_H
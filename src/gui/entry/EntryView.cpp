@@ -78,6 +78,11 @@ void EntryView::setEntryList(const QList<Entry*>& entries)
     setFirstEntryActive();
 }
 
+void EntryView::appendEntries(const QList<Entry*>& entries)
+{
+    m_model->appendEntries(entries);
+}
+
 void EntryView::setFirstEntryActive()
 {
     if (m_model->rowCount() > 0) {
@@ -130,7 +135,14 @@ int EntryView::numberOfSelectedEntries()
 
 void EntryView::setCurrentEntry(Entry* entry)
 {
-    selectionModel()->setCurrentIndex(m_sortModel->mapFromSource(m_model->indexFromEntry(entry)),
+    QModelIndex index = m_model->indexFromEntry(entry);
+    // make sure the entry has been fetched into the model
+    while (!index.isValid() && m_model->canFetchMore(QModelIndex())) {
+        m_model->fetchMore(QModelIndex());
+        index = m_model->indexFromEntry(entry);
+    }
+
+    selectionModel()->setCurrentIndex(m_sortModel->mapFromSource(index),
                                       QItemSelectionModel::ClearAndSelect | QItemSelectionModel::Rows);
 }
 
@@ -38,6 +38,7 @@ public:
     void setCurrentEntry(Entry* entry);
     Entry* entryFromIndex(const QModelIndex& index);
     void setEntryList(const QList<Entry*>& entries);
+    void appendEntries(const QList<Entry*>& entries);
     bool inEntryListMode();
     int numberOfSelectedEntries();
     void setFirstEntryActive();
@@ -0,0 +1,155 @@
+/*
+ *  Copyright (C) 2017 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PasswordAuditModel.h"
+
+#include <QStringList>
+
+#include "core/Entry.h"
+
+PasswordAuditModel::PasswordAuditModel(PasswordAudit* audit, QObject* parent)
+    : QAbstractTableModel(parent)
+{
+    Q_ASSERT(audit);
+
+    connect(audit, SIGNAL(resultReady(PasswordAudit::Result)), SLOT(addResult(PasswordAudit::Result)));
+}
+
+Entry* PasswordAuditModel::entryFromIndex(const QModelIndex& index) const
+{
+    Q_ASSERT(index.isValid() && index.row() < m_results.size());
+    return m_results.at(index.row()).entry.data();
+}
+
+PasswordAudit::Result PasswordAuditModel::resultFromIndex(const QModelIndex& index) const
+{
+    Q_ASSERT(index.isValid() && index.row() < m_results.size());
+    return m_results.at(index.row());
+}
+
+int PasswordAuditModel::rowCount(const QModelIndex& parent) const
+{
+    if (parent.isValid()) {
+        return 0;
+    }
+
+    return m_results.size();
+}
+
+int PasswordAuditModel::columnCount(const QModelIndex& parent) const
+{
+    Q_UNUSED(parent);
+
+    return 6;
+}
+
+QVariant PasswordAuditModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid()) {
+        return QVariant();
+    }
+
+    const PasswordAudit::Result& result = m_results.at(index.row());
+    const Entry* entry = result.entry.data();
+
+    if (role == Qt::DisplayRole || role == SortRole) {
+        switch (index.column()) {
+        case Title:
+            return entry ? entry->resolveMultiplePlaceholders(entry->title()) : QString();
+        case Username:
+            return entry ? entry->resolveMultiplePlaceholders(entry->username()) : QString();
+        case Entropy:
+            if (role == SortRole) {
+                return result.entropy;
+            }
+            return QString::number(result.entropy, 'f', 2);
+        case Quality:
+            if (role == SortRole) {
+                return static_cast<int>(PasswordAudit::quality(result.entropy));
+            }
+            return qualityText(PasswordAudit::quality(result.entropy));
+        case Reused:
+            if (role == SortRole) {
+                return result.reuseCount;
+            }
+            return result.reuseCount > 1 ? QString::number(result.reuseCount) : QString();
+        case Status: {
+            QStringList status;
+            if (result.flags & PasswordAudit::ExpiredEntry) {
+                status << tr("Expired");
+            }
+            if (result.flags & PasswordAudit::StaleEntry) {
+                status << tr("Stale");
+            }
+            return status.join(", ");
+        }
+        }
+    }
+
+    return QVariant();
+}
+
+QVariant PasswordAuditModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation == Qt::Horizontal && role == Qt::DisplayRole) {
+        switch (section) {
+        case Title:
+            return tr("Title");
+        case Username:
+            return tr("Username");
+        case Entropy:
+            return tr("Entropy");
+        case Quality:
+            return tr("Quality");
+        case Reused:
+            return tr("Reused");
+        case Status:
+            return tr("Status");
+        }
+    }
+
+    return QVariant();
+}
+
+void PasswordAuditModel::clear()
+{
+    beginResetModel();
+    m_results.clear();
+    endResetModel();
+}
+
+void PasswordAuditModel::addResult(const PasswordAudit::Result& result)
+{
+    beginInsertRows(QModelIndex(), m_results.size(), m_results.size());
+    m_results.append(result);
+    endInsertRows();
+}
+
+QString PasswordAuditModel::qualityText(PasswordAudit::Quality quality)
+{
+    switch (quality) {
+    case PasswordAudit::Poor:
+        return tr("Poor");
+    case PasswordAudit::Weak:
+        return tr("Weak");
+    case PasswordAudit::Good:
+        return tr("Good");
+    case PasswordAudit::Excellent:
+        return tr("Excellent");
+    }
+    return QString();
+}
@@ -0,0 +1,74 @@
+/*
+ *  Copyright (C) 2017 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSX_PASSWORDAUDITMODEL_H
+#define KEEPASSX_PASSWORDAUDITMODEL_H
+
+#include <QAbstractTableModel>
+#include <QList>
+
+#include "core/PasswordAudit.h"
+
+class Entry;
+
+/**
+ * Report of a PasswordAudit, one row per entry. Rows are appended as the
+ * audit reports its results.
+ */
+class PasswordAuditModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    enum ModelColumn
+    {
+        Title = 0,
+        Username = 1,
+        Entropy = 2,
+        Quality = 3,
+        Reused = 4,
+        Status = 5
+    };
+
+    enum ModelRole
+    {
+        // raw value of the column, for sorting
+        SortRole = Qt::UserRole
+    };
+
+    explicit PasswordAuditModel(PasswordAudit* audit, QObject* parent = nullptr);
+    Entry* entryFromIndex(const QModelIndex& index) const;
+    PasswordAudit::Result resultFromIndex(const QModelIndex& index) const;
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+public slots:
+    void clear();
+
+private slots:
+    void addResult(const PasswordAudit::Result& result);
+
+private:
+    static QString qualityText(PasswordAudit::Quality quality);
+
+    QList<PasswordAudit::Result> m_results;
+};
+
+#endif // KEEPASSX_PASSWORDAUDITMODEL_H
@@ -115,7 +115,7 @@ QModelIndex GroupModel::parent(Group* group) const
             return createIndex(0, 0, parentGroup);
         }
         else {
-            return createIndex(grandParentGroup->children().indexOf(parentGroup), 0, parentGroup);
+            return createIndex(parentGroup->indexInParent(), 0, parentGroup);
         }
     }
 }
@@ -168,7 +168,7 @@ QModelIndex GroupModel::index(Group* group) const
         row = 0;
     }
     else {
-        row = group->parentGroup()->children().indexOf(group);
+        row = group->indexInParent();
     }
 
     return createIndex(row, 0, group);
@@ -251,7 +251,7 @@ bool GroupModel::dropMimeData(const QMimeData* data, Qt::DropAction action,
             return false;
         }
 
-        if (parentGroup == dragGroup->parent() && row > parentGroup->children().indexOf(dragGroup)) {
+        if (parentGroup == dragGroup->parent() && row > dragGroup->indexInParent()) {
             row--;
         }
 
@@ -308,7 +308,7 @@ bool GroupModel::dropMimeData(const QMimeData* data, Qt::DropAction action,
             if (sourceDb != targetDb && !customIcon.isNull()
                     && !targetDb->metadata()->containsCustomIcon(customIcon)) {
                 targetDb->metadata()->addCustomIcon(customIcon,
-                                                    sourceDb->metadata()->customIcon(customIcon));
+                                                    sourceDb->metadata()->customIconData(customIcon));
             }
 
             entry->setGroup(parentGroup);
@@ -374,7 +374,7 @@ void GroupModel::groupAboutToRemove(Group* group)
 
     QModelIndex parentIndex = parent(group);
     Q_ASSERT(parentIndex.isValid());
-    int pos = group->parentGroup()->children().indexOf(group);
+    int pos = group->indexInParent();
     Q_ASSERT(pos != -1);
 
     beginRemoveRows(parentIndex, pos, pos);
@@ -405,7 +405,7 @@ void GroupModel::groupAboutToMove(Group* group, Group* toGroup, int pos)
 
     QModelIndex oldParentIndex = parent(group);
     QModelIndex newParentIndex = index(toGroup);
-    int oldPos = group->parentGroup()->children().indexOf(group);
+    int oldPos = group->indexInParent();
     if (group->parentGroup() == toGroup && pos > oldPos) {
         // beginMoveRows() has a bit different semantics than Group::setParent() and
         // QList::move() when the new position is greater than the old
@@ -132,6 +132,7 @@ static QString encrypt(const QString & data, SymmetricCipherGcrypt & cipher)
 
 Request::Request():
     m_requestType(INVALID),
+    m_limit(-1),
     m_cipher(SymmetricCipher::Aes256, SymmetricCipher::Cbc, SymmetricCipher::Decrypt)
 {
   m_cipher.init();
@@ -243,6 +244,27 @@ void Request::setPassword(const QString &password)
     m_password = password;
 }
 
+QString Request::after() const
+{
+    //Q_ASSERT(m_cipher.isValid());
+    return m_after.isEmpty() ? QString() : decrypt(m_after, m_cipher).toLower();
+}
+
+void Request::setAfter(const QString &after)
+{
+    m_after = after;
+}
+
+int Request::limit() const
+{
+    return m_limit;
+}
+
+void Request::setLimit(int limit)
+{
+    m_limit = limit;
+}
+
 bool Request::sortSelection() const
 {
     return m_sortSelection;
@@ -324,7 +346,12 @@ void Response::setVerifier(QString key)
     m_verifier = encrypt(m_nonce, m_cipher);
 }
 
-QString Response::toJson()
+/**
+ * Serialize the response. Entries are encrypted and written one at a time
+ * instead of going through a QVariant tree of encrypted copies, so large
+ * replies only hold the plain entries and the output buffer.
+ */
+QByteArray Response::toJson()
 {
     QJsonObject json;
     
@@ -335,8 +362,49 @@ QString Response::toJson()
         json.insert(QString(name), QJsonValue::fromVariant(this->property(name)));
     }
 
-    QJsonDocument doc(json);
-    return doc.toJson(QJsonDocument::Compact);
+    QByteArray out = QJsonDocument(json).toJson(QJsonDocument::Compact);
+
+    // a count without entries (get-logins-count) keeps "Entries":null, clients
+    // expect an empty list for empty results though
+    if (m_count < 0 || (m_entries.isEmpty() && m_count > 0)) {
+        out.insert(out.size() - 1, ",\"Entries\":null");
+        return out;
+    }
+
+    // splice the entries array in before the closing brace
+    out.chop(1);
+    out.append(",\"Entries\":[");
+    for (int i = 0; i < m_entries.size(); ++i) {
+        if (i > 0)
+            out.append(',');
+        out.append(QJsonDocument(encryptEntry(m_entries.at(i))).toJson(QJsonDocument::Compact));
+    }
+    out.append("]}");
+    return out;
+}
+
+QJsonObject Response::encryptEntry(const Entry &entry)
+{
+    QJsonObject json;
+    json.insert("Login", encrypt(entry.login(), m_cipher));
+    json.insert("Name", encrypt(entry.name(), m_cipher));
+    json.insert("Password", entry.password().isNull() ? QString() : encrypt(entry.password(), m_cipher));
+    json.insert("Uuid", encrypt(entry.uuid(), m_cipher));
+
+    const auto stringFields = entry.stringFields();
+    if (stringFields.isEmpty()) {
+        json.insert("StringFields", QJsonValue());
+    } else {
+        QJsonArray fields;
+        for (const StringField& field: stringFields) {
+            QJsonObject object;
+            object.insert("Key", encrypt(field.key(), m_cipher));
+            object.insert("Value", encrypt(field.value(), m_cipher));
+            fields.append(object);
+        }
+        json.insert("StringFields", fields);
+    }
+    return json;
 }
 
 KeepassHttpProtocol::RequestType Response::requestType() const
@@ -369,40 +437,23 @@ void Response::setCount(int count)
     m_count = count;
 }
 
-QVariant Response::getEntries() const
-{
-    if (m_count < 0 || m_entries.isEmpty())
-        return QVariant();
-
-    QList<QVariant> res;
-    res.reserve(m_entries.size());
-    for (const Entry& entry: asConst(m_entries)) {
-        res.append(qobject2qvariant(&entry));
-    }
-    return res;
-}
-
 void Response::setEntries(const QList<Entry> &entries)
 {
     //Q_ASSERT(m_cipher.isValid());
 
+    // encrypted while serializing, see toJson()
     m_count = entries.count();
+    m_entries = entries;
+}
 
-    QList<Entry> encryptedEntries;
-    encryptedEntries.reserve(m_count);
-    for (const Entry& entry: entries) {
-        Entry encryptedEntry(encrypt(entry.name(), m_cipher),
-                             encrypt(entry.login(), m_cipher),
-                             entry.password().isNull() ? QString() : encrypt(entry.password(), m_cipher),
-                             encrypt(entry.uuid(), m_cipher));
-        const auto stringFields = entry.stringFields();
-        for (const StringField& field: stringFields) {
-            encryptedEntry.addStringField(encrypt(field.key(), m_cipher),
-                                          encrypt(field.value(), m_cipher));
-        }
-        encryptedEntries << encryptedEntry;
-    }
-    m_entries = encryptedEntries;
+QVariant Response::next() const
+{
+    return m_next.isEmpty() ? QVariant() : QVariant(encrypt(m_next, m_cipher));
+}
+
+void Response::setNext(const QString &next)
+{
+    m_next = next;
 }
 
 QString Response::hash() const
@@ -54,6 +54,8 @@ class Request : public QObject
     Q_PROPERTY(QString Verifier      READ verifier       WRITE setVerifier     )
     Q_PROPERTY(QString Nonce         READ nonce          WRITE setNonce        )
     Q_PROPERTY(QString Realm         READ realm          WRITE setRealm        )
+    Q_PROPERTY(QString After         READ after          WRITE setAfter        )
+    Q_PROPERTY(int     Limit         READ limit          WRITE setLimit        )
 
 public:
     Request();
@@ -72,6 +74,8 @@ public:
     QString verifier() const;
     QString nonce() const;
     QString realm() const;
+    QString after() const;
+    int limit() const;
     bool CheckVerifier(const QString & key) const;
 
 private:
@@ -87,6 +91,8 @@ private:
     void setVerifier(const QString &verifier);
     void setNonce(const QString &nonce);
     void setRealm(const QString &realm);
+    void setAfter(const QString &after);
+    void setLimit(int limit);
 
     QString m_requestType;
     bool m_sortSelection;
@@ -100,6 +106,8 @@ private:
     QString m_verifier;
     QString m_nonce;
     QString m_realm;
+    QString m_after;
+    int m_limit;
     mutable SymmetricCipherGcrypt m_cipher;
 };
 
@@ -165,7 +173,7 @@ class Response : public QObject
     Q_PROPERTY(QString Version     READ version       )
     Q_PROPERTY(QString Hash        READ hash          )
     Q_PROPERTY(QVariant Count      READ count         )
-    Q_PROPERTY(QVariant Entries    READ getEntries    )
+    Q_PROPERTY(QVariant Next       READ next          )
     Q_PROPERTY(QString Nonce       READ nonce         )
     Q_PROPERTY(QString Verifier    READ verifier      )
 
@@ -183,16 +191,18 @@ public:
     QString hash() const;
     QVariant count() const;
     void setCount(int count);
-    QVariant getEntries() const;
     void setEntries(const QList<Entry> &entries);
+    QVariant next() const;
+    void setNext(const QString &next);
     QString nonce() const;
     QString verifier() const;
     void setVerifier(QString key);
 
-    QString toJson();
+    QByteArray toJson();
 
 private:
     QString requestTypeStr() const;
+    QJsonObject encryptEntry(const Entry &entry);
 
     QString m_requestType;
     QString m_error;
@@ -202,6 +212,7 @@ private:
     QString m_version;
     QString m_hash;
     QList<Entry> m_entries;
+    QString m_next;
     QString m_nonce;
     QString m_verifier;
     mutable SymmetricCipherGcrypt m_cipher;
@@ -209,4 +220,6 @@ private:
 
 }/*namespace KeepassHttpProtocol*/
 
+Q_DECLARE_METATYPE(KeepassHttpProtocol::Entry)
+
 #endif // RESPONSE_H
@@ -17,17 +17,22 @@
 */
 
 #include <QEventLoop>
+#include <QFutureWatcher>
 #include <QtCore/QHash>
 #include <QtCore/QCryptographicHash>
 #include <QtWidgets/QMessageBox>
 
+#include <QTcpServer>
+
 #include "qhttp/qhttpserver.hpp"
+#include "qhttp/qhttpserverconnection.hpp"
 #include "qhttp/qhttpserverresponse.hpp"
 #include "qhttp/qhttpserverrequest.hpp"
 
 #include "Server.h"
 #include "Protocol.h"
 #include "HttpSettings.h"
+#include "core/AsyncTask.h"
 #include "crypto/Crypto.h"
 
 using namespace KeepassHttpProtocol;
@@ -38,7 +43,7 @@ Server::Server(QObject *parent) :
     m_started(false),
     m_server(nullptr)
 {
-
+    m_threadPool.setMaxThreadCount(MaxRequestThreads);
 }
 
 void Server::testAssociate(const Request& r, Response * protocolResp)
@@ -106,7 +111,15 @@ void Server::getAllLogins(const Request &r, Response *protocolResp)
     protocolResp->setSuccess();
     protocolResp->setId(r.id());
     protocolResp->setVerifier(key);
-    protocolResp->setEntries(searchAllEntries(r.id()));   //TODO: ensure there is no password --> change API?
+    //Pages are capped at MaxPageSize entries (also without a Limit). When more
+    //entries follow, Next holds the UUID to send as After for the next page.
+    const int limit = r.limit() > 0 ? qMin(r.limit(), int(MaxPageSize)) : int(MaxPageSize);
+    QList<Entry> entries = searchAllEntries(r.id(), r.after(), limit + 1);   //TODO: ensure there is no password --> change API?
+    if (entries.size() > limit) {
+        entries.removeLast();
+        protocolResp->setNext(entries.last().uuid());
+    }
+    protocolResp->setEntries(entries);
 }
 
 void Server::setLogin(const Request &r, Response *protocolResp)
@@ -143,11 +156,11 @@ void Server::generatePassword(const Request &r, Response *protocolResp)
     memset(password.data(), 0, password.length());
 }
 
-void Server::handleRequest(const QByteArray& data, QHttpResponse* response)
+QByteArray Server::handleRequest(const QByteArray& data)
 {
     Request r;
     if (!r.fromJson(data))
-        return;
+        return QByteArray();
 
     QByteArray hash = QCryptographicHash::hash(
         (getDatabaseRootUuid() + getDatabaseRecycleBinUuid()).toUtf8(),
@@ -165,26 +178,84 @@ void Server::handleRequest(const QByteArray& data, QHttpResponse* response)
     case GENERATE_PASSWORD: generatePassword(r, &protocolResp); break;
     }
 
-    QString out = protocolResp.toJson().toUtf8();
-
-    // THIS IS A FAKE HACK!!!
-    // the real "error" is a misbehavior in the QJSON qobject2qvariant method
-    // 1. getLogins returns an empty QList<Entry> into protocolResp->m_entries
-    // in toJson() function the following happened:
-    // 2. QJson::QObjectHelper::qobject2qvariant marks m_entries as invalid !!!
-    // 3. QJson::Serializer write out Entries as null instead of empty list
-    //(4. ChromeIPass tries to access Entries.length and fails with null pointer exception)
-    // the fake workaround replaces the (wrong) "Entries":null with "Entries:[] to give
-    // chromeIPass (and passIFox) en empty list
-    int pos1 = out.indexOf("\"Count\":0,");
-    int pos2 = out.indexOf("\"Entries\":null,");
-    if (pos1 != -1 && pos2 != -1) {
-        out.replace(pos2, 15, "\"Entries\":[],");
+    return protocolResp.toJson();
+}
+
+void Server::queueRequest(const QByteArray& data, QHttpResponse* response)
+{
+    QObject* connection = response->connection();
+    if (!m_pendingResponses.contains(connection)) {
+        connect(connection, SIGNAL(destroyed(QObject*)), SLOT(connectionDestroyed(QObject*)));
     }
 
-    response->setStatusCode(qhttp::ESTATUS_OK);
-    response->addHeader("Content-Type", "application/json");
-    response->end(out.toUtf8());
+    QFutureWatcher<QByteArray>* watcher = new QFutureWatcher<QByteArray>(this);
+    connect(watcher, SIGNAL(finished()), SLOT(sendFinishedResponses()));
+    watcher->setFuture(AsyncTask::runOnPool(&m_threadPool, [this, data]() {
+        return handleRequest(data);
+    }));
+
+    PendingResponse pending;
+    pending.response = response;
+    pending.reply = watcher->future();
+    m_pendingResponses[connection].append(pending);
+}
+
+void Server::sendFinishedResponses()
+{
+    sender()->deleteLater();
+
+    // HTTP requires pipelined requests to be answered in the order they came in
+    for (QList<PendingResponse>& queue : m_pendingResponses) {
+        while (!queue.isEmpty() && queue.first().reply.isFinished()) {
+            const PendingResponse pending = queue.takeFirst();
+            if (!pending.response) {
+                continue;
+            }
+
+            const QByteArray out = pending.reply.result();
+            pending.response->setStatusCode(out.isEmpty() ? qhttp::ESTATUS_BAD_REQUEST : qhttp::ESTATUS_OK);
+            pending.response->addHeader("Content-Type", "application/json");
+            // lets keep-alive clients find the end of the reply
+            pending.response->addHeader("Content-Length", QByteArray::number(out.size()));
+            pending.response->end(out);
+        }
+    }
+}
+
+void Server::connectionDestroyed(QObject* connection)
+{
+    m_pendingResponses.remove(connection);
+}
+
+void Server::waitForRequests()
+{
+    // Running requests may be blocked on calls into the GUI thread, keep
+    // serving them until they have finished
+    QList<QFuture<QByteArray>> replies;
+    for (const QList<PendingResponse>& queue : m_pendingResponses) {
+        for (const PendingResponse& pending : queue) {
+            replies.append(pending.reply);
+        }
+    }
+
+    for (const QFuture<QByteArray>& reply : replies) {
+        QFutureWatcher<QByteArray> watcher;
+        QEventLoop loop;
+        connect(&watcher, SIGNAL(finished()), &loop, SLOT(quit()));
+        watcher.setFuture(reply);
+        loop.exec(QEventLoop::ExcludeUserInputEvents);
+    }
+}
+
+/**
+ * The port the server listens on, which differs from the configured one if
+ * that was 0. Returns 0 if the server isn't running.
+ */
+quint16 Server::serverPort() const
+{
+    if (!m_started || !m_server->tcpServer())
+        return 0;
+    return m_server->tcpServer()->serverPort();
 }
 
 void Server::start(void)
@@ -198,6 +269,7 @@ void Server::start(void)
     int port = HttpSettings::httpPort();
 
     m_server = new QHttpServer(this);
+    m_server->setTimeOut(KeepAliveTimeout);
     m_server->listen(address, port);
     connect(m_server, SIGNAL(newRequest(QHttpRequest*, QHttpResponse*)), this, SLOT(onNewRequest(QHttpRequest*, QHttpResponse*)));
 
@@ -209,6 +281,8 @@ void Server::stop(void)
     if (!m_started)
         return;
 
+    waitForRequests();
+    m_pendingResponses.clear();
     m_server->stopListening();
     m_server->deleteLater();
     m_started = false;
@@ -219,6 +293,7 @@ void Server::onNewRequest(QHttpRequest* request, QHttpResponse* response)
     if (!isDatabaseOpened()) {
         if (!openDatabase()) {
             response->setStatusCode(qhttp::ESTATUS_SERVICE_UNAVAILABLE);
+            response->addHeader("Content-Length", "0");
             response->end();
             return;
         }
@@ -227,6 +302,6 @@ void Server::onNewRequest(QHttpRequest* request, QHttpResponse* response)
     request->collectData(1024);
 
     request->onEnd([=]() {
-        this->handleRequest(request->collectedData(), response);
+        this->queueRequest(request->collectedData(), response);
     });
 }
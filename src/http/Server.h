@@ -20,7 +20,11 @@
 #define SERVER_H
 
 #include <QtCore/QObject>
+#include <QtCore/QFuture>
+#include <QtCore/QHash>
 #include <QtCore/QList>
+#include <QtCore/QPointer>
+#include <QtCore/QThreadPool>
 
 namespace qhttp {
     namespace server {
@@ -38,6 +42,15 @@ class Request;
 class Response;
 class Entry;
 
+/**
+ * Embedded KeePassHTTP server.
+ *
+ * Requests are decoded, verified and answered on a thread pool of the
+ * server, implementations must therefore make the virtual database accessors
+ * safe to call from any thread. They may block, e.g. on a dialog, without
+ * holding up the global thread pool. Connections are kept alive and pipelined
+ * requests are answered in order.
+ */
 class Server : public QObject
 {
     Q_OBJECT
@@ -52,20 +65,37 @@ public:
     virtual QString storeKey(const QString &key) = 0;
     virtual QList<Entry> findMatchingEntries(const QString &id, const QString &url, const QString & submitUrl, const QString & realm) = 0;
     virtual int countMatchingEntries(const QString &id, const QString &url, const QString & submitUrl, const QString & realm) = 0;
-    virtual QList<Entry> searchAllEntries(const QString &id) = 0;
+    virtual QList<Entry> searchAllEntries(const QString &id, const QString &after, int limit) = 0;
     virtual void addEntry(const QString &id, const QString &login, const QString &password, const QString &url, const QString &submitUrl, const QString &realm) = 0;
     virtual void updateEntry(const QString &id, const QString &uuid, const QString &login, const QString &password, const QString &url) = 0;
     virtual QString generatePassword() = 0;
 
+    quint16 serverPort() const;
+
 public slots:
     void start();
     void stop();
 
 private slots:
     void onNewRequest(QHttpRequest* request, QHttpResponse* response);
-    void handleRequest(const QByteArray& data, QHttpResponse* response);
+    void sendFinishedResponses();
+    void connectionDestroyed(QObject* connection);
 
 private:
+    struct PendingResponse
+    {
+        QPointer<QHttpResponse> response;
+        QFuture<QByteArray>     reply;
+    };
+
+    enum { KeepAliveTimeout = 30000 };
+    enum { MaxRequestThreads = 4 };
+    enum { MaxPageSize = 500 };
+
+    QByteArray handleRequest(const QByteArray& data);
+    void queueRequest(const QByteArray& data, QHttpResponse* response);
+    void waitForRequests();
+
     void testAssociate(const KeepassHttpProtocol::Request &r, KeepassHttpProtocol::Response *protocolResp);
     void associate(const KeepassHttpProtocol::Request &r, KeepassHttpProtocol::Response *protocolResp);
     void getLogins(const KeepassHttpProtocol::Request &r, KeepassHttpProtocol::Response *protocolResp);
@@ -77,6 +107,8 @@ private:
     bool m_started;
 
     QHttpServer* m_server;
+    QThreadPool m_threadPool;
+    QHash<QObject*, QList<PendingResponse>> m_pendingResponses;
 };
 
 }   /*namespace KeepassHttpProtocol*/
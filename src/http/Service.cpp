@@ -17,6 +17,7 @@
 */
 
 #include <QInputDialog>
+#include <QMap>
 #include <QMessageBox>
 #include <QProgressDialog>
 
@@ -30,13 +31,13 @@
 #include "core/Entry.h"
 #include "core/Global.h"
 #include "core/Group.h"
-#include "core/EntrySearcher.h"
+#include "core/EntryHostIndex.h"
+#include "core/EntryRanker.h"
 #include "core/Metadata.h"
+#include "core/PublicSuffixList.h"
 #include "core/Uuid.h"
 #include "core/PasswordGenerator.h"
 
-#include <algorithm>
-
 static const unsigned char KEEPASSHTTP_UUID_DATA[] = {
     0x34, 0x69, 0x7a, 0x40, 0x8a, 0x5b, 0x41, 0xc0,
     0x9f, 0x36, 0x89, 0x7d, 0x62, 0x3e, 0xcb, 0x31
@@ -46,16 +47,26 @@ static const char KEEPASSHTTP_NAME[] = "KeePassHttp Settings";
 static const char ASSOCIATE_KEY_PREFIX[] = "AES Key: ";
 static const char KEEPASSHTTP_GROUP_NAME[] = "KeePassHttp Passwords";   //Group where new KeePassHttp password are stored
 static int        KEEPASSHTTP_DEFAULT_ICON = 1;
+
 //private const int DEFAULT_NOTIFICATION_TIME = 5000;
 
 Service::Service(DatabaseTabWidget* parent) :
     KeepassHttpProtocol::Server(parent),
-    m_dbTabWidget(parent)
+    m_dbTabWidget(parent),
+    m_dispatcher(this)
 {
+    qRegisterMetaType<QList<KeepassHttpProtocol::Entry>>("QList<KeepassHttpProtocol::Entry>");
+
     if (HttpSettings::isEnabled())
         start();
 }
 
+Service::~Service()
+{
+    //Running requests call back into this service
+    stop();
+}
+
 Entry* Service::getConfigEntry(bool create)
 {
     if (DatabaseWidget * dbWidget = m_dbTabWidget->currentDatabaseWidget())
@@ -78,8 +89,15 @@ Entry* Service::getConfigEntry(bool create)
     return NULL;
 }
 
+// The server answers requests on worker threads, everything touching the
+// databases or the UI is forwarded to the GUI thread.
+
 bool Service::isDatabaseOpened() const
 {
+    bool result = false;
+    if (m_dispatcher.dispatch("isDatabaseOpened", GuiThreadDispatcher::Shared, Q_RETURN_ARG(bool, result)))
+        return result;
+
     if (DatabaseWidget* dbWidget = m_dbTabWidget->currentDatabaseWidget())
         switch(dbWidget->currentMode()) {
         case DatabaseWidget::None:
@@ -97,6 +115,10 @@ bool Service::isDatabaseOpened() const
 
 bool Service::openDatabase()
 {
+    bool result = false;
+    if (m_dispatcher.dispatch("openDatabase", GuiThreadDispatcher::Exclusive, Q_RETURN_ARG(bool, result)))
+        return result;
+
     if (!HttpSettings::unlockDatabase())
         return false;
     if (DatabaseWidget * dbWidget = m_dbTabWidget->currentDatabaseWidget()) {
@@ -123,6 +145,10 @@ bool Service::openDatabase()
 
 QString Service::getDatabaseRootUuid()
 {
+    QString result;
+    if (m_dispatcher.dispatch("getDatabaseRootUuid", GuiThreadDispatcher::Shared, Q_RETURN_ARG(QString, result)))
+        return result;
+
     if (DatabaseWidget* dbWidget = m_dbTabWidget->currentDatabaseWidget())
         if (Database* db = dbWidget->database())
             if (Group* rootGroup = db->rootGroup())
@@ -132,6 +158,10 @@ QString Service::getDatabaseRootUuid()
 
 QString Service::getDatabaseRecycleBinUuid()
 {
+    QString result;
+    if (m_dispatcher.dispatch("getDatabaseRecycleBinUuid", GuiThreadDispatcher::Shared, Q_RETURN_ARG(QString, result)))
+        return result;
+
     if (DatabaseWidget* dbWidget = m_dbTabWidget->currentDatabaseWidget())
         if (Database* db = dbWidget->database())
             if (Group* recycleBin = db->metadata()->recycleBin())
@@ -141,6 +171,11 @@ QString Service::getDatabaseRecycleBinUuid()
 
 QString Service::getKey(const QString &id)
 {
+    QString result;
+    if (m_dispatcher.dispatch("getKey", GuiThreadDispatcher::Shared, Q_RETURN_ARG(QString, result),
+                              Q_ARG(const QString&, id)))
+        return result;
+
     if (Entry* config = getConfigEntry())
         return config->attributes()->value(QLatin1String(ASSOCIATE_KEY_PREFIX) + id);
     return QString();
@@ -149,6 +184,10 @@ QString Service::getKey(const QString &id)
 QString Service::storeKey(const QString &key)
 {
     QString id;
+    if (m_dispatcher.dispatch("storeKey", GuiThreadDispatcher::Exclusive, Q_RETURN_ARG(QString, id),
+                              Q_ARG(const QString&, key)))
+        return id;
+
     if (Entry* config = getConfigEntry(true)) {
 
         //ShowNotification("New key association requested")
@@ -178,42 +217,11 @@ QString Service::storeKey(const QString &key)
     return id;
 }
 
-bool Service::matchUrlScheme(const QString & url)
-{
-    QString str = url.left(8).toLower();
-    return str.startsWith("http://") ||
-           str.startsWith("https://") ||
-           str.startsWith("ftp://") ||
-           str.startsWith("ftps://");
-}
-
-bool Service::removeFirstDomain(QString & hostname)
-{
-    int pos = hostname.indexOf(".");
-    if (pos < 0)
-        return false;
-    hostname = hostname.mid(pos + 1);
-    return !hostname.isEmpty();
-}
-
 QList<Entry*> Service::searchEntries(Database* db, const QString& hostname)
 {
-    QList<Entry*> entries;
-    if (Group* rootGroup = db->rootGroup()) {
-        const auto results = EntrySearcher().search(hostname, rootGroup, Qt::CaseInsensitive);
-        for (Entry* entry: results) {
-            QString title = entry->title();
-            QString url = entry->webUrl();
-
-            //Filter to match hostname in Title and Url fields
-            if (   (!title.isEmpty() && hostname.contains(title))
-                || (!url.isEmpty() && hostname.contains(url))
-                || (matchUrlScheme(title) && hostname.endsWith(QUrl(title).host()))
-                || (matchUrlScheme(url) && hostname.endsWith(QUrl(url).host())) )
-                entries.append(entry);
-        }
-    }
-    return entries;
+    if (!db->rootGroup())
+        return QList<Entry*>();
+    return db->hostIndex()->entries(hostname);
 }
 
 QList<Entry*> Service::searchEntries(const QString& text)
@@ -231,14 +239,14 @@ QList<Entry*> Service::searchEntries(const QString& text)
             databases << db;
     }
 
-    //Search entries matching the hostname
-    QString hostname = QUrl(text).host();
+    //Search entries matching the hostname or any of its parent domains,
+    //never going past the registrable domain
+    const QStringList hostnames = publicSuffixList()->hostLevels(QUrl(text).host());
     QList<Entry*> entries;
-    do {
-        for (Database* db: asConst(databases)) {
-            entries << searchEntries(db, hostname);
-        }
-    } while(entries.isEmpty() && removeFirstDomain(hostname));
+    for (Database* db: asConst(databases)) {
+        if (db->rootGroup())
+            entries << db->hostIndex()->entries(hostnames);
+    }
 
     return entries;
 }
@@ -275,61 +283,15 @@ KeepassHttpProtocol::Entry Service::prepareEntry(const Entry* entry)
     return res;
 }
 
-int Service::sortPriority(const Entry* entry, const QString& host, const QString& submitUrl, const QString& baseSubmitUrl) const
+QList<KeepassHttpProtocol::Entry> Service::findMatchingEntries(const QString& id, const QString& url, const QString& submitUrl, const QString& realm)
 {
-    QUrl url(entry->url());
-    if (url.scheme().isEmpty())
-        url.setScheme("http");
-    const QString entryURL = url.toString(QUrl::StripTrailingSlash);
-    const QString baseEntryURL = url.toString(QUrl::StripTrailingSlash | QUrl::RemovePath | QUrl::RemoveQuery | QUrl::RemoveFragment);
-
-    if (submitUrl == entryURL)
-        return 100;
-    if (submitUrl.startsWith(entryURL) && entryURL != host && baseSubmitUrl != entryURL)
-        return 90;
-    if (submitUrl.startsWith(baseEntryURL) && entryURL != host && baseSubmitUrl != baseEntryURL)
-        return 80;
-    if (entryURL == host)
-        return 70;
-    if (entryURL == baseSubmitUrl)
-        return 60;
-    if (entryURL.startsWith(submitUrl))
-        return 50;
-    if (entryURL.startsWith(baseSubmitUrl) && baseSubmitUrl != host)
-        return 40;
-    if (submitUrl.startsWith(entryURL))
-        return 30;
-    if (submitUrl.startsWith(baseEntryURL))
-        return 20;
-    if (entryURL.startsWith(host))
-        return 10;
-    if (host.startsWith(entryURL))
-        return 5;
-    return 0;
-}
-
-class Service::SortEntries
-{
-public:
-    SortEntries(const QHash<const Entry*, int>& priorities, const QString & field):
-        m_priorities(priorities), m_field(field)
-    {}
-
-    bool operator()(const Entry* left, const Entry* right) const
-    {
-        int res = m_priorities.value(left) - m_priorities.value(right);
-        if (res == 0)
-            return QString::localeAwareCompare(left->attributes()->value(m_field), right->attributes()->value(m_field)) < 0;
-        return res < 0;
-    }
-
-private:
-    const QHash<const Entry*, int>& m_priorities;
-    const QString m_field;
-};
+    QList<KeepassHttpProtocol::Entry> result;
+    if (m_dispatcher.dispatch("findMatchingEntries", GuiThreadDispatcher::Exclusive,
+                              Q_RETURN_ARG(QList<KeepassHttpProtocol::Entry>, result),
+                              Q_ARG(const QString&, id), Q_ARG(const QString&, url),
+                              Q_ARG(const QString&, submitUrl), Q_ARG(const QString&, realm)))
+        return result;
 
-QList<KeepassHttpProtocol::Entry> Service::findMatchingEntries(const QString& /*id*/, const QString& url, const QString& submitUrl, const QString& realm)
-{
     const bool alwaysAllowAccess = HttpSettings::alwaysAllowAccess();
     const QString host = QUrl(url).host();
     const QString submitHost = QUrl(submitUrl).host();
@@ -370,7 +332,11 @@ QList<KeepassHttpProtocol::Entry> Service::findMatchingEntries(const QString& /*
         dlg.setItems(pwEntriesToConfirm);
         //dlg.setRemember();        //TODO: setting!
 
+        const QList<QPointer<Entry>> allowedEntries = GuiThreadDispatcher::guardEntries(pwEntries);
+        const QList<QPointer<Entry>> confirmEntries = GuiThreadDispatcher::guardEntries(pwEntriesToConfirm);
         int res = dlg.exec();
+        pwEntries = GuiThreadDispatcher::liveEntries(allowedEntries);
+        pwEntriesToConfirm = GuiThreadDispatcher::liveEntries(confirmEntries);
         if (dlg.remember()) {
             for (Entry* entry: asConst(pwEntriesToConfirm)) {
                 EntryConfig config;
@@ -396,21 +362,7 @@ QList<KeepassHttpProtocol::Entry> Service::findMatchingEntries(const QString& /*
     //Sort results
     const bool sortSelection = true;
     if (sortSelection) {
-        QUrl url(submitUrl);
-        if (url.scheme().isEmpty())
-            url.setScheme("http");
-        const QString submitUrl = url.toString(QUrl::StripTrailingSlash);
-        const QString baseSubmitURL = url.toString(QUrl::StripTrailingSlash | QUrl::RemovePath | QUrl::RemoveQuery | QUrl::RemoveFragment);
-
-        //Cache priorities
-        QHash<const Entry*, int> priorities;
-        priorities.reserve(pwEntries.size());
-        for (const Entry* entry: asConst(pwEntries)) {
-            priorities.insert(entry, sortPriority(entry, host, submitUrl, baseSubmitURL));
-        }
-
-        //Sort by priorities
-        std::sort(pwEntries.begin(), pwEntries.end(), SortEntries(priorities, HttpSettings::sortByTitle() ? "Title" : "UserName"));
+        pwEntries = EntryRanker(host, submitUrl).sort(pwEntries, HttpSettings::sortByTitle() ? "Title" : "UserName");
     }
 
     //Fill the list
@@ -422,24 +374,65 @@ QList<KeepassHttpProtocol::Entry> Service::findMatchingEntries(const QString& /*
     return result;
 }
 
-int Service::countMatchingEntries(const QString &, const QString &url, const QString &, const QString &)
+int Service::countMatchingEntries(const QString &id, const QString &url, const QString &submitUrl, const QString &realm)
 {
+    int result = 0;
+    if (m_dispatcher.dispatch("countMatchingEntries", GuiThreadDispatcher::Shared, Q_RETURN_ARG(int, result),
+                              Q_ARG(const QString&, id), Q_ARG(const QString&, url),
+                              Q_ARG(const QString&, submitUrl), Q_ARG(const QString&, realm)))
+        return result;
+
     return searchEntries(url).count();
 }
 
-QList<KeepassHttpProtocol::Entry> Service::searchAllEntries(const QString &)
+/**
+ * Entries with a URL, at most limit of them, in the order of their UUIDs and
+ * starting after the UUID given as a hex string (from the first if empty).
+ * Paging by UUID instead of by position means entries added, moved or
+ * deleted between two pages never make a client skip or see an entry twice.
+ * Each page is a single pass over the database that keeps only the page.
+ */
+QList<KeepassHttpProtocol::Entry> Service::searchAllEntries(const QString &id, const QString &after, int limit)
 {
     QList<KeepassHttpProtocol::Entry> result;
+    if (m_dispatcher.dispatch("searchAllEntries", GuiThreadDispatcher::Shared,
+                              Q_RETURN_ARG(QList<KeepassHttpProtocol::Entry>, result),
+                              Q_ARG(const QString&, id), Q_ARG(const QString&, after), Q_ARG(int, limit)))
+        return result;
+
+    if (limit <= 0)
+        return result;
+
     if (DatabaseWidget* dbWidget = m_dbTabWidget->currentDatabaseWidget()) {
         if (Database* db = dbWidget->database()) {
             if (Group* rootGroup = db->rootGroup()) {
-                const auto entries = rootGroup->entriesRecursive();
-                for (Entry* entry: entries) {
-                    if (!entry->url().isEmpty() || QUrl(entry->title()).isValid()) {
-                        result << KeepassHttpProtocol::Entry(entry->title(), entry->username(),
-                                                             QString(), entry->uuid().toHex());
+                QMap<QString, const Entry*> page;
+                QList<const Group*> groups;
+                groups << rootGroup;
+                while (!groups.isEmpty()) {
+                    const Group* group = groups.takeLast();
+                    for (const Entry* entry: group->entries()) {
+                        if (entry->url().isEmpty() && !QUrl(entry->title()).isValid())
+                            continue;
+                        const QString uuid = entry->uuid().toHex();
+                        if (uuid <= after)
+                            continue;
+                        //Keep the first limit UUIDs seen so far
+                        if (page.size() == limit) {
+                            if (uuid >= page.lastKey())
+                                continue;
+                            page.erase(--page.end());
+                        }
+                        page.insert(uuid, entry);
                     }
+                    for (const Group* child: group->children())
+                        groups << child;
                 }
+
+                result.reserve(page.size());
+                for (const Entry* entry: page)
+                    result << KeepassHttpProtocol::Entry(entry->title(), entry->username(),
+                                                         QString(), entry->uuid().toHex());
             }
         }
     }
@@ -472,8 +465,14 @@ Group * Service::findCreateAddEntryGroup()
     return NULL;
 }
 
-void Service::addEntry(const QString &, const QString &login, const QString &password, const QString &url, const QString &submitUrl, const QString &realm)
+void Service::addEntry(const QString &id, const QString &login, const QString &password, const QString &url, const QString &submitUrl, const QString &realm)
 {
+    if (m_dispatcher.dispatch("addEntry", GuiThreadDispatcher::Exclusive, QGenericReturnArgument(),
+                              Q_ARG(const QString&, id), Q_ARG(const QString&, login),
+                              Q_ARG(const QString&, password), Q_ARG(const QString&, url),
+                              Q_ARG(const QString&, submitUrl), Q_ARG(const QString&, realm)))
+        return;
+
     if (Group * group = findCreateAddEntryGroup()) {
         Entry * entry = new Entry();
         entry->setUuid(Uuid::random());
@@ -496,8 +495,14 @@ void Service::addEntry(const QString &, const QString &login, const QString &pas
     }
 }
 
-void Service::updateEntry(const QString &, const QString &uuid, const QString &login, const QString &password, const QString &url)
+void Service::updateEntry(const QString &id, const QString &uuid, const QString &login, const QString &password, const QString &url)
 {
+    if (m_dispatcher.dispatch("updateEntry", GuiThreadDispatcher::Exclusive, QGenericReturnArgument(),
+                              Q_ARG(const QString&, id), Q_ARG(const QString&, uuid),
+                              Q_ARG(const QString&, login), Q_ARG(const QString&, password),
+                              Q_ARG(const QString&, url)))
+        return;
+
     if (DatabaseWidget * dbWidget = m_dbTabWidget->currentDatabaseWidget())
         if (Database * db = dbWidget->database())
             if (Entry * entry = db->resolveEntry(Uuid::fromHex(uuid))) {
@@ -20,8 +20,10 @@
 #define SERVICE_H
 
 #include <QObject>
+#include "core/GuiThreadDispatcher.h"
 #include "gui/DatabaseTabWidget.h"
 #include "Server.h"
+#include "Protocol.h"
 
 class Service : public KeepassHttpProtocol::Server
 {
@@ -29,7 +31,9 @@ class Service : public KeepassHttpProtocol::Server
 
 public:
     explicit Service(DatabaseTabWidget* parent = 0);
+    ~Service();
 
+public slots:
     virtual bool isDatabaseOpened() const;
     virtual bool openDatabase();
     virtual QString getDatabaseRootUuid();
@@ -38,29 +42,25 @@ public:
     virtual QString storeKey(const QString& key);
     virtual QList<KeepassHttpProtocol::Entry> findMatchingEntries(const QString& id, const QString& url, const QString&  submitUrl, const QString&  realm);
     virtual int countMatchingEntries(const QString& id, const QString& url, const QString&  submitUrl, const QString&  realm);
-    virtual QList<KeepassHttpProtocol::Entry> searchAllEntries(const QString& id);
+    virtual QList<KeepassHttpProtocol::Entry> searchAllEntries(const QString& id, const QString& after, int limit);
     virtual void addEntry(const QString& id, const QString& login, const QString& password, const QString& url, const QString& submitUrl, const QString& realm);
     virtual void updateEntry(const QString& id, const QString& uuid, const QString& login, const QString& password, const QString& url);
     virtual QString generatePassword();
 
-public slots:
     void removeSharedEncryptionKeys();
     void removeStoredPermissions();
 
 private:
     enum Access { Denied, Unknown, Allowed};
     Entry* getConfigEntry(bool create = false);
-    bool matchUrlScheme(const QString& url);
     Access checkAccess(const Entry* entry, const QString&  host, const QString&  submitHost, const QString&  realm);
-    bool removeFirstDomain(QString& hostname);
     Group *findCreateAddEntryGroup();
-    class SortEntries;
-    int sortPriority(const Entry *entry, const QString &host, const QString &submitUrl, const QString &baseSubmitUrl) const;
     KeepassHttpProtocol::Entry prepareEntry(const Entry* entry);
     QList<Entry*> searchEntries(Database* db, const QString& hostname);
     QList<Entry*> searchEntries(const QString& text);
 
     DatabaseTabWidget * const m_dbTabWidget;
+    GuiThreadDispatcher m_dispatcher;
 };
 
 #endif // SERVICE_H
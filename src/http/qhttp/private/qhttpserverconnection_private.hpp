@@ -20,6 +20,7 @@
 
 #include <QBasicTimer>
 #include <QFile>
+#include <QPointer>
 ///////////////////////////////////////////////////////////////////////////////
 namespace qhttp {
 namespace server {
@@ -185,10 +186,12 @@ protected:
 
     QByteArray             itempUrl;
 
-    // Since there can only be one request/response pair per connection at any
-    // time even with pipelining.
+    // Only the last request is parsed at any time, but with pipelining
+    // earlier responses may still be pending and are owned by the connection.
     QHttpRequest*          ilastRequest  = nullptr;
-    QHttpResponse*         ilastResponse = nullptr;
+    QPointer<QHttpResponse> ilastResponse;
+    // responses not ended yet, the idle time out is paused while there are any
+    int                    ipendingResponses = 0;
 
     TServerHandler         ihandler      = nullptr;
 
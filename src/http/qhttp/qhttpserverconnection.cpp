@@ -156,22 +156,34 @@ QHttpConnectionPrivate::headersComplete(http_parser* parser) {
         ilastRequest->d_func()->iremotePort    = 0; // not used in local sockets
     }
 
-    if ( ilastResponse )
-        ilastResponse->deleteLater();
+    // a pipelined request may arrive before the previous response has been
+    // sent. responses delete themselves when done, or with the connection.
     ilastResponse  = new QHttpResponse(q_func());
 
-    if ( parser->http_major < 1 || parser->http_minor < 1  )
-        ilastResponse->d_func()->ikeepAlive = false;
+    // HTTP/1.1 connections persist unless the client asked to close, HTTP/1.0
+    // ones only with "Connection: keep-alive"
+    if ( http_should_keep_alive(parser) )
+        ilastResponse->addHeader("connection", "keep-alive");
 
     // close the connection if response was the last packet
-    QObject::connect(ilastResponse, &QHttpResponse::done, [this](bool wasTheLastPacket){
+    QHttpResponse* response = ilastResponse;
+    QObject::connect(response, &QHttpResponse::done, [this, response](bool wasTheLastPacket){
         ikeepAlive = !wasTheLastPacket;
+        response->deleteLater();
         if ( wasTheLastPacket ) {
             isocket.flush();
             isocket.close();
+        } else if ( --ipendingResponses == 0  &&  itimeOut > 0 ) {
+            // idle again, start counting from the last reply
+            itimer.start(itimeOut, Qt::CoarseTimer, q_func());
         }
     });
 
+    // the time out applies to idle keep-alive connections only, a reply that
+    // takes long (e.g. waiting for the user) must not kill the connection
+    ++ipendingResponses;
+    itimer.stop();
+
     // we are good to go!
     if ( ihandler )
         ihandler(ilastRequest, ilastResponse);
@@ -0,0 +1,59 @@
+/*
+*  Copyright (C) 2017 KeePassXC Team <team@keepassxc.org>
+*
+*  This program is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This program is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "NativeMessageRelay.h"
+
+NativeMessageRelay::NativeMessageRelay(QLocalSocket* socket, QObject* parent) :
+    QObject(parent),
+    m_localSocket(socket),
+    m_relayBuffer(RelayBufferSize)
+{
+    connect(m_localSocket, SIGNAL(connected()), this, SLOT(socketConnected()));
+    connect(m_localSocket, SIGNAL(readyRead()), this, SLOT(newLocalMessage()));
+}
+
+void NativeMessageRelay::relayStdIn(const QByteArray& data)
+{
+    if (m_localSocket && m_localSocket->state() == QLocalSocket::ConnectedState) {
+        m_localSocket->write(data);
+        m_localSocket->flush();
+    } else {
+        // Keep messages sent before the connection is up
+        m_pendingData.append(data);
+    }
+}
+
+void NativeMessageRelay::socketConnected()
+{
+    if (!m_pendingData.isEmpty()) {
+        m_localSocket->write(m_pendingData);
+        m_localSocket->flush();
+        m_pendingData.clear();
+    }
+}
+
+void NativeMessageRelay::newLocalMessage()
+{
+    if (!m_localSocket) {
+        return;
+    }
+
+    qint64 bytes;
+    while ((bytes = m_localSocket->read(m_relayBuffer.data(), m_relayBuffer.size())) > 0) {
+        emit localMessage(m_relayBuffer.data(), bytes);
+    }
+}
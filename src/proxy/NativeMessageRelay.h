@@ -0,0 +1,57 @@
+/*
+*  Copyright (C) 2017 KeePassXC Team <team@keepassxc.org>
+*
+*  This program is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This program is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef NATIVEMESSAGERELAY_H
+#define NATIVEMESSAGERELAY_H
+
+#include <QLocalSocket>
+#include <QObject>
+#include <QPointer>
+#include <vector>
+
+/**
+ * Relays data between the browser side of keepassxc-proxy and the socket to
+ * KeePassXC. KeePassXC uses the same length-prefixed framing on the socket as
+ * the browser on stdin, so data is passed on as it arrives in both directions.
+ * Data from the browser is kept until the socket is connected.
+ */
+class NativeMessageRelay : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit NativeMessageRelay(QLocalSocket* socket, QObject* parent = nullptr);
+
+public slots:
+    void relayStdIn(const QByteArray& data);
+
+signals:
+    void localMessage(const char* data, qint64 size);
+
+private slots:
+    void socketConnected();
+    void newLocalMessage();
+
+private:
+    enum { RelayBufferSize = 64 * 1024 };
+
+    QPointer<QLocalSocket>  m_localSocket;
+    QByteArray              m_pendingData;
+    std::vector<char>       m_relayBuffer;
+};
+
+#endif // NATIVEMESSAGERELAY_H
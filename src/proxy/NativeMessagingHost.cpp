@@ -16,17 +16,21 @@
 */
 
 #include <QCoreApplication>
+#include <QThread>
 #include "NativeMessagingHost.h"
+#include "NativeMessageRelay.h"
 
-NativeMessagingHost::NativeMessagingHost() : NativeMessagingBase()
+NativeMessagingHost::NativeMessagingHost() :
+    NativeMessagingBase()
 {
     m_localSocket = new QLocalSocket();
+    m_relay = new NativeMessageRelay(m_localSocket, this);
+    connect(m_relay, SIGNAL(localMessage(const char*,qint64)), this, SLOT(writeLocalMessage(const char*,qint64)));
     m_localSocket->connectToServer(getLocalServerPath());
 #ifdef Q_OS_WIN
     m_running.store(true);
     m_future = QtConcurrent::run(this, static_cast<void(NativeMessagingHost::*)()>(&NativeMessagingHost::readNativeMessages));
 #endif
-    connect(m_localSocket, SIGNAL(readyRead()), this, SLOT(newLocalMessage()));
     connect(m_localSocket, SIGNAL(disconnected()), this, SLOT(deleteSocket()));
     connect(m_localSocket, SIGNAL(stateChanged(QLocalSocket::LocalSocketState)), this, SLOT(socketStateChanged(QLocalSocket::LocalSocketState)));
 }
@@ -38,44 +42,27 @@ NativeMessagingHost::~NativeMessagingHost()
 #endif
 }
 
-void NativeMessagingHost::readLength()
+void NativeMessagingHost::readStdIn(const char* data, qint64 size)
 {
-    quint32 length = 0;
-    std::cin.read(reinterpret_cast<char*>(&length), 4);
-    if (!std::cin.eof() && length > 0) {
-        readStdIn(length);
-    } else {
-    	QCoreApplication::quit();
+    if (thread() != QThread::currentThread()) {
+        // On Windows stdin is read on its own thread, the relay and its
+        // socket belong to the main thread
+        QMetaObject::invokeMethod(m_relay, "relayStdIn", Qt::QueuedConnection,
+                                  Q_ARG(QByteArray, QByteArray(data, static_cast<int>(size))));
+        return;
     }
+
+    m_relay->relayStdIn(QByteArray::fromRawData(data, static_cast<int>(size)));
 }
 
-void NativeMessagingHost::readStdIn(const quint32 length)
+void NativeMessagingHost::stdInClosed()
 {
-    if (length > 0) {
-        QByteArray arr;
-        arr.reserve(length);
-
-        for (quint32 i = 0; i < length; ++i) {
-            arr.append(getchar());
-        }
-
-        if (arr.length() > 0 && m_localSocket && m_localSocket->state() == QLocalSocket::ConnectedState) {
-            m_localSocket->write(arr.constData(), arr.length());
-            m_localSocket->flush();
-        }
-    }
+    QMetaObject::invokeMethod(QCoreApplication::instance(), "quit", Qt::QueuedConnection);
 }
 
-void NativeMessagingHost::newLocalMessage()
+void NativeMessagingHost::writeLocalMessage(const char* data, qint64 size)
 {
-    if (!m_localSocket || m_localSocket->bytesAvailable() <= 0) {
-        return;
-    }
-
-    QByteArray arr = m_localSocket->readAll();
-    if (!arr.isEmpty()) {
-       sendReply(arr);
-    }
+    writeStdOut(data, size);
 }
 
 void NativeMessagingHost::deleteSocket()
@@ -20,6 +20,8 @@
 
 #include "NativeMessagingBase.h"
 
+class NativeMessageRelay;
+
 class NativeMessagingHost : public NativeMessagingBase
 {
     Q_OBJECT
@@ -28,16 +30,19 @@ public:
     ~NativeMessagingHost();
 
 public slots:
-    void newLocalMessage();
     void deleteSocket();
     void socketStateChanged(QLocalSocket::LocalSocketState socketState);
 
+private slots:
+    void writeLocalMessage(const char* data, qint64 size);
+
 private:
-    void readLength();
-    void readStdIn(const quint32 length);
+    void readStdIn(const char* data, qint64 size);
+    void stdInClosed();
 
 private:
     QLocalSocket*                           m_localSocket;
+    NativeMessageRelay*                     m_relay;
 };
 
 #endif // NATIVEMESSAGINGHOST_H
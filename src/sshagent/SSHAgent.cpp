@@ -19,6 +19,9 @@
 #include "SSHAgent.h"
 #include "BinaryStream.h"
 #include "KeeAgentSettings.h"
+#include "core/Global.h"
+
+#include <QtConcurrent>
 
 #ifndef Q_OS_WIN
 #include <QtNetwork>
@@ -32,16 +35,18 @@ SSHAgent::SSHAgent(QObject* parent) : QObject(parent)
 {
 #ifndef Q_OS_WIN
     m_socketPath = QProcessEnvironment::systemEnvironment().value("SSH_AUTH_SOCK");
+    m_socket = new QLocalSocket(this);
 #endif
 }
 
 SSHAgent::~SSHAgent()
 {
-    for (QSet<OpenSSHKey> keys : m_keys.values()) {
-        for (OpenSSHKey key : keys) {
-            removeIdentity(key);
-        }
+    QList<QByteArray> requests;
+    for (const QSet<QByteArray>& keys : m_keys) {
+        requests.append(keys.toList());
     }
+
+    sendRequests(requests);
 }
 
 SSHAgent* SSHAgent::instance()
@@ -67,26 +72,28 @@ bool SSHAgent::isAgentRunning() const
 #endif
 }
 
-bool SSHAgent::sendMessage(const QByteArray& in, QByteArray& out) const
-{
 #ifndef Q_OS_WIN
-    QLocalSocket socket;
-    BinaryStream stream(&socket);
-
-    socket.connectToServer(m_socketPath);
-    if (!socket.waitForConnected(500)) {
-        return false;
+bool SSHAgent::connectAgent()
+{
+    if (m_socket->state() == QLocalSocket::ConnectedState) {
+        return true;
     }
 
-    stream.writeString(in);
-    stream.flush();
+    m_socket->abort();
+    m_socket->connectToServer(m_socketPath);
+    return m_socket->waitForConnected(500);
+}
+#endif
 
-    if (!stream.readString(out)) {
+bool SSHAgent::sendMessage(const QByteArray& in, QByteArray& out)
+{
+#ifndef Q_OS_WIN
+    QList<QByteArray> responses;
+    if (!sendMessages(QList<QByteArray>() << in, responses)) {
         return false;
     }
 
-    socket.close();
-
+    out = responses.first();
     return true;
 #else
     HWND hWnd = FindWindowA("Pageant", "Pageant");
@@ -142,13 +149,88 @@ bool SSHAgent::sendMessage(const QByteArray& in, QByteArray& out) const
 #endif
 }
 
+/**
+ * Send all requests before reading any reply. The agent answers in request
+ * order, so the replies are returned in the same order as the requests.
+ */
+bool SSHAgent::sendMessages(const QList<QByteArray>& in, QList<QByteArray>& out)
+{
+    out.clear();
+
+    if (in.isEmpty()) {
+        return true;
+    }
 
-bool SSHAgent::addIdentity(OpenSSHKey& key, quint32 lifetime, bool confirm) const
+#ifndef Q_OS_WIN
+    // the connection is kept open between calls, if the agent went away in the
+    // meantime resend the requests it did not answer on a fresh connection
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        if (!connectAgent()) {
+            return false;
+        }
+
+        BinaryStream stream(m_socket);
+
+        for (int i = out.size(); i < in.size(); ++i) {
+            stream.writeString(in.at(i));
+        }
+        stream.flush();
+
+        QByteArray response;
+        while (out.size() < in.size() && stream.readString(response)) {
+            out.append(response);
+        }
+
+        if (out.size() == in.size()) {
+            return true;
+        }
+
+        m_socket->abort();
+    }
+
+    return false;
+#else
+    // Pageant handles a single request per WM_COPYDATA message
+    for (const QByteArray& message : in) {
+        QByteArray response;
+        if (!sendMessage(message, response)) {
+            return false;
+        }
+        out.append(response);
+    }
+
+    return true;
+#endif
+}
+
+/**
+ * Send the requests in one go and return how many of them succeeded.
+ */
+int SSHAgent::sendRequests(const QList<QByteArray>& requests)
+{
+    QList<QByteArray> responses;
+    sendMessages(requests, responses);
+
+    int succeeded = 0;
+    for (const QByteArray& response : responses) {
+        if (isSuccess(response)) {
+            ++succeeded;
+        }
+    }
+
+    return succeeded;
+}
+
+QByteArray SSHAgent::addIdentityRequest(OpenSSHKey& key, quint32 lifetime, bool confirm)
 {
     QByteArray requestData;
     BinaryStream request(&requestData);
 
-    request.write((lifetime > 0 || confirm) ? SSH_AGENTC_ADD_ID_CONSTRAINED : SSH_AGENTC_ADD_IDENTITY);
+    if (lifetime > 0 || confirm) {
+        request.write(SSH_AGENTC_ADD_ID_CONSTRAINED);
+    } else {
+        request.write(SSH_AGENTC_ADD_IDENTITY);
+    }
     key.writePrivate(request);
 
     if (lifetime > 0) {
@@ -160,43 +242,65 @@ bool SSHAgent::addIdentity(OpenSSHKey& key, quint32 lifetime, bool confirm) cons
         request.write(SSH_AGENT_CONSTRAIN_CONFIRM);
     }
 
-    QByteArray responseData;
-    sendMessage(requestData, responseData);
-
-    if (responseData.length() < 1 || static_cast<quint8>(responseData[0]) != SSH_AGENT_SUCCESS) {
-        return false;
-    }
-
-    return true;
+    return requestData;
 }
 
-bool SSHAgent::removeIdentity(OpenSSHKey& key) const
+QByteArray SSHAgent::removeIdentityRequest(const QByteArray& publicKey)
 {
     QByteArray requestData;
     BinaryStream request(&requestData);
 
+    request.write(SSH_AGENTC_REMOVE_IDENTITY);
+    request.writeString(publicKey);
+
+    return requestData;
+}
+
+QByteArray SSHAgent::publicKeyBlob(OpenSSHKey& key)
+{
     QByteArray keyData;
     BinaryStream keyStream(&keyData);
     key.writePublic(keyStream);
 
-    request.write(SSH_AGENTC_REMOVE_IDENTITY);
-    request.writeString(keyData);
+    return keyData;
+}
+
+bool SSHAgent::isSuccess(const QByteArray& response)
+{
+    return response.length() >= 1 && static_cast<quint8>(response[0]) == SSH_AGENT_SUCCESS;
+}
 
+bool SSHAgent::addIdentity(OpenSSHKey& key, quint32 lifetime, bool confirm)
+{
     QByteArray responseData;
-    sendMessage(requestData, responseData);
+    sendMessage(addIdentityRequest(key, lifetime, confirm), responseData);
 
-    if (responseData.length() < 1 || static_cast<quint8>(responseData[0]) != SSH_AGENT_SUCCESS) {
-        return false;
+    return isSuccess(responseData);
+}
+
+bool SSHAgent::removeIdentity(OpenSSHKey& key)
+{
+    const QByteArray publicKey = publicKeyBlob(key);
+
+    // the key is read again the next time an entry wants it added or removed
+    for (auto it = m_keyCache.begin(); it != m_keyCache.end(); ++it) {
+        if (it->publicKey == publicKey) {
+            it->keyRevision.clear();
+            it->publicKey.clear();
+        }
     }
 
-    return true;
+    QByteArray responseData;
+    sendMessage(removeIdentityRequest(publicKey), responseData);
+
+    return isSuccess(responseData);
 }
 
 void SSHAgent::removeIdentityAtLock(const OpenSSHKey& key, const Uuid& uuid)
 {
     OpenSSHKey copy = key;
     copy.clearPrivate();
-    m_keys[uuid.toHex()].insert(copy);
+    m_keys[uuid.toHex()].insert(removeIdentityRequest(publicKeyBlob(copy)));
 }
 
 void SSHAgent::databaseModeChanged(DatabaseWidget::Mode mode)
@@ -207,72 +311,292 @@ void SSHAgent::databaseModeChanged(DatabaseWidget::Mode mode)
         return;
     }
 
-    Uuid uuid = widget->database()->uuid();
+    if (mode == DatabaseWidget::LockedMode) {
+        databaseLocked(widget->database());
+    } else if (mode == DatabaseWidget::ViewMode) {
+        databaseUnlocked(widget->database());
+    }
+}
+
+void SSHAgent::databaseCloseRequested()
+{
+    DatabaseWidget* widget = qobject_cast<DatabaseWidget*>(sender());
+
+    if (widget == nullptr) {
+        return;
+    }
+
+    databaseClosed(widget->database());
+}
 
-    if (mode == DatabaseWidget::LockedMode && m_keys.contains(uuid.toHex())) {
-        QSet<OpenSSHKey> keys = m_keys.take(uuid.toHex());
-        for (OpenSSHKey key : keys) {
-            removeIdentity(key);
+/**
+ * Send the remove requests collected for the database and drop the keys that
+ * are still being prepared for it.
+ */
+void SSHAgent::databaseLocked(Database* db)
+{
+    const QString uuid = db->uuid().toHex();
+
+    // keys still being decrypted for this database are dropped in keysPrepared()
+    m_pendingKeys.remove(uuid);
+
+    if (m_keys.contains(uuid)) {
+        sendRequests(m_keys.take(uuid).toList());
+    }
+
+    pruneKeyCache(db, false);
+}
+
+/**
+ * Like databaseLocked(), but also forget the cached keys of the database.
+ */
+void SSHAgent::databaseClosed(Database* db)
+{
+    databaseLocked(db);
+    pruneKeyCache(db, true);
+}
+
+/**
+ * Forget the cached keys of entries that were deleted or no longer have key
+ * settings, or of all entries of the database when it is closed.
+ */
+void SSHAgent::pruneKeyCache(Database* db, bool closing)
+{
+    const Uuid rootUuid = db->rootGroup()->uuid();
+    QSet<Uuid> stale = m_cachedEntries.take(rootUuid);
+
+    if (!closing) {
+        QSet<Uuid> current;
+        for (const Entry* e : db->rootGroup()->entriesRecursive()) {
+            if (e->attachments()->hasKey("KeeAgent.settings")) {
+                current.insert(e->uuid());
+            }
+        }
+
+        stale.subtract(current);
+        m_cachedEntries.insert(rootUuid, current);
+    }
+
+    for (const Uuid& entryUuid : asConst(stale)) {
+        m_keyCache.remove(entryUuid);
+    }
+}
+
+/**
+ * Prepare the keys of the database on a worker thread, they are added to the
+ * agent in keysPrepared().
+ */
+void SSHAgent::databaseUnlocked(Database* db)
+{
+    const QString uuid = db->uuid().toHex();
+
+    if (m_keys.contains(uuid) || m_pendingKeys.contains(uuid)) {
+        return;
+    }
+
+    pruneKeyCache(db, false);
+
+    QList<KeyJob> jobs;
+
+    for (Entry* e : db->rootGroup()->entriesRecursive()) {
+
+        if (db->metadata()->recycleBinEnabled()
+            && e->group() == db->metadata()->recycleBin()) {
+            continue;
+        }
+
+        if (!e->attachments()->hasKey("KeeAgent.settings")) {
+            continue;
+        }
+
+        // parsing the settings is skipped if the attachment did not change since the last unlock
+        const QByteArray settingsXml = e->attachments()->value("KeeAgent.settings");
+        CachedKey& cached = m_keyCache[e->uuid()];
+        if (cached.settingsXml != settingsXml) {
+            cached = CachedKey();
+            cached.settingsXml = settingsXml;
+            cached.settings.fromXml(settingsXml);
+        }
+
+        const KeeAgentSettings& settings = cached.settings;
+
+        if (!settings.allowUseOfSshKey()) {
+            continue;
+        }
+
+        KeyJob job;
+        job.entryUuid = e->uuid();
+        job.settings = settings;
+
+        if (settings.selectedType() == "attachment") {
+            job.keyData = e->attachments()->value(settings.attachmentName());
+            job.keyRevision = QCryptographicHash::hash(job.keyData, QCryptographicHash::Sha256);
+        } else if (!settings.fileName().isEmpty()) {
+            QFileInfo fileInfo(settings.fileName());
+            job.keyRevision = QString("%1:%2").arg(fileInfo.lastModified().toMSecsSinceEpoch())
+                                              .arg(fileInfo.size()).toLatin1();
         }
-    } else if (mode == DatabaseWidget::ViewMode && !m_keys.contains(uuid.toHex())) {
-        for (Entry* e : widget->database()->rootGroup()->entriesRecursive()) {
 
-            if (widget->database()->metadata()->recycleBinEnabled()
-                && e->group() == widget->database()->metadata()->recycleBin()) {
+        if (cached.keyRevision != job.keyRevision) {
+            cached.keyRevision = job.keyRevision;
+            cached.publicKey.clear();
+        }
+
+        if (!settings.addAtDatabaseOpen()) {
+            if (!settings.removeAtDatabaseClose()) {
                 continue;
             }
 
-            if (!e->attachments()->hasKey("KeeAgent.settings")) {
+            // nothing to decrypt, the cached public key is all we need
+            if (!cached.publicKey.isEmpty()) {
+                m_keys[uuid].insert(removeIdentityRequest(cached.publicKey));
                 continue;
             }
+        } else {
+            job.password = e->password();
+        }
 
-            KeeAgentSettings settings;
-            settings.fromXml(e->attachments()->value("KeeAgent.settings"));
+        jobs.append(job);
+    }
 
-            if (!settings.allowUseOfSshKey()) {
-                continue;
+    if (jobs.isEmpty()) {
+        return;
+    }
+
+    // parsing and decrypting keys can take seconds with a strong KDF
+    QFutureWatcher<QList<KeyRequests>>* watcher = new QFutureWatcher<QList<KeyRequests>>(this);
+    connect(watcher, SIGNAL(finished()), SLOT(keysPrepared()));
+    m_pendingKeys.insert(uuid, watcher);
+    watcher->setFuture(QtConcurrent::run(&SSHAgent::prepareKeys, jobs));
+}
+
+void SSHAgent::keysPrepared()
+{
+    QFutureWatcher<QList<KeyRequests>>* watcher = static_cast<QFutureWatcher<QList<KeyRequests>>*>(sender());
+    watcher->deleteLater();
+
+    const QString uuid = m_pendingKeys.key(watcher);
+    if (uuid.isEmpty()) {
+        // the database was locked before its keys were ready
+        return;
+    }
+    m_pendingKeys.remove(uuid);
+
+    QList<QByteArray> addRequests;
+    for (const KeyRequests& requests : watcher->result()) {
+        if (m_keyCache.contains(requests.entryUuid)) {
+            CachedKey& cached = m_keyCache[requests.entryUuid];
+            if (cached.keyRevision == requests.keyRevision) {
+                cached.publicKey = requests.publicKey;
             }
+        }
 
-            QByteArray keyData;
-            if (settings.selectedType() == "attachment") {
-                keyData = e->attachments()->value(settings.attachmentName());
-            } else if (!settings.fileName().isEmpty()) {
-                QFile file(settings.fileName());
+        if (!requests.removeRequest.isEmpty()) {
+            m_keys[uuid].insert(requests.removeRequest);
+        }
+        if (!requests.addRequest.isEmpty()) {
+            addRequests.append(requests.addRequest);
+        }
+    }
 
-                if (file.size() > 1024 * 1024) {
-                    continue;
-                }
+    sendRequests(addRequests);
+}
 
-                if (!file.open(QIODevice::ReadOnly)) {
-                    continue;
-                }
+class SSHAgent::KeyTask : public QRunnable
+{
+public:
+    KeyTask(const KeyJob& job, KeyRequests& result)
+        : m_job(job)
+        , m_result(result)
+    {
+    }
 
-                keyData = file.readAll();
-            }
+    void run() override
+    {
+        m_result = SSHAgent::prepareKey(m_job);
+    }
 
-            if (keyData.isEmpty()) {
-                continue;
-            }
+private:
+    const KeyJob& m_job;
+    KeyRequests& m_result;
+};
 
-            OpenSSHKey key;
+/**
+ * Prepare the keys of all jobs on a pool of at most MaxKeyThreads threads.
+ * The results are in the same order as the jobs.
+ */
+QList<SSHAgent::KeyRequests> SSHAgent::prepareKeys(const QList<KeyJob>& jobs)
+{
+    QVector<KeyRequests> results(jobs.size());
 
-            if (!key.parse(keyData)) {
-                continue;
-            }
+    if (jobs.size() == 1) {
+        results[0] = prepareKey(jobs.first());
+        return results.toList();
+    }
 
-            if (settings.removeAtDatabaseClose()) {
-                removeIdentityAtLock(key, uuid);
-            }
+    const int maxThreads = MaxKeyThreads;
+    QThreadPool pool;
+    pool.setMaxThreadCount(qBound(1, QThread::idealThreadCount(), maxThreads));
+
+    for (int i = 0; i < jobs.size(); ++i) {
+        pool.start(new KeyTask(jobs.at(i), results[i]));
+    }
+    pool.waitForDone();
 
-            if (settings.addAtDatabaseOpen() && key.openPrivateKey(e->password())) {
-                int lifetime = 0;
+    return results.toList();
+}
+
+/**
+ * Read, parse and decrypt the key of a single entry. Runs on a worker thread,
+ * so it only touches the copied entry data in job.
+ */
+SSHAgent::KeyRequests SSHAgent::prepareKey(const KeyJob& job)
+{
+    KeyRequests requests;
+    requests.entryUuid = job.entryUuid;
+    requests.keyRevision = job.keyRevision;
+    const KeeAgentSettings& settings = job.settings;
 
-                if (settings.useLifetimeConstraintWhenAdding()) {
-                    lifetime = settings.lifetimeConstraintDuration();
-                }
+    QByteArray keyData = job.keyData;
+    if (settings.selectedType() != "attachment" && !settings.fileName().isEmpty()) {
+        QFile file(settings.fileName());
 
-                addIdentity(key, lifetime, settings.useConfirmConstraintWhenAdding());
-            }
+        if (file.size() > 1024 * 1024) {
+            return requests;
+        }
+
+        if (!file.open(QIODevice::ReadOnly)) {
+            return requests;
+        }
+
+        keyData = file.readAll();
+    }
+
+    if (keyData.isEmpty()) {
+        return requests;
+    }
+
+    OpenSSHKey key;
+
+    if (!key.parse(keyData)) {
+        return requests;
+    }
+
+    requests.publicKey = publicKeyBlob(key);
+
+    if (settings.removeAtDatabaseClose()) {
+        requests.removeRequest = removeIdentityRequest(requests.publicKey);
+    }
+
+    if (settings.addAtDatabaseOpen() && key.openPrivateKey(job.password)) {
+        int lifetime = 0;
+
+        if (settings.useLifetimeConstraintWhenAdding()) {
+            lifetime = settings.lifetimeConstraintDuration();
         }
+
+        requests.addRequest = addIdentityRequest(key, lifetime, settings.useConfirmConstraintWhenAdding());
     }
+
+    return requests;
 }
@@ -21,10 +21,15 @@
 
 #include <QtCore>
 #include <QList>
+#include "KeeAgentSettings.h"
 #include "OpenSSHKey.h"
 
 #include "gui/DatabaseWidget.h"
 
+#ifndef Q_OS_WIN
+class QLocalSocket;
+#endif
+
 class SSHAgent : public QObject
 {
     Q_OBJECT
@@ -34,40 +39,100 @@ public:
     static void init(QObject* parent);
 
     bool isAgentRunning() const;
-    bool addIdentity(OpenSSHKey& key, quint32 lifetime = 0, bool confirm = false) const;
-    bool removeIdentity(OpenSSHKey& key) const;
+    bool addIdentity(OpenSSHKey& key, quint32 lifetime = 0, bool confirm = false);
+    bool removeIdentity(OpenSSHKey& key);
     void removeIdentityAtLock(const OpenSSHKey& key, const Uuid& uuid);
+    void databaseUnlocked(Database* db);
+    void databaseLocked(Database* db);
+    void databaseClosed(Database* db);
 
 public slots:
     void databaseModeChanged(DatabaseWidget::Mode mode = DatabaseWidget::LockedMode);
+    void databaseCloseRequested();
+
+private slots:
+    void keysPrepared();
 
 private:
-    const quint8 SSH_AGENT_FAILURE              = 5;
-    const quint8 SSH_AGENT_SUCCESS              = 6;
-    const quint8 SSH_AGENTC_REQUEST_IDENTITIES  = 11;
-    const quint8 SSH_AGENT_IDENTITIES_ANSWER    = 12;
-    const quint8 SSH_AGENTC_ADD_IDENTITY        = 17;
-    const quint8 SSH_AGENTC_REMOVE_IDENTITY     = 18;
-    const quint8 SSH_AGENTC_ADD_ID_CONSTRAINED  = 25;
+    static const quint8 SSH_AGENT_FAILURE              = 5;
+    static const quint8 SSH_AGENT_SUCCESS              = 6;
+    static const quint8 SSH_AGENTC_REQUEST_IDENTITIES  = 11;
+    static const quint8 SSH_AGENT_IDENTITIES_ANSWER    = 12;
+    static const quint8 SSH_AGENTC_ADD_IDENTITY        = 17;
+    static const quint8 SSH_AGENTC_REMOVE_IDENTITY     = 18;
+    static const quint8 SSH_AGENTC_ADD_ID_CONSTRAINED  = 25;
+
+    static const quint8 SSH_AGENT_CONSTRAIN_LIFETIME   = 1;
+    static const quint8 SSH_AGENT_CONSTRAIN_CONFIRM    = 2;
+
+    // upper limit of keys decrypted in parallel at database unlock
+    static const int MaxKeyThreads = 4;
 
-    const quint8 SSH_AGENT_CONSTRAIN_LIFETIME   = 1;
-    const quint8 SSH_AGENT_CONSTRAIN_CONFIRM    = 2;
+    // what databaseModeChanged() hands to the worker threads for one entry
+    struct KeyJob
+    {
+        Uuid entryUuid;
+        KeeAgentSettings settings;
+        QByteArray keyData;
+        QByteArray keyRevision;
+        QString password;
+    };
+
+    // agent requests for one entry, empty if the key should not be added or removed
+    struct KeyRequests
+    {
+        Uuid entryUuid;
+        QByteArray keyRevision;
+        QByteArray publicKey;
+        QByteArray addRequest;
+        QByteArray removeRequest;
+    };
+
+    // parsed settings and public key of an entry, valid as long as the
+    // settings attachment and the key revision don't change
+    struct CachedKey
+    {
+        QByteArray settingsXml;
+        KeeAgentSettings settings;
+        QByteArray keyRevision;
+        QByteArray publicKey;
+    };
+
+    class KeyTask;
 
     explicit SSHAgent(QObject* parent = nullptr);
     ~SSHAgent();
 
-    bool sendMessage(const QByteArray& in, QByteArray& out) const;
+    bool sendMessage(const QByteArray& in, QByteArray& out);
+    bool sendMessages(const QList<QByteArray>& in, QList<QByteArray>& out);
+    int sendRequests(const QList<QByteArray>& requests);
+
+    static QByteArray addIdentityRequest(OpenSSHKey& key, quint32 lifetime, bool confirm);
+    static QByteArray removeIdentityRequest(const QByteArray& publicKey);
+    static QByteArray publicKeyBlob(OpenSSHKey& key);
+    static bool isSuccess(const QByteArray& response);
+    static QList<KeyRequests> prepareKeys(const QList<KeyJob>& jobs);
+    static KeyRequests prepareKey(const KeyJob& job);
+    void pruneKeyCache(Database* db, bool closing);
 
     static SSHAgent* m_instance;
 
 #ifndef Q_OS_WIN
+    bool connectAgent();
+
     QString m_socketPath;
+    QLocalSocket* m_socket;
 #else
     const quint32 AGENT_MAX_MSGLEN = 8192;
     const quint32 AGENT_COPYDATA_ID = 0x804e50ba;
 #endif
 
-    QMap<QString, QSet<OpenSSHKey>> m_keys;
+    // remove requests to send when a database gets locked, by database uuid
+    QMap<QString, QSet<QByteArray>> m_keys;
+    QHash<QString, QFutureWatcher<QList<KeyRequests>>*> m_pendingKeys;
+    QHash<Uuid, CachedKey> m_keyCache;
+    // entries with cached keys, by root group uuid which stays the same across unlocks
+    QHash<Uuid, QSet<Uuid>> m_cachedEntries;
 };
 
 #endif // AGENTCLIENT_H
@@ -16,6 +16,7 @@
  */
 
 #include <QtCore>
+#include <QtConcurrent>
 
 extern "C" {
 #include "blf.h"
@@ -54,58 +55,260 @@ extern "C" {
 // FIXME: explicit_bzero exists to ensure bzero is not optimized out
 #define explicit_bzero bzero
 
+/*
+ * Blowfish_encipher() and Blowfish_expand0state() specialized for bcrypt_hash,
+ * which spends nearly all of its time in 128 state expansions with the same
+ * two 64 byte keys. The key words are extracted once instead of byte by byte
+ * on every expansion.
+ *
+ * Each expansion is a long chain of dependent S-box lookups, so a single
+ * state leaves most of the CPU idle waiting on loads. The independent output
+ * blocks of bcrypt_pbkdf are therefore hashed two at a time, interleaving the
+ * rounds of both states.
+ */
+#define BCRYPT_LANES 2
+
+#define BCRYPT_F(s, x) ((((s)[        (((x) >> 24) & 0xff)]  \
+                        + (s)[0x100 + (((x) >> 16) & 0xff)]) \
+                        ^ (s)[0x200 + (((x) >> 8) & 0xff)])  \
+                        + (s)[0x300 + ((x) & 0xff)])
+
+static inline void
+bcrypt_encipher(const quint32* s, const quint32* p, quint32& xl, quint32& xr)
+{
+    quint32 l = xl ^ p[0];
+    quint32 r = xr;
+
+    for (int i = 1; i < BLF_N + 1; i += 2) {
+        r ^= BCRYPT_F(s, l) ^ p[i];
+        l ^= BCRYPT_F(s, r) ^ p[i + 1];
+    }
+
+    xl = r ^ p[BLF_N + 1];
+    xr = l;
+}
+
+static inline void
+bcrypt_encipher2(const quint32* sa, const quint32* pa, quint32& xla, quint32& xra,
+                 const quint32* sb, const quint32* pb, quint32& xlb, quint32& xrb)
+{
+    quint32 la = xla ^ pa[0];
+    quint32 ra = xra;
+    quint32 lb = xlb ^ pb[0];
+    quint32 rb = xrb;
+
+    for (int i = 1; i < BLF_N + 1; i += 2) {
+        ra ^= BCRYPT_F(sa, la) ^ pa[i];
+        rb ^= BCRYPT_F(sb, lb) ^ pb[i];
+        la ^= BCRYPT_F(sa, ra) ^ pa[i + 1];
+        lb ^= BCRYPT_F(sb, rb) ^ pb[i + 1];
+    }
+
+    xla = ra ^ pa[BLF_N + 1];
+    xra = la;
+    xlb = rb ^ pb[BLF_N + 1];
+    xrb = lb;
+}
+
+static void
+bcrypt_keywords(const quint8* key, quint32* words)
+{
+    quint16 j = 0;
+    for (int i = 0; i < BLF_N + 2; i++) {
+        words[i] = Blowfish_stream2word(key, SHA512_DIGEST_LENGTH, &j);
+    }
+}
+
+static void
+bcrypt_expand0state(blf_ctx* state, const quint32* keywords)
+{
+    quint32* s = state->S[0];
+    quint32* p = state->P;
+    quint32 datal = 0;
+    quint32 datar = 0;
+
+    for (int i = 0; i < BLF_N + 2; i++) {
+        p[i] ^= keywords[i];
+    }
+
+    for (int i = 0; i < BLF_N + 2; i += 2) {
+        bcrypt_encipher(s, p, datal, datar);
+        p[i] = datal;
+        p[i + 1] = datar;
+    }
+
+    for (int k = 0; k < 4 * 256; k += 2) {
+        bcrypt_encipher(s, p, datal, datar);
+        s[k] = datal;
+        s[k + 1] = datar;
+    }
+}
+
 static void
-bcrypt_hash(const quint8* sha2pass, const quint8* sha2salt, quint8* out)
+bcrypt_expand0state2(blf_ctx* a, const quint32* keywordsa, blf_ctx* b, const quint32* keywordsb)
 {
-    blf_ctx state;
+    quint32* sa = a->S[0];
+    quint32* pa = a->P;
+    quint32* sb = b->S[0];
+    quint32* pb = b->P;
+    quint32 datala = 0;
+    quint32 datara = 0;
+    quint32 datalb = 0;
+    quint32 datarb = 0;
+
+    for (int i = 0; i < BLF_N + 2; i++) {
+        pa[i] ^= keywordsa[i];
+        pb[i] ^= keywordsb[i];
+    }
+
+    for (int i = 0; i < BLF_N + 2; i += 2) {
+        bcrypt_encipher2(sa, pa, datala, datara, sb, pb, datalb, datarb);
+        pa[i] = datala;
+        pa[i + 1] = datara;
+        pb[i] = datalb;
+        pb[i + 1] = datarb;
+    }
+
+    for (int k = 0; k < 4 * 256; k += 2) {
+        bcrypt_encipher2(sa, pa, datala, datara, sb, pb, datalb, datarb);
+        sa[k] = datala;
+        sa[k + 1] = datara;
+        sb[k] = datalb;
+        sb[k + 1] = datarb;
+    }
+}
+
+/*
+ * bcrypt_hash() of up to BCRYPT_LANES salts with the same password.
+ */
+static void
+bcrypt_hash(const quint8* sha2pass, const quint32* passwords,
+            const quint8* const* sha2salt, quint8* const* out, int lanes)
+{
+    blf_ctx state[BCRYPT_LANES];
     quint8 ciphertext[BCRYPT_HASHSIZE] = // "OxychromaticBlowfishSwatDynamite"
         { 0x4f, 0x78, 0x79, 0x63, 0x68, 0x72, 0x6f, 0x6d,
           0x61, 0x74, 0x69, 0x63, 0x42, 0x6c, 0x6f, 0x77,
           0x66, 0x69, 0x73, 0x68, 0x53, 0x77, 0x61, 0x74,
           0x44, 0x79, 0x6e, 0x61, 0x6d, 0x69, 0x74, 0x65 };
     quint32 cdata[BCRYPT_WORDS];
+    quint32 saltwords[BCRYPT_LANES][BLF_N + 2];
     int i;
+    int n;
     quint16 j;
     size_t shalen = SHA512_DIGEST_LENGTH;
 
     /* key expansion */
-    Blowfish_initstate(&state);
-    Blowfish_expandstate(&state, sha2salt, shalen, sha2pass, shalen);
+    for (n = 0; n < lanes; n++) {
+        Blowfish_initstate(&state[n]);
+        Blowfish_expandstate(&state[n], sha2salt[n], shalen, sha2pass, shalen);
+        bcrypt_keywords(sha2salt[n], saltwords[n]);
+    }
     for (i = 0; i < 64; i++) {
-        Blowfish_expand0state(&state, sha2salt, shalen);
-        Blowfish_expand0state(&state, sha2pass, shalen);
+        if (lanes == 2) {
+            bcrypt_expand0state2(&state[0], saltwords[0], &state[1], saltwords[1]);
+            bcrypt_expand0state2(&state[0], passwords, &state[1], passwords);
+        } else {
+            bcrypt_expand0state(&state[0], saltwords[0]);
+            bcrypt_expand0state(&state[0], passwords);
+        }
     }
 
-    /* encryption */
-    j = 0;
-    for (i = 0; i < BCRYPT_WORDS; i++)
-        cdata[i] = Blowfish_stream2word(ciphertext, sizeof(ciphertext),
-            &j);
-    for (i = 0; i < 64; i++)
-        blf_enc(&state, cdata, sizeof(cdata) / sizeof(uint64_t));
+    for (n = 0; n < lanes; n++) {
+        /* encryption */
+        j = 0;
+        for (i = 0; i < BCRYPT_WORDS; i++)
+            cdata[i] = Blowfish_stream2word(ciphertext, sizeof(ciphertext),
+                &j);
+        for (i = 0; i < 64; i++)
+            blf_enc(&state[n], cdata, sizeof(cdata) / sizeof(uint64_t));
 
-    /* copy out */
-    for (i = 0; i < BCRYPT_WORDS; i++) {
-        out[4 * i + 3] = (cdata[i] >> 24) & 0xff;
-        out[4 * i + 2] = (cdata[i] >> 16) & 0xff;
-        out[4 * i + 1] = (cdata[i] >> 8) & 0xff;
-        out[4 * i + 0] = cdata[i] & 0xff;
+        /* copy out */
+        for (i = 0; i < BCRYPT_WORDS; i++) {
+            out[n][4 * i + 3] = (cdata[i] >> 24) & 0xff;
+            out[n][4 * i + 2] = (cdata[i] >> 16) & 0xff;
+            out[n][4 * i + 1] = (cdata[i] >> 8) & 0xff;
+            out[n][4 * i + 0] = cdata[i] & 0xff;
+        }
     }
 
     /* zap */
     explicit_bzero(ciphertext, sizeof(ciphertext));
     explicit_bzero(cdata, sizeof(cdata));
-    explicit_bzero(&state, sizeof(state));
+    explicit_bzero(saltwords, sizeof(saltwords));
+    explicit_bzero(state, sizeof(state));
 }
 
-int bcrypt_pbkdf(const QByteArray& pass, const QByteArray& salt, QByteArray& key, quint32 rounds)
+/*
+ * Up to BCRYPT_LANES output blocks of bcrypt_pbkdf. The blocks only differ in
+ * the counter appended to the salt, so they are computed side by side, and
+ * separate groups can run on separate threads.
+ */
+struct bcrypt_blocks
+{
+    const QByteArray* sha2pass;
+    const quint32* passwords;
+    const QByteArray* salt;
+    quint32 rounds;
+    quint32 count;
+    int lanes;
+    quint8 out[BCRYPT_LANES][BCRYPT_HASHSIZE];
+};
+
+static void
+bcrypt_pbkdf_blocks(bcrypt_blocks& blocks)
 {
     QCryptographicHash ctx(QCryptographicHash::Sha512);
-    QByteArray sha2pass;
-    QByteArray sha2salt;
-    quint8 out[BCRYPT_HASHSIZE];
-    quint8 tmpout[BCRYPT_HASHSIZE];
+    const quint8* sha2pass = reinterpret_cast<const quint8 *>(blocks.sha2pass->constData());
+    QByteArray sha2salt[BCRYPT_LANES];
+    const quint8* sha2saltdata[BCRYPT_LANES];
+    quint8 tmpout[BCRYPT_LANES][BCRYPT_HASHSIZE];
+    quint8* tmpoutdata[BCRYPT_LANES];
     quint8 countsalt[4];
+    int n;
+
+    for (n = 0; n < blocks.lanes; n++) {
+        quint32 count = blocks.count + n;
+        countsalt[0] = (count >> 24) & 0xff;
+        countsalt[1] = (count >> 16) & 0xff;
+        countsalt[2] = (count >> 8) & 0xff;
+        countsalt[3] = count & 0xff;
+
+        /* first round, salt is salt */
+        ctx.reset();
+        ctx.addData(*blocks.salt);
+        ctx.addData(reinterpret_cast<char *>(countsalt), sizeof(countsalt));
+        sha2salt[n] = ctx.result();
+        sha2saltdata[n] = reinterpret_cast<const quint8 *>(sha2salt[n].constData());
+        tmpoutdata[n] = tmpout[n];
+    }
+
+    bcrypt_hash(sha2pass, blocks.passwords, sha2saltdata, tmpoutdata, blocks.lanes);
+    memcpy(blocks.out, tmpout, sizeof(blocks.out));
+
+    for (quint32 i = 1; i < blocks.rounds; i++) {
+        /* subsequent rounds, salt is previous output */
+        for (n = 0; n < blocks.lanes; n++) {
+            ctx.reset();
+            ctx.addData(reinterpret_cast<char *>(tmpout[n]), sizeof(tmpout[n]));
+            sha2salt[n] = ctx.result();
+            sha2saltdata[n] = reinterpret_cast<const quint8 *>(sha2salt[n].constData());
+        }
+        bcrypt_hash(sha2pass, blocks.passwords, sha2saltdata, tmpoutdata, blocks.lanes);
+        for (n = 0; n < blocks.lanes; n++) {
+            for (quint32 j = 0; j < BCRYPT_HASHSIZE; j++)
+                blocks.out[n][j] ^= tmpout[n][j];
+        }
+    }
+
+    /* zap */
+    explicit_bzero(tmpout, sizeof(tmpout));
+}
+
+int bcrypt_pbkdf(const QByteArray& pass, const QByteArray& salt, QByteArray& key, quint32 rounds)
+{
+    QByteArray sha2pass;
+    quint32 passwords[BLF_N + 2];
 
     /* nothing crazy */
     if (rounds < 1) {
@@ -113,43 +316,41 @@ int bcrypt_pbkdf(const QByteArray& pass, const QByteArray& salt, QByteArray& key
     }
 
     if (pass.isEmpty() || salt.isEmpty() || key.isEmpty() ||
-        static_cast<quint32>(key.length()) > sizeof(out) * sizeof(out)) {
+        static_cast<quint32>(key.length()) > BCRYPT_HASHSIZE * BCRYPT_HASHSIZE) {
         return -1;
     }
 
-    quint32 stride = (key.length() + sizeof(out) - 1) / sizeof(out);
+    quint32 stride = (key.length() + BCRYPT_HASHSIZE - 1) / BCRYPT_HASHSIZE;
     quint32 amt = (key.length() + stride - 1) / stride;
 
     /* collapse password */
-    ctx.reset();
-    ctx.addData(pass);
-    sha2pass = ctx.result();
+    sha2pass = QCryptographicHash::hash(pass, QCryptographicHash::Sha512);
+    bcrypt_keywords(reinterpret_cast<const quint8 *>(sha2pass.constData()), passwords);
 
-    /* generate key, sizeof(out) at a time */
-    for (quint32 count = 1, keylen = key.length(); keylen > 0; count++) {
-        countsalt[0] = (count >> 24) & 0xff;
-        countsalt[1] = (count >> 16) & 0xff;
-        countsalt[2] = (count >> 8) & 0xff;
-        countsalt[3] = count & 0xff;
-
-        /* first round, salt is salt */
-        ctx.reset();
-        ctx.addData(salt);
-        ctx.addData(reinterpret_cast<char *>(countsalt), sizeof(countsalt));
-        sha2salt = ctx.result();
+    /*
+     * The output loop below consumes exactly one block per stride, so all
+     * blocks are known up front and can be generated concurrently.
+     */
+    QVector<bcrypt_blocks> groups((stride + BCRYPT_LANES - 1) / BCRYPT_LANES);
+    for (int g = 0; g < groups.size(); g++) {
+        bcrypt_blocks& group = groups[g];
+        group.sha2pass = &sha2pass;
+        group.passwords = passwords;
+        group.salt = &salt;
+        group.rounds = rounds;
+        group.count = 1 + g * BCRYPT_LANES;
+        group.lanes = MINIMUM(BCRYPT_LANES, static_cast<int>(stride + 1 - group.count));
+    }
 
-        bcrypt_hash(reinterpret_cast<quint8 *>(sha2pass.data()), reinterpret_cast<quint8 *>(sha2salt.data()), tmpout);
-        memcpy(out, tmpout, sizeof(out));
+    if (groups.size() == 1) {
+        bcrypt_pbkdf_blocks(groups[0]);
+    } else {
+        QtConcurrent::blockingMap(groups, bcrypt_pbkdf_blocks);
+    }
 
-        for (quint32 i = 1; i < rounds; i++) {
-            /* subsequent rounds, salt is previous output */
-            ctx.reset();
-            ctx.addData(reinterpret_cast<char *>(tmpout), sizeof(tmpout));
-            sha2salt = ctx.result();
-            bcrypt_hash(reinterpret_cast<quint8 *>(sha2pass.data()), reinterpret_cast<quint8 *>(sha2salt.data()), tmpout);
-            for (quint32 j = 0; j < sizeof(out); j++)
-                out[j] ^= tmpout[j];
-        }
+    /* assemble the key from the blocks, BCRYPT_HASHSIZE at a time */
+    for (quint32 count = 1, keylen = key.length(); keylen > 0; count++) {
+        const quint8* out = groups.at((count - 1) / BCRYPT_LANES).out[(count - 1) % BCRYPT_LANES];
 
         /*
          * pbkdf2 deviation: output the key material non-linearly.
@@ -166,7 +367,11 @@ int bcrypt_pbkdf(const QByteArray& pass, const QByteArray& salt, QByteArray& key
     }
 
     /* zap */
-    explicit_bzero(out, sizeof(out));
+    for (bcrypt_blocks& group : groups) {
+        explicit_bzero(group.out, sizeof(group.out));
+    }
+    explicit_bzero(passwords, sizeof(passwords));
+    explicit_bzero(sha2pass.data(), sha2pass.size());
 
     return 0;
 }
@@ -26,6 +26,7 @@ HmacBlockStream::HmacBlockStream(QIODevice* baseDevice, QByteArray key)
     : LayeredStream(baseDevice)
     , m_blockSize(1024 * 1024)
     , m_key(key)
+    , m_hasher(CryptoHash::Sha256, true)
 {
     init();
 }
@@ -34,6 +35,7 @@ HmacBlockStream::HmacBlockStream(QIODevice* baseDevice, QByteArray key, qint32 b
     : LayeredStream(baseDevice)
     , m_blockSize(blockSize)
     , m_key(key)
+    , m_hasher(CryptoHash::Sha256, true)
 {
     init();
 }
@@ -153,13 +155,13 @@ bool HmacBlockStream::readHashedBlock()
         return false;
     }
 
-    CryptoHash hasher(CryptoHash::Sha256, true);
-    hasher.setKey(getCurrentHmacKey());
-    hasher.addData(Endian::sizedIntToBytes<quint64>(m_blockIndex, ByteOrder));
-    hasher.addData(blockSizeBytes);
-    hasher.addData(m_buffer);
+    // setKey() also resets the reused context
+    m_hasher.setKey(getCurrentHmacKey());
+    m_hasher.addData(Endian::sizedIntToBytes<quint64>(m_blockIndex, ByteOrder));
+    m_hasher.addData(blockSizeBytes);
+    m_hasher.addData(m_buffer);
 
-    if (hmac != hasher.result()) {
+    if (hmac != m_hasher.result()) {
         m_error = true;
         setErrorString("Mismatch between hash and data.");
         return false;
@@ -208,12 +210,11 @@ qint64 HmacBlockStream::writeData(const char* data, qint64 maxSize)
 
 bool HmacBlockStream::writeHashedBlock()
 {
-    CryptoHash hasher(CryptoHash::Sha256, true);
-    hasher.setKey(getCurrentHmacKey());
-    hasher.addData(Endian::sizedIntToBytes<quint64>(m_blockIndex, ByteOrder));
-    hasher.addData(Endian::sizedIntToBytes<qint32>(m_buffer.size(), ByteOrder));
-    hasher.addData(m_buffer);
-    QByteArray hash = hasher.result();
+    m_hasher.setKey(getCurrentHmacKey());
+    m_hasher.addData(Endian::sizedIntToBytes<quint64>(m_blockIndex, ByteOrder));
+    m_hasher.addData(Endian::sizedIntToBytes<qint32>(m_buffer.size(), ByteOrder));
+    m_hasher.addData(m_buffer);
+    QByteArray hash = m_hasher.result();
 
     if (m_baseDevice->write(hash) != hash.size()) {
         m_error = true;
@@ -249,10 +250,7 @@ QByteArray HmacBlockStream::getHmacKey(quint64 blockIndex, QByteArray key)
 {
     Q_ASSERT(key.size() == 64);
     QByteArray indexBytes = Endian::sizedIntToBytes<quint64>(blockIndex, ByteOrder);
-    CryptoHash hasher(CryptoHash::Sha512);
-    hasher.addData(indexBytes);
-    hasher.addData(key);
-    return hasher.result();
+    return CryptoHash::hash(QList<QByteArray>() << indexBytes << key, CryptoHash::Sha512);
 }
 
 bool HmacBlockStream::atEnd() const
@@ -20,6 +20,7 @@
 
 #include <QSysInfo>
 
+#include "crypto/CryptoHash.h"
 #include "streams/LayeredStream.h"
 
 class HmacBlockStream: public LayeredStream
@@ -52,6 +53,7 @@ private:
     qint32 m_blockSize;
     QByteArray m_buffer;
     QByteArray m_key;
+    CryptoHash m_hasher;
     int m_bufferPos;
     quint64 m_blockIndex;
     bool m_eof;
@@ -0,0 +1,188 @@
+/*
+ *  Copyright (C) 2017 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "TotpService.h"
+
+#include <QDateTime>
+
+#include "core/Entry.h"
+#include "core/Global.h"
+#include "totp/totp.h"
+
+TotpService* TotpService::m_instance(nullptr);
+
+TotpService::TotpService(QObject* parent)
+    : QObject(parent)
+{
+    m_timer.setSingleShot(true);
+    // coarse timers may fire early, which would just reschedule
+    m_timer.setTimerType(Qt::PreciseTimer);
+    connect(&m_timer, SIGNAL(timeout()), SLOT(stepElapsed()));
+}
+
+TotpService* TotpService::instance()
+{
+    if (!m_instance) {
+        m_instance = new TotpService();
+    }
+
+    return m_instance;
+}
+
+/**
+ * The TOTP code of the entry for the current time step, same as Entry::totp().
+ */
+QString TotpService::code(const Entry* entry)
+{
+    if (!entry->hasTotp()) {
+        return QString("");
+    }
+
+    CachedCode& cached = cachedCode(entry);
+    cached.requested = true;
+    if (updateCode(cached, currentTime())) {
+        scheduleUpdate();
+    }
+
+    return cached.code;
+}
+
+void TotpService::entryModified()
+{
+    // the seed or its settings may have changed, parse them again on the next lookup
+    QObject* entry = sender();
+    if (entry && m_codes.remove(entry) > 0) {
+        entry->disconnect(this);
+        emit codesChanged();
+    }
+}
+
+void TotpService::entryDestroyed(QObject* entry)
+{
+    m_codes.remove(entry);
+}
+
+void TotpService::stepElapsed()
+{
+    const quint64 time = currentTime();
+
+    bool changed = false;
+    for (auto it = m_codes.begin(); it != m_codes.end();) {
+        CachedCode& cached = it.value();
+        if (cached.valid && cached.counter == time / cached.step) {
+            ++it;
+            continue;
+        }
+
+        // views ask for the codes they show on every codesChanged(), so codes
+        // nobody asked for since the last step are no longer shown
+        if (!cached.requested) {
+            disconnect(it.key(), nullptr, this, nullptr);
+            it = m_codes.erase(it);
+            continue;
+        }
+
+        cached.requested = false;
+        if (updateCode(cached, time)) {
+            changed = true;
+        }
+        ++it;
+    }
+
+    scheduleUpdate();
+
+    if (changed) {
+        emit codesChanged();
+    }
+}
+
+TotpService::CachedCode& TotpService::cachedCode(const Entry* entry)
+{
+    if (m_codes.contains(entry)) {
+        return m_codes[entry];
+    }
+
+    connect(entry, SIGNAL(modified()), SLOT(entryModified()));
+    connect(entry, SIGNAL(destroyed(QObject*)), SLOT(entryDestroyed(QObject*)));
+
+    // totpSeed() also updates the entry's digits and step
+    const QByteArray seed = entry->totpSeed().toLatin1();
+
+    CachedCode& cached = m_codes[entry];
+    cached.digits = entry->totpDigits();
+    cached.step = entry->totpStep();
+    cached.counter = 0;
+    cached.requested = false;
+    cached.valid = Totp::decodeSecret(seed, cached.secret);
+    if (!cached.valid) {
+        // the error message doesn't change with time
+        cached.code = Totp::generateTotp(seed, 0, cached.digits, cached.step);
+    }
+
+    return cached;
+}
+
+/**
+ * Recompute the code if the time step changed. Returns true if it did.
+ */
+bool TotpService::updateCode(CachedCode& cached, quint64 time)
+{
+    if (!cached.valid) {
+        return false;
+    }
+
+    const quint64 counter = time / cached.step;
+    if (counter == cached.counter && !cached.code.isEmpty()) {
+        return false;
+    }
+
+    cached.counter = counter;
+    cached.code = Totp::generateCode(cached.secret, counter, cached.digits);
+    return true;
+}
+
+/**
+ * Arm the timer for the earliest step roll-over of all cached codes.
+ */
+void TotpService::scheduleUpdate()
+{
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    qint64 next = -1;
+
+    for (const CachedCode& cached : asConst(m_codes)) {
+        if (!cached.valid) {
+            continue;
+        }
+
+        const qint64 rollover = static_cast<qint64>(cached.counter + 1) * cached.step * 1000;
+        if (next < 0 || rollover < next) {
+            next = rollover;
+        }
+    }
+
+    if (next < 0) {
+        m_timer.stop();
+        return;
+    }
+
+    m_timer.start(static_cast<int>(qMax<qint64>(0, next - now)));
+}
+
+quint64 TotpService::currentTime()
+{
+    return static_cast<quint64>(QDateTime::currentMSecsSinceEpoch() / 1000);
+}
@@ -0,0 +1,84 @@
+/*
+ *  Copyright (C) 2017 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSX_TOTPSERVICE_H
+#define KEEPASSX_TOTPSERVICE_H
+
+#include <QHash>
+#include <QObject>
+#include <QTimer>
+
+class Entry;
+
+/**
+ * Current TOTP codes of the entries shown in the GUI.
+ *
+ * The seed of an entry is parsed and decoded once and kept until the entry is
+ * modified or deleted, or no view asked for its code during a whole time step.
+ * Codes are computed once per time step, for all cached entries at the same
+ * time, and codesChanged() is emitted when a step rolls over so views don't
+ * have to poll.
+ *
+ * Must only be used from the GUI thread.
+ */
+class TotpService : public QObject
+{
+    Q_OBJECT
+
+public:
+    QString code(const Entry* entry);
+
+    static TotpService* instance();
+
+signals:
+    void codesChanged();
+
+private slots:
+    void entryModified();
+    void entryDestroyed(QObject* entry);
+    void stepElapsed();
+
+private:
+    struct CachedCode
+    {
+        bool valid;
+        bool requested;
+        QByteArray secret;
+        quint8 digits;
+        quint8 step;
+        quint64 counter;
+        QString code;
+    };
+
+    explicit TotpService(QObject* parent = nullptr);
+
+    CachedCode& cachedCode(const Entry* entry);
+    bool updateCode(CachedCode& cached, quint64 time);
+    void scheduleUpdate();
+    static quint64 currentTime();
+
+    QHash<const QObject*, CachedCode> m_codes;
+    QTimer m_timer;
+
+    static TotpService* m_instance;
+};
+
+inline TotpService* totpService() {
+    return TotpService::instance();
+}
+
+#endif // KEEPASSX_TOTPSERVICE_H
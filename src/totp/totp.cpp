@@ -133,15 +133,39 @@ QString Totp::generateTotp(const QByteArray key,
                             const quint8 numDigits = defaultDigits,
                             const quint8 step = defaultStep)
 {
-    quint64 current = qToBigEndian(time / step);
-
-    QVariant secret = Base32::decode(Base32::sanitizeInput(key));
-    if (secret.isNull()) {
+    QByteArray secret;
+    if (!decodeSecret(key, secret)) {
         return "Invalid TOTP secret key";
     }
 
+    return generateCode(secret, time / step, numDigits);
+}
+
+/**
+ * Decode a Base32 TOTP seed into the HMAC key used by generateCode().
+ * Returns false if the seed is not valid Base32.
+ */
+bool Totp::decodeSecret(const QByteArray& key, QByteArray& secret)
+{
+    QVariant decoded = Base32::decode(Base32::sanitizeInput(key));
+    if (decoded.isNull()) {
+        return false;
+    }
+
+    secret = decoded.toByteArray();
+    return true;
+}
+
+/**
+ * Code for the given time step counter, i.e. the current time divided by the
+ * step length, from an already decoded secret.
+ */
+QString Totp::generateCode(const QByteArray& secret, quint64 counter, const quint8 numDigits)
+{
+    quint64 current = qToBigEndian(counter);
+
     QMessageAuthenticationCode code(QCryptographicHash::Sha1);
-    code.setKey(secret.toByteArray());
+    code.setKey(secret);
     code.addData(QByteArray(reinterpret_cast<char*>(&current), sizeof(current)));
     QByteArray hmac = code.result();
 
@@ -31,6 +31,8 @@ public:
     Totp();
     static QString parseOtpString(QString rawSecret, quint8& digits, quint8& step);
     static QString generateTotp(const QByteArray key, quint64 time, const quint8 numDigits, const quint8 step);
+    static bool decodeSecret(const QByteArray& key, QByteArray& secret);
+    static QString generateCode(const QByteArray& secret, quint64 counter, const quint8 numDigits);
     static QUrl generateOtpString(const QString& secret,
                                   const QString& type,
                                   const QString& issuer,
@@ -217,10 +217,16 @@ static void AddResult(ZxcMatch_t **HeadRef, ZxcMatch_t *Nu, int MaxLen)
     }
 }
 
+/* Returned by the matching functions that report how many chars they looked at, when
+ * their result depends on where the password ends
+ */
+#define REACH_END 0x7FFFFFFF
+
 /**********************************************************************************
  * See if the match is repeated. If it is then add a new repeated match to the results.
+ * Returns how many chars from Passwd were looked at, or REACH_END.
  */
-static void AddMatchRepeats(ZxcMatch_t **Result, ZxcMatch_t *Match, const uint8_t *Passwd, int MaxLen)
+static int AddMatchRepeats(ZxcMatch_t **Result, ZxcMatch_t *Match, const uint8_t *Passwd, int MaxLen)
 {
     int Len = Match->Length;
     const uint8_t *Rpt = Passwd + Len;
@@ -240,10 +246,11 @@ static void AddMatchRepeats(ZxcMatch_t **Result, ZxcMatch_t *Match, const uint8_
             AddResult(Result, p, MaxLen);
         }
         else
-            break;
+            return Len * RepeatCount;
         ++RepeatCount;
         Rpt += Len;
     }
+    return REACH_END;
 }
 
 /*################################################################################*
@@ -623,11 +630,13 @@ static void DictionaryEntropy(ZxcMatch_t *m, DictMatchInfo_t *Extra, const uint8
 }
 
 /**********************************************************************************
- * Function that does the word matching
+ * Function that does the word matching. Returns how many chars from Passwd were looked
+ * at, or REACH_END.
  */
-static void DoDictMatch(const uint8_t *Passwd, int Start, int MaxLen, DictWork_t *Wrk, ZxcMatch_t **Result, DictMatchInfo_t *Extra, int Lev)
+static int DoDictMatch(const uint8_t *Passwd, int Start, int MaxLen, DictWork_t *Wrk, ZxcMatch_t **Result, DictMatchInfo_t *Extra, int Lev)
 {
     int Len;
+    int Reach = 0;
     uint8_t TempLeet[LEET_NORM_MAP_SIZE];
     int Ord = Wrk->Ordinal;
     int Caps = Wrk->Caps;
@@ -644,6 +653,8 @@ static void DoDictMatch(const uint8_t *Passwd, int Start, int MaxLen, DictWork_t
         int w, x, y, z;
         const uint8_t *q;
         z = 0;
+        if (Start + Len >= Reach)
+            Reach = Start + Len + 1;
         if (!Len && Wrk->First)
         {
             c = Wrk->First;
@@ -702,10 +713,12 @@ static void DoDictMatch(const uint8_t *Passwd, int Start, int MaxLen, DictWork_t
                             w.LeetCnv[i] = *r;
                             AddLeetChr(*r, -1, w.Leeted, w.UnLeet);
                         }
-                        DoDictMatch(Pwd, Passwd - Pwd, MaxLen - Len, &w, Result, Extra, Lev+1);
+                        x = DoDictMatch(Pwd, Passwd - Pwd, MaxLen - Len, &w, Result, Extra, Lev+1);
+                        if (x > Reach)
+                            Reach = x;
                     }
                 }
-                return;
+                return Reach;
             }
         }
         q = CharBinSearch(c, PossChars, NumPossChrs, 1);
@@ -721,7 +734,7 @@ static void DoDictMatch(const uint8_t *Passwd, int Start, int MaxLen, DictWork_t
         if (!q)
         {
             /* No match for char - return */
-            return;
+            return Reach;
         }
         /* Add all the end counts of the child nodes before the one that matches */
         x = (q - Wrk->PossChars);
@@ -764,11 +777,15 @@ static void DoDictMatch(const uint8_t *Passwd, int Start, int MaxLen, DictWork_t
             p->Length = Wrk->PwdLength + Len + 1;
             p->Begin = Wrk->Begin;
             DictionaryEntropy(p, Extra, Pwd);
-            AddMatchRepeats(Result, p, Pwd, MaxLen);
+            x = AddMatchRepeats(Result, p, Pwd, MaxLen);
+            if (x > Reach)
+                Reach = x;
             AddResult(Result, p, MaxLen);
             ++Ord;
         }
     }
+    /* Stopped by the end of the password */
+    return REACH_END;
 }
 
 /**********************************************************************************
@@ -779,12 +796,14 @@ static void DoDictMatch(const uint8_t *Passwd, int Start, int MaxLen, DictWork_t
  *  Passwd  The start of the password
  *  Start   Where in the password to start attempting to match
  *  MaxLen  Maximum number characters to consider
+ * Returns how many chars from Start were looked at, or REACH_END.
  */
-static void UserMatch(ZxcMatch_t **Result, const char *Words[], const uint8_t *Passwd, int Start, int MaxLen)
+static int UserMatch(ZxcMatch_t **Result, const char *Words[], const uint8_t *Passwd, int Start, int MaxLen)
 {
     int Rank;
+    int Reach = 0;
     if (!Words)
-        return;
+        return Reach;
     Passwd += Start;
     for(Rank = 0; Words[Rank]; ++Rank)
     {
@@ -871,8 +890,11 @@ static void UserMatch(ZxcMatch_t **Result, const char *Words[], const uint8_t *P
                 break;
             }
         }
+        if (Pwd - Passwd > Reach)
+            Reach = Pwd - Passwd;
         if (Len)
         {
+            int Rpt;
             ZxcMatch_t *p = AllocMatch();
             if (!Leets)
                 p->Type = USER_MATCH;
@@ -886,10 +908,13 @@ static void UserMatch(ZxcMatch_t **Result, const char *Words[], const uint8_t *P
             Extra.NumLeet = Leets;
             Extra.Rank = Rank+1;
             DictionaryEntropy(p, &Extra, Passwd);
-            AddMatchRepeats(Result, p, Passwd, MaxLen);
+            Rpt = AddMatchRepeats(Result, p, Passwd, MaxLen);
+            if (Rpt > Reach)
+                Reach = Rpt;
             AddResult(Result, p, MaxLen);
         }
     }
+    return Reach;
 }
 
 /**********************************************************************************
@@ -899,8 +924,9 @@ static void UserMatch(ZxcMatch_t **Result, const char *Words[], const uint8_t *P
  *  Passwd  The start of the password
  *  Start   Where in the password to start attempting to match
  *  MaxLen  Maximum number characters to consider
+ * Returns how many chars from Start were looked at, or REACH_END.
  */
-static void DictionaryMatch(ZxcMatch_t **Result, const uint8_t *Passwd, int Start, int MaxLen)
+static int DictionaryMatch(ZxcMatch_t **Result, const uint8_t *Passwd, int Start, int MaxLen)
 {
     DictWork_t Wrk;
     DictMatchInfo_t Extra;
@@ -910,7 +936,7 @@ static void DictionaryMatch(ZxcMatch_t **Result, const uint8_t *Passwd, int Star
     Wrk.Ordinal = 1;
     Wrk.StartLoc = ROOT_NODE_LOC;
     Wrk.Begin = Start;
-    DoDictMatch(Passwd+Start, 0, MaxLen, &Wrk, Result, &Extra, 0);
+    return DoDictMatch(Passwd+Start, 0, MaxLen, &Wrk, Result, &Extra, 0);
 }
 
 
@@ -1493,10 +1519,12 @@ static void SequenceMatch(ZxcMatch_t **Result, const uint8_t *Passwd, int Start,
             }
             if (IsDigits && (Dir < 0) && (Passwd[0] == '0') && (Passwd[1] == ('9'+1 + Dir)))
             {
+                /* Decrementing digits, consider '0' to be same as a 'ten' character */
                 ++Len;
                 ++Passwd;
+                break;
             }
-            else if ((Next > SetHigh) || (Next < SetLow) || (Passwd[1] != Next))
+            if ((Next > SetHigh) || (Next < SetLow) || (Passwd[1] != Next))
                 break;
             ++Len;
             ++Passwd;
@@ -1569,10 +1597,105 @@ typedef struct
     int         Visit;  /* Non zero when node has been visited during Dijkstra evaluation */
 } Node_t;
 
+/* Matches saved from the previous password given to ZxcvbnMatchState() */
+struct ZxcState
+{
+    uint8_t    *Passwd;     /* The previous password */
+    int         Len;        /* Its length */
+    ZxcMatch_t **Fwd;       /* Matches found at each start position, Begin relative to the start */
+    ZxcMatch_t **Dict;      /* The user and dictionary matches among them */
+    int        *DictReach;  /* How many chars the user and dictionary matching looked at */
+    ZxcMatch_t **Rev;       /* Reverse matches of each start position of the reversed password */
+    int        *RevReach;   /* How many chars the reverse matching looked at */
+};
+
 /**********************************************************************************
- * Main function of the zxcvbn password entropy estimation
+ * Copy a list of matches, moving the begin of each match by Offset chars
  */
-double ZxcvbnMatch(const char *Pwd, const char *UserDict[], ZxcMatch_t **Info)
+static ZxcMatch_t *CopyMatches(const ZxcMatch_t *Src, int Offset)
+{
+    ZxcMatch_t *Head = 0;
+    ZxcMatch_t **Tail = &Head;
+    for(; Src; Src = Src->Next)
+    {
+        ZxcMatch_t *p = AllocMatch();
+        *p = *Src;
+        p->Begin += Offset;
+        p->Next = 0;
+        *Tail = p;
+        Tail = &(p->Next);
+    }
+    return Head;
+}
+
+/**********************************************************************************
+ * Free the match lists of a password with Len chars, and the array holding them
+ */
+static void FreeMatchLists(ZxcMatch_t **Lists, int Len)
+{
+    int i;
+    if (!Lists)
+        return;
+    for(i = 0; i < Len; ++i)
+        ZxcvbnFreeInfo(Lists[i]);
+    FreeFn(Lists);
+}
+
+/**********************************************************************************
+ * Clear and free a copy of a password with Len chars
+ */
+static void FreePasswd(uint8_t *Passwd, int Len)
+{
+    volatile uint8_t *p = Passwd;
+    if (!Passwd)
+        return;
+    while(Len-- > 0)
+        *p++ = 0;
+    FreeFn(Passwd);
+}
+
+/**********************************************************************************
+ * Free the matches saved in the state
+ */
+static void FreeStateMatches(ZxcState_t *State)
+{
+    FreeMatchLists(State->Fwd, State->Len);
+    FreeMatchLists(State->Dict, State->Len);
+    FreeMatchLists(State->Rev, State->Len);
+    FreeFn(State->DictReach);
+    FreeFn(State->RevReach);
+}
+
+/**********************************************************************************
+ * The matches found at one start position only depend on the chars from the start
+ * position to the end of the (possibly reversed) password, and on whether the start
+ * position is the begining of the password. So they can be reused when the previous
+ * password ended with the same Part chars and the start was at the begining of both
+ * passwords or of neither.
+ */
+static int CanReuse(int Part, int Common, int Len, int OldLen)
+{
+    return (Part <= Common) && ((Part == Len) == (Part == OldLen));
+}
+
+/**********************************************************************************
+ * The user and dictionary matches found at start position Start only depend on the
+ * chars the matching looked at, and on the start position. So they can also be reused
+ * when the previous password began with the same Common chars and the matching at
+ * Start stopped before the first changed char.
+ */
+static int CanReuseStart(int Start, const int *Reach, int Common)
+{
+    return (Start < Common) && (Reach[Start] < Common - Start);
+}
+
+/**********************************************************************************
+ * Main function of the zxcvbn password entropy estimation. When State is given,
+ * matches of the previous password are reused where possible and the matches of this
+ * password are saved. Returns a negative value if Cancel returned non zero.
+ */
+static double MatchPassword(const char *Pwd, const char *UserDict[], ZxcMatch_t **Info,
+                            ZxcState_t *State, int (*Cancel)(void *), void *Context)
 {
     int i, j;
     ZxcMatch_t *Zp;
@@ -1580,24 +1703,82 @@ double ZxcvbnMatch(const char *Pwd, const char *UserDict[], ZxcMatch_t **Info)
     double e;
     int Len = strlen(Pwd);
     const uint8_t *Passwd = reinterpret_cast<const uint8_t *>(Pwd);
-    uint8_t *RevPwd;
+    uint8_t *RevPwd = 0;
+    int OldLen = 0;
+    int Prefix = 0;
+    int Suffix = 0;
+    ZxcMatch_t **Fwd = 0;
+    ZxcMatch_t **Dict = 0;
+    int *DictReach = 0;
+    ZxcMatch_t **Rev = 0;
+    int *RevReach = 0;
     /* Create the paths */
     Node_t *Nodes = MallocFn(Node_t, Len+1);
     memset(Nodes, 0, (Len+1) * sizeof *Nodes);
     i = Cardinality(Passwd, Len);
     e = log(static_cast<double>(i));
 
+    if (State)
+    {
+        /* Find how much of the previous password is unchanged at the begining and end */
+        OldLen = State->Len;
+        while((Prefix < Len) && (Prefix < OldLen) && (Passwd[Prefix] == State->Passwd[Prefix]))
+            ++Prefix;
+        while((Suffix < Len) && (Suffix < OldLen) &&
+              (Passwd[Len-1-Suffix] == State->Passwd[OldLen-1-Suffix]))
+            ++Suffix;
+        Fwd = MallocFn(ZxcMatch_t *, Len+1);
+        memset(Fwd, 0, (Len+1) * sizeof *Fwd);
+        Dict = MallocFn(ZxcMatch_t *, Len+1);
+        memset(Dict, 0, (Len+1) * sizeof *Dict);
+        DictReach = MallocFn(int, Len+1);
+        Rev = MallocFn(ZxcMatch_t *, Len+1);
+        memset(Rev, 0, (Len+1) * sizeof *Rev);
+        RevReach = MallocFn(int, Len+1);
+    }
+
     /* Do matching for all parts of the password */
     for(i = 0; i < Len; ++i)
     {
         int MaxLen = Len - i;
-        /* Add all the 'paths' between groups of chars in the password, for current starting char */
-        UserMatch(&(Nodes[i].Paths), UserDict, Passwd, i, MaxLen);
-        DictionaryMatch(&(Nodes[i].Paths), Passwd, i, MaxLen);
-        DateMatch(&(Nodes[i].Paths), Passwd, i, MaxLen);
-        SpatialMatch(&(Nodes[i].Paths), Passwd, i, MaxLen);
-        SequenceMatch(&(Nodes[i].Paths), Passwd, i, MaxLen);
-        RepeatMatch(&(Nodes[i].Paths), Passwd, i, MaxLen);
+        if (Cancel && Cancel(Context))
+            goto Cancelled;
+        if (State && CanReuse(MaxLen, Suffix, Len, OldLen))
+        {
+            /* Same chars up to the end as the previous password */
+            Nodes[i].Paths = CopyMatches(State->Fwd[OldLen - MaxLen], i);
+            Dict[i] = CopyMatches(State->Dict[OldLen - MaxLen], 0);
+            DictReach[i] = State->DictReach[OldLen - MaxLen];
+        }
+        else
+        {
+            int Reach;
+            if (State && CanReuseStart(i, State->DictReach, Prefix))
+            {
+                /* The word matching did not get as far as the changed chars */
+                Nodes[i].Paths = CopyMatches(State->Dict[i], i);
+                Reach = State->DictReach[i];
+            }
+            else
+            {
+                /* Add all the 'paths' between groups of chars in the password, for current starting char */
+                Reach = UserMatch(&(Nodes[i].Paths), UserDict, Passwd, i, MaxLen);
+                j = DictionaryMatch(&(Nodes[i].Paths), Passwd, i, MaxLen);
+                if (j > Reach)
+                    Reach = j;
+            }
+            if (Dict)
+            {
+                Dict[i] = CopyMatches(Nodes[i].Paths, -i);
+                DictReach[i] = Reach;
+            }
+            DateMatch(&(Nodes[i].Paths), Passwd, i, MaxLen);
+            SpatialMatch(&(Nodes[i].Paths), Passwd, i, MaxLen);
+            SequenceMatch(&(Nodes[i].Paths), Passwd, i, MaxLen);
+            RepeatMatch(&(Nodes[i].Paths), Passwd, i, MaxLen);
+        }
+        if (Fwd)
+            Fwd[i] = CopyMatches(Nodes[i].Paths, -i);
 
         /* Initially set distance to nearly infinite */
         Nodes[i].Dist = DBL_MAX;
@@ -1612,8 +1793,32 @@ double ZxcvbnMatch(const char *Pwd, const char *UserDict[], ZxcMatch_t **Info)
     {
         ZxcMatch_t *Path = 0;
         int MaxLen = Len - i;
-        DictionaryMatch(&Path, RevPwd, i, MaxLen);
-        UserMatch(&Path, UserDict, RevPwd, i, MaxLen);
+        if (Cancel && Cancel(Context))
+            goto Cancelled;
+        if (State && CanReuse(MaxLen, Prefix, Len, OldLen))
+        {
+            /* The reversed password ends with the same chars as the previous one */
+            Path = CopyMatches(State->Rev[OldLen - MaxLen], i);
+            RevReach[i] = State->RevReach[OldLen - MaxLen];
+        }
+        else if (State && CanReuseStart(i, State->RevReach, Suffix))
+        {
+            /* The reversed password begins with the same chars as the previous one,
+             * and the word matching did not get as far as the changed chars */
+            Path = CopyMatches(State->Rev[i], i);
+            RevReach[i] = State->RevReach[i];
+        }
+        else
+        {
+            int Reach = DictionaryMatch(&Path, RevPwd, i, MaxLen);
+            j = UserMatch(&Path, UserDict, RevPwd, i, MaxLen);
+            if (j > Reach)
+                Reach = j;
+            if (RevReach)
+                RevReach[i] = Reach;
+        }
+        if (Rev)
+            Rev[i] = CopyMatches(Path, -i);
 
         /* Now transfer any reverse matches to the normal results */
         while(Path)
@@ -1755,7 +1960,76 @@ double ZxcvbnMatch(const char *Pwd, const char *UserDict[], ZxcMatch_t **Info)
         }
     }
     FreeFn(Nodes);
+
+    if (State)
+    {
+        /* Remember the matches for the next password */
+        FreeStateMatches(State);
+        FreePasswd(State->Passwd, State->Len);
+        State->Passwd = MallocFn(uint8_t, Len+1);
+        memcpy(State->Passwd, Passwd, Len+1);
+        State->Len = Len;
+        State->Fwd = Fwd;
+        State->Dict = Dict;
+        State->DictReach = DictReach;
+        State->Rev = Rev;
+        State->RevReach = RevReach;
+    }
     return e;
+
+Cancelled:
+    /* Drop the partial results, the state still holds the previous password */
+    for(i = 0; i < Len; ++i)
+        ZxcvbnFreeInfo(Nodes[i].Paths);
+    FreeFn(Nodes);
+    FreeFn(RevPwd);
+    FreeMatchLists(Fwd, Len);
+    FreeMatchLists(Dict, Len);
+    FreeFn(DictReach);
+    FreeMatchLists(Rev, Len);
+    FreeFn(RevReach);
+    if (Info)
+        *Info = 0;
+    return -1.0;
+}
+
+/**********************************************************************************
+ * Estimate the entropy of a password from scratch
+ */
+double ZxcvbnMatch(const char *Pwd, const char *UserDict[], ZxcMatch_t **Info)
+{
+    return MatchPassword(Pwd, UserDict, Info, 0, 0, 0);
+}
+
+/**********************************************************************************
+ * Estimate the entropy of a password reusing the matches of the previous call
+ */
+double ZxcvbnMatchState(const char *Pwd, const char *UserDict[], ZxcMatch_t **Info,
+                        ZxcState_t *State, int (*Cancel)(void *), void *Context)
+{
+    return MatchPassword(Pwd, UserDict, Info, State, Cancel, Context);
+}
+
+/**********************************************************************************
+ * Allocate the state used by ZxcvbnMatchState()
+ */
+ZxcState_t *ZxcvbnNewState()
+{
+    ZxcState_t *p = MallocFn(ZxcState_t, 1);
+    memset(p, 0, sizeof *p);
+    return p;
+}
+
+/**********************************************************************************
+ * Free the state used by ZxcvbnMatchState()
+ */
+void ZxcvbnFreeState(ZxcState_t *State)
+{
+    if (!State)
+        return;
+    FreeStateMatches(State);
+    FreePasswd(State->Passwd, State->Len);
+    FreeFn(State);
 }
 
 /**********************************************************************************
@@ -132,6 +132,36 @@ double ZxcvbnMatch(const char *Passwd, const char *UserDict[], ZxcMatch_t **Info
  */
 void ZxcvbnFreeInfo(ZxcMatch_t *Info);
 
+/* Matches kept between calls to ZxcvbnMatchState() */
+typedef struct ZxcState ZxcState_t;
+
+/**********************************************************************************
+ * Allocate an empty state for ZxcvbnMatchState(). Free it with ZxcvbnFreeState().
+ */
+ZxcState_t *ZxcvbnNewState();
+
+/**********************************************************************************
+ * Free the state allocated by ZxcvbnNewState().
+ */
+void ZxcvbnFreeState(ZxcState_t *State);
+
+/**********************************************************************************
+ * Same as ZxcvbnMatch(), but reuses the matches of the password given in the previous
+ * call with the same State. Meant for passwords that are being typed, where the
+ * previous password shares its begining or end with the new one. The result is the
+ * same as from ZxcvbnMatch().
+ * The extra parameters are:
+ *  State       State from ZxcvbnNewState(). The same UserDict must be passed in all
+ *               calls using this state, and the state must not be used by two calls
+ *               at the same time.
+ *  Cancel      Function called regularly with Context as parameter. When it returns
+ *               non zero the matching is abandoned. May be null.
+ * Returns the entropy of the password (in bits), or a negative value if cancelled. A
+ * cancelled call leaves the state unchanged.
+ */
+double ZxcvbnMatchState(const char *Passwd, const char *UserDict[], ZxcMatch_t **Info,
+                        ZxcState_t *State, int (*Cancel)(void *), void *Context);
+
 #ifdef __cplusplus
 }
 #endif
@@ -27,6 +27,7 @@
 #include "core/Group.h"
 #include "crypto/Crypto.h"
 #include "autotype/AutoType.h"
+#include "autotype/AutoTypeMatchIndex.h"
 #include "autotype/AutoTypePlatformPlugin.h"
 #include "autotype/test/AutoTypeTestInterface.h"
 #include "gui/MessageBox.h"
@@ -160,6 +161,30 @@ void TestAutoType::testAutoTypeWithSequence()
              .arg(m_entry1->password()));
 }
 
+void TestAutoType::testAutoTypeBatches()
+{
+    const QString sequence = QString("0123456789").repeated(4);
+    m_autoType->performAutoType(m_entry1, nullptr, sequence);
+
+    QCOMPARE(m_test->actionChars(), sequence);
+    QCOMPARE(m_test->actionBatches(), QList<int>() << 8 << 8 << 8 << 8 << 8);
+    // the window is looked up once and then checked once per batch
+    QCOMPARE(m_test->activeWindowChecks(), 6);
+
+    m_test->clearActions();
+    m_autoType->performAutoType(m_entry1, nullptr, sequence.left(32));
+
+    QCOMPARE(m_test->actionBatches(), QList<int>() << 8 << 8 << 8 << 8);
+
+    // a window change stops the sequence at the next batch
+    m_test->clearActions();
+    m_test->changeActiveWindowAfter(3);
+    m_autoType->performAutoType(m_entry1, nullptr, sequence);
+
+    QCOMPARE(m_test->actionChars(), sequence.left(16));
+    QCOMPARE(m_test->actionBatches(), QList<int>() << 8 << 8);
+}
+
 void TestAutoType::testGlobalAutoTypeWithNoMatch()
 {
     m_test->setActiveWindowTitle("nomatch");
@@ -283,6 +308,142 @@ void TestAutoType::testGlobalAutoTypeRegExp()
     m_test->clearActions();
 }
 
+void TestAutoType::testGlobalAutoTypeEntryChanges()
+{
+    m_test->setActiveWindowTitle("custom window");
+    m_autoType->performGlobalAutoType(m_dbList);
+    QCOMPARE(m_test->actionChars(), QString("%1association%2").arg(m_entry1->username(), m_entry1->password()));
+    m_test->clearActions();
+
+    // modified associations are used on the next lookup
+    AutoTypeAssociations::Association association;
+    association.window = "other window";
+    association.sequence = "other";
+    m_entry1->autoTypeAssociations()->clear();
+    m_entry1->autoTypeAssociations()->add(association);
+
+    MessageBox::setNextAnswer(QMessageBox::Ok);
+    m_autoType->performGlobalAutoType(m_dbList);
+    QCOMPARE(m_test->actionChars(), QString());
+
+    m_test->setActiveWindowTitle("other window");
+    m_autoType->performGlobalAutoType(m_dbList);
+    QCOMPARE(m_test->actionChars(), QString("other"));
+    m_test->clearActions();
+
+    // so are new entries and the entries they refer to
+    m_entry2->setUuid(Uuid::random());
+    Entry* entry = new Entry();
+    entry->setGroup(m_group);
+    entry->setPassword("reference");
+    association.window = QString("{REF:T@I:%1}").arg(m_entry2->uuid().toHex());
+    association.sequence = "{PASSWORD}";
+    entry->autoTypeAssociations()->add(association);
+
+    m_test->setActiveWindowTitle("entry title");
+    m_autoType->performGlobalAutoType(m_dbList);
+    QCOMPARE(m_test->actionChars(), QString("reference"));
+    m_test->clearActions();
+
+    m_entry2->setTitle("new title");
+    m_test->setActiveWindowTitle("new title");
+    m_autoType->performGlobalAutoType(m_dbList);
+    QCOMPARE(m_test->actionChars(), QString("reference"));
+    m_test->clearActions();
+
+    // removed entries are not matched anymore
+    delete entry;
+    MessageBox::setNextAnswer(QMessageBox::Ok);
+    m_autoType->performGlobalAutoType(m_dbList);
+    QCOMPARE(m_test->actionChars(), QString());
+}
+
+void TestAutoType::testMatchIndexOrder()
+{
+    AutoTypeAssociations::Association association;
+    association.window = "ordered window";
+
+    // entries are created out of tree order, in nested groups
+    Group* groupA = new Group();
+    groupA->setParent(m_group);
+    Group* groupB = new Group();
+    groupB->setParent(m_group);
+    Group* groupA1 = new Group();
+    groupA1->setParent(groupA);
+
+    QList<Group*> groups = QList<Group*>() << groupB << groupA1 << m_group << groupA << groupB << m_group;
+    for (int i = 0; i < 30; ++i) {
+        Entry* entry = new Entry();
+        entry->setGroup(groups.at(i % groups.size()));
+        entry->setTitle(QString("Ordered %1").arg(i));
+        association.sequence = QString::number(i);
+        entry->autoTypeAssociations()->add(association);
+    }
+
+    AutoTypeMatchIndex index(m_db);
+
+    auto expectedEntries = [this]() {
+        QList<Entry*> entries;
+        for (Entry* entry : m_group->entriesRecursive()) {
+            if (entry->title().startsWith("Ordered")) {
+                entries << entry;
+            }
+        }
+        return entries;
+    };
+    auto matchedEntries = [&index]() {
+        QList<Entry*> entries;
+        for (const AutoTypeMatch& match : index.match("ordered window", false, false)) {
+            entries << match.first;
+        }
+        return entries;
+    };
+
+    QCOMPARE(matchedEntries().size(), 30);
+    QCOMPARE(matchedEntries(), expectedEntries());
+
+    // the order follows entries and groups that are moved later
+    Entry* moved = expectedEntries().last();
+    moved->setGroup(groupA1);
+    groupB->setParent(m_group, 0);
+    QCOMPARE(matchedEntries(), expectedEntries());
+    QCOMPARE(matchedEntries().first()->group(), m_group);
+}
+
+void TestAutoType::benchmarkGlobalAutoType()
+{
+    QByteArray env = qgetenv("BENCHMARK");
+
+    if (env.isEmpty() || env == "0" || env == "no") {
+        QSKIP("Benchmark skipped. Set env variable BENCHMARK=1 to enable.");
+    }
+
+    config()->set("AutoTypeEntryTitleMatch", true);
+
+    AutoTypeAssociations::Association association;
+    for (int i = 0; i < 10000; ++i) {
+        Entry* entry = new Entry();
+        entry->setGroup(m_group);
+        entry->setTitle(QString("Account %1").arg(i));
+        entry->setUrl(QString("https://app%1.example.com/login").arg(i));
+        entry->setPassword(QString("password%1").arg(i));
+        association.window = QString("Application %1 - *").arg(i);
+        association.sequence = "{PASSWORD}";
+        entry->autoTypeAssociations()->add(association);
+        association.window = QString("//^Dialog %1 \\d+$//").arg(i);
+        entry->autoTypeAssociations()->add(association);
+    }
+
+    m_test->setActiveWindowTitle("Application 9999 - Main Window");
+
+    QBENCHMARK {
+        m_test->clearActions();
+        m_autoType->performGlobalAutoType(m_dbList);
+    }
+
+    QCOMPARE(m_test->actionChars(), QString("password9999"));
+}
+
 void TestAutoType::testAutoTypeSyntaxChecks()
 {
     // Huge sequence
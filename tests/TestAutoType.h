@@ -40,6 +40,7 @@ private slots:
     void testInternal();
     void testAutoTypeWithoutSequence();
     void testAutoTypeWithSequence();
+    void testAutoTypeBatches();
     void testGlobalAutoTypeWithNoMatch();
     void testGlobalAutoTypeWithOneMatch();
     void testGlobalAutoTypeTitleMatch();
@@ -47,6 +48,9 @@ private slots:
     void testGlobalAutoTypeUrlSubdomainMatch();
     void testGlobalAutoTypeTitleMatchDisabled();
     void testGlobalAutoTypeRegExp();
+    void testGlobalAutoTypeEntryChanges();
+    void testMatchIndexOrder();
+    void benchmarkGlobalAutoType();
     void testAutoTypeSyntaxChecks();
 
 private:
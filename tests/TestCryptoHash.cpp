@@ -58,3 +58,68 @@ void TestCryptoHash::test()
     QCOMPARE(cryptoHash4.result(),
              QByteArray::fromHex("0d41b612584ed39ff72944c29494573e40f4bb95283455fae2e0be1e3565aa9f48057d59e6ffd777970e282871c25a549a2763e5b724794f312c97021c42f91d"));
 }
+
+void TestCryptoHash::testHmac()
+{
+    // RFC 4231 test case 2
+    QByteArray key = QString("Jefe").toLatin1();
+    QByteArray data = QString("what do ya want for nothing?").toLatin1();
+
+    QCOMPARE(CryptoHash::hmac(data, key, CryptoHash::Sha256),
+             QByteArray::fromHex("5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843"));
+    QCOMPARE(CryptoHash::hmac(data, key, CryptoHash::Sha512),
+             QByteArray::fromHex("164b7a7bfcf819e2e395fbe73b56e0a387bd64222e831fd610270cd7ea2505549758bf75c05a994a6d034f65f8f0e6fdcaeab1a34d4a6b4b636e070a38bce737"));
+
+    // the cached context must not leak state between calls
+    QCOMPARE(CryptoHash::hmac(data, key, CryptoHash::Sha256),
+             QByteArray::fromHex("5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843"));
+}
+
+void TestCryptoHash::testReuse()
+{
+    CryptoHash cryptoHash(CryptoHash::Sha256);
+    cryptoHash.addData(QString("garbage").toLatin1());
+    cryptoHash.reset();
+    cryptoHash.addData(QString("KeePassX").toLatin1());
+    QCOMPARE(cryptoHash.result(),
+             QByteArray::fromHex("0b56e5f65263e747af4a833bd7dd7ad26a64d7a4de7c68e52364893dca0766b4"));
+
+    CryptoHash hmac(CryptoHash::Sha256, true);
+    hmac.setKey(QString("other key").toLatin1());
+    hmac.addData(QString("garbage").toLatin1());
+    hmac.setKey(QString("Jefe").toLatin1());
+    hmac.addData(QString("what do ya want for nothing?").toLatin1());
+    QCOMPARE(hmac.result(),
+             QByteArray::fromHex("5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843"));
+}
+
+void TestCryptoHash::testHashParts()
+{
+    QList<QByteArray> parts;
+    parts << QByteArray() << QString("Keep").toLatin1() << QString("PassX").toLatin1();
+
+    QByteArray result = CryptoHash::hash(parts, CryptoHash::Sha256);
+    QCOMPARE(result, QByteArray::fromHex("0b56e5f65263e747af4a833bd7dd7ad26a64d7a4de7c68e52364893dca0766b4"));
+    QCOMPARE(CryptoHash::hash(QList<QByteArray>(), CryptoHash::Sha256),
+             QByteArray::fromHex("e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855"));
+}
+
+void TestCryptoHash::testHashMultiple()
+{
+    QList<QByteArray> buffers;
+    buffers << QByteArray() << QString("KeePassX").toLatin1() << QString("abc").toLatin1();
+
+    QList<QByteArray> results = CryptoHash::hashMultiple(buffers, CryptoHash::Sha256);
+    QCOMPARE(results.size(), 3);
+    QCOMPARE(results[0], QByteArray::fromHex("e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855"));
+    QCOMPARE(results[1], QByteArray::fromHex("0b56e5f65263e747af4a833bd7dd7ad26a64d7a4de7c68e52364893dca0766b4"));
+    QCOMPARE(results[2], QByteArray::fromHex("ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad"));
+
+    for (int i = 0; i < buffers.size(); ++i) {
+        QCOMPARE(results[i], CryptoHash::hash(buffers[i], CryptoHash::Sha256));
+    }
+
+    // a batch must not leak state into the next one-shot call
+    QCOMPARE(CryptoHash::hashMultiple(QList<QByteArray>(), CryptoHash::Sha512).size(), 0);
+    QCOMPARE(CryptoHash::hash(QString("abc").toLatin1(), CryptoHash::Sha256), results[2]);
+}
@@ -27,6 +27,10 @@ class TestCryptoHash : public QObject
 private slots:
     void initTestCase();
     void test();
+    void testHmac();
+    void testReuse();
+    void testHashParts();
+    void testHashMultiple();
 };
 
 #endif // KEEPASSX_TESTCRYPTOHASH_H
@@ -24,6 +24,8 @@
 
 #include "config-keepassx-tests.h"
 #include "core/Database.h"
+#include "core/Entry.h"
+#include "core/EntryHostIndex.h"
 #include "crypto/Crypto.h"
 #include "keys/PasswordKey.h"
 #include "core/Metadata.h"
@@ -111,3 +113,89 @@ void TestDatabase::testEmptyRecycleBinWithHierarchicalData()
 
     delete db;
 }
+
+void TestDatabase::testHostIndex()
+{
+    QCOMPARE(EntryHostIndex::hostKey("https://Login.Example.com:8443/path?q=1"), QString("login.example.com"));
+    QCOMPARE(EntryHostIndex::hostKey("example.com/login"), QString("example.com"));
+    QCOMPARE(EntryHostIndex::hostKey("My Bank"), QString());
+    QCOMPARE(EntryHostIndex::hostKey(""), QString());
+
+    Database db;
+    EntryHostIndex* index = db.hostIndex();
+    QCOMPARE(db.hostIndex(), index);
+
+    Entry* byUrl = new Entry();
+    byUrl->setUrl("https://example.com/login");
+    byUrl->setGroup(db.rootGroup());
+
+    Entry* byTitle = new Entry();
+    byTitle->setTitle("mail.example.com");
+    byTitle->setGroup(db.rootGroup());
+
+    Entry* byReference = new Entry();
+    byReference->setUrl(QString("{REF:A@I:%1}").arg(byUrl->uuid().toHex()));
+    byReference->setGroup(db.rootGroup());
+
+    QList<Entry*> result = index->entries("example.com");
+    QCOMPARE(result.size(), 2);
+    QVERIFY(result.contains(byUrl));
+    QVERIFY(result.contains(byReference));
+    QCOMPARE(index->entries("mail.example.com"), QList<Entry*>() << byTitle);
+
+    // entries of parent domains match too, most specific host level first
+    const QStringList levels = QStringList() << "a.mail.example.com" << "mail.example.com" << "example.com";
+    result = index->entries(levels);
+    QCOMPARE(result.size(), 3);
+    QCOMPARE(result.first(), byTitle);
+    QVERIFY(result.contains(byUrl));
+    QVERIFY(result.contains(byReference));
+    result = index->entries(QStringList() << "www.example.com" << "example.com");
+    QCOMPARE(result.size(), 2);
+    QVERIFY(result.contains(byUrl));
+    QVERIFY(result.contains(byReference));
+    QVERIFY(index->entries(QStringList() << "example.net").isEmpty());
+
+    // hosts allowed in the browser integration settings are indexed as well
+    Entry* allowed = new Entry();
+    allowed->setTitle("Single sign-on");
+    allowed->attributes()->set("KeePassXC-Browser Settings", "{\"Allow\":[\"SSO.example.org\"],\"Deny\":[]}");
+    allowed->setGroup(db.rootGroup());
+    QCOMPARE(index->entries("sso.example.org"), QList<Entry*>() << allowed);
+    allowed->attributes()->set("KeePassHttp Settings", "{\"Allow\":[\"login.example.org\"]}");
+    QCOMPARE(index->entries("login.example.org"), QList<Entry*>() << allowed);
+    allowed->attributes()->remove("KeePassXC-Browser Settings");
+    QVERIFY(index->entries("sso.example.org").isEmpty());
+    delete allowed;
+
+    // modified entries are re-indexed on the next lookup, so are the entries referring to them
+    byUrl->setUrl("https://other.example.net");
+    QVERIFY(index->entries("example.com").isEmpty());
+    result = index->entries("other.example.net");
+    QCOMPARE(result.size(), 2);
+    QVERIFY(result.contains(byUrl));
+    QVERIFY(result.contains(byReference));
+
+    // groups excluded from searching hide their entries
+    Group* hidden = new Group();
+    hidden->setSearchingEnabled(Group::Disable);
+    hidden->setParent(db.rootGroup());
+    Entry* hiddenEntry = new Entry();
+    hiddenEntry->setUrl("https://mail.example.com");
+    hiddenEntry->setGroup(hidden);
+    QCOMPARE(index->entries("mail.example.com"), QList<Entry*>() << byTitle);
+
+    // groups added with entries are indexed as a whole
+    Group* added = new Group();
+    Entry* addedEntry = new Entry();
+    addedEntry->setUrl("https://added.example.com");
+    addedEntry->setGroup(added);
+    added->setParent(db.rootGroup());
+    QCOMPARE(index->entries("added.example.com"), QList<Entry*>() << addedEntry);
+
+    delete added;
+    QVERIFY(index->entries("added.example.com").isEmpty());
+
+    delete byTitle;
+    QVERIFY(index->entries("mail.example.com").isEmpty());
+}
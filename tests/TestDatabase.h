@@ -31,6 +31,7 @@ private slots:
     void testEmptyRecycleBinOnNotCreated();
     void testEmptyRecycleBinOnEmpty();
     void testEmptyRecycleBinWithHierarchicalData();
+    void testHostIndex();
 };
 
 #endif // KEEPASSX_TESTDATABASE_H
@@ -349,3 +349,45 @@ void TestEntryModel::testDatabaseDelete()
     delete modelTest;
     delete model;
 }
+
+void TestEntryModel::testFetchMore()
+{
+    EntryModel* model = new EntryModel(this);
+    ModelTest* modelTest = new ModelTest(model, this);
+
+    Database* db = new Database();
+    QList<Entry*> entries;
+    for (int i = 0; i < 1200; ++i) {
+        Entry* entry = new Entry();
+        entry->setGroup(db->rootGroup());
+        entry->setTitle(QString("entry%1").arg(i));
+        entries.append(entry);
+    }
+
+    model->setEntryList(entries);
+    QCOMPARE(model->rowCount(), 500);
+    QVERIFY(model->canFetchMore(QModelIndex()));
+
+    QSignalSpy spyAdded(model, SIGNAL(rowsInserted(QModelIndex,int,int)));
+    model->fetchMore(QModelIndex());
+    QCOMPARE(model->rowCount(), 1000);
+    model->fetchMore(QModelIndex());
+    QCOMPARE(model->rowCount(), 1200);
+    QVERIFY(!model->canFetchMore(QModelIndex()));
+    QCOMPARE(spyAdded.count(), 2);
+
+    QModelIndex index = model->indexFromEntry(entries.at(1100));
+    QCOMPARE(model->data(index).toString(), QString("entry1100"));
+
+    // cached display values are refreshed when the entry changes
+    QSignalSpy spyDataChanged(model, SIGNAL(dataChanged(QModelIndex,QModelIndex)));
+    entries.at(1100)->setTitle("changed");
+    QCOMPARE(spyDataChanged.count(), 1);
+    QCOMPARE(model->data(index).toString(), QString("changed"));
+
+    delete db;
+    QCOMPARE(model->rowCount(), 0);
+
+    delete modelTest;
+    delete model;
+}
@@ -0,0 +1,93 @@
+/*
+ *  Copyright (C) 2017 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "TestEntryRanker.h"
+
+#include <QTest>
+
+#include "core/Entry.h"
+#include "core/EntryRanker.h"
+
+QTEST_GUILESS_MAIN(TestEntryRanker)
+
+void TestEntryRanker::testPriority()
+{
+    EntryRanker ranker("example.com", "https://example.com/login");
+
+    Entry entry;
+    entry.setUrl("https://example.com/login");
+    QCOMPARE(ranker.priority(&entry), 100);
+    entry.setUrl("https://example.com");
+    QCOMPARE(ranker.priority(&entry), 60);
+    entry.setUrl("https://example.com/login/form");
+    QCOMPARE(ranker.priority(&entry), 50);
+    entry.setUrl("https://other.org");
+    QCOMPARE(ranker.priority(&entry), 0);
+}
+
+void TestEntryRanker::testSort()
+{
+    EntryRanker ranker("example.com", "https://example.com/login");
+
+    Entry exact;
+    exact.setUrl("https://example.com/login");
+    exact.setTitle("b");
+    Entry base1;
+    base1.setUrl("https://example.com");
+    base1.setTitle("z");
+    Entry base2;
+    base2.setUrl("https://example.com");
+    base2.setTitle("a");
+    Entry other;
+    other.setUrl("https://other.org");
+    other.setTitle("c");
+
+    QList<Entry*> entries;
+    entries << &exact << &base1 << &other << &base2;
+
+    QList<Entry*> expected;
+    expected << &other << &base2 << &base1 << &exact;
+    QCOMPARE(ranker.sort(entries, "Title"), expected);
+}
+
+void TestEntryRanker::benchmarkSort()
+{
+    QByteArray env = qgetenv("BENCHMARK");
+
+    if (env.isEmpty() || env == "0" || env == "no") {
+        QSKIP("Benchmark skipped. Set env variable BENCHMARK=1 to enable.");
+    }
+
+    QList<Entry*> entries;
+    for (int i = 0; i < 10000; ++i) {
+        Entry* entry = new Entry();
+        entry->setTitle(QString("Account %1").arg((i * 7919) % 10000));
+        entry->setUsername(QString("user%1").arg(i));
+        entry->setUrl(QString("https://sso.example.com/app%1/login").arg(i % 50));
+        entries.append(entry);
+    }
+
+    EntryRanker ranker("sso.example.com", "https://sso.example.com/app7/login");
+    QList<Entry*> result;
+
+    QBENCHMARK {
+        result = ranker.sort(entries, "Title");
+    }
+
+    QCOMPARE(result.size(), entries.size());
+    qDeleteAll(entries);
+}
@@ -17,8 +17,11 @@
 
 #include "TestEntrySearcher.h"
 
+#include <QSignalSpy>
 #include <QTest>
 
+#include "core/EntrySearchTask.h"
+
 QTEST_GUILESS_MAIN(TestEntrySearcher)
 
 void TestEntrySearcher::initTestCase()
@@ -140,3 +143,79 @@ void TestEntrySearcher::testAllAttributesAreSearched()
     m_searchResult = m_entrySearcher.search("testTitle testUsername testUrl testNote", m_groupRoot, Qt::CaseInsensitive);
     QCOMPARE(m_searchResult.count(), 1);
 }
+
+void TestEntrySearcher::testSearchTask()
+{
+    Group* root = new Group();
+    Group* group1 = new Group();
+    Group* group2 = new Group();
+    group1->setParent(root);
+    group2->setParent(root);
+    group2->setName("matching group");
+    group1->setSearchingEnabled(Group::Disable);
+
+    for (int i = 0; i < 300; ++i) {
+        Entry* entry = new Entry();
+        entry->setTitle(QString("entry %1").arg(i));
+        entry->setNotes(i % 2 ? "odd" : "even");
+        entry->setGroup(i % 3 ? root : (i % 5 ? group1 : group2));
+    }
+
+    EntrySearchTask task;
+    QSignalSpy spyFinished(&task, SIGNAL(finished(int)));
+
+    const QStringList terms = QStringList() << "entr" << "entry 1" << "entry 12" << "matching" << "matching gr"
+                                            << "ev" << "even" << "nothing";
+    for (const QString& term : terms) {
+        QList<Entry*> streamed;
+        auto connection = connect(&task, &EntrySearchTask::resultsReady,
+                                  [&streamed](const QList<Entry*>& entries, bool firstBatch) {
+                                      if (firstBatch) {
+                                          streamed.clear();
+                                      }
+                                      streamed.append(entries);
+                                  });
+
+        task.start(term, root, Qt::CaseInsensitive);
+        QVERIFY(task.isRunning());
+        QTRY_VERIFY(!task.isRunning());
+        disconnect(connection);
+
+        // refined and full searches must yield exactly what EntrySearcher does
+        QList<Entry*> expected = m_entrySearcher.search(term, root, Qt::CaseInsensitive);
+        QCOMPARE(task.results(), expected);
+        QCOMPARE(streamed, expected);
+        QCOMPARE(spyFinished.last().first().toInt(), expected.size());
+    }
+
+    // a newer search cancels the running one
+    task.start("entry", root, Qt::CaseInsensitive);
+    task.start("odd", root, Qt::CaseInsensitive);
+    QTRY_VERIFY(!task.isRunning());
+    QCOMPARE(task.results(), m_entrySearcher.search("odd", root, Qt::CaseInsensitive));
+
+    // a modification restarts the running search instead of dropping it
+    int finishedCount = spyFinished.count();
+    task.start("entry", root, Qt::CaseInsensitive);
+    Entry* added = new Entry();
+    added->setTitle("entry added");
+    added->setGroup(root);
+    task.invalidate();
+    QTRY_VERIFY(!task.isRunning());
+    QCOMPARE(spyFinished.count(), finishedCount + 1);
+    QVERIFY(task.results().contains(added));
+    QCOMPARE(task.results(), m_entrySearcher.search("entry", root, Qt::CaseInsensitive));
+
+    // and a finished search is not refined from stale results
+    task.start("entry x", root, Qt::CaseInsensitive);
+    QTRY_VERIFY(!task.isRunning());
+    QVERIFY(task.results().isEmpty());
+    added->setTitle("entry xyz");
+    task.invalidate();
+    QVERIFY(!task.isRunning());
+    task.start("entry xy", root, Qt::CaseInsensitive);
+    QTRY_VERIFY(!task.isRunning());
+    QCOMPARE(task.results(), QList<Entry*>() << added);
+
+    delete root;
+}
@@ -307,6 +307,9 @@ void TestGroup::testCopyCustomIcon()
     QImage entryIcon(16, 16, QImage::Format_RGB32);
     entryIcon.setPixel(0, 0, qRgb(255, 0, 0));
     dbSource->metadata()->addCustomIcon(entryIconUuid, entryIcon);
+    // icons are looked up by their stored data
+    QCOMPARE(dbSource->metadata()->findCustomIcon(dbSource->metadata()->customIconData(entryIconUuid)),
+             entryIconUuid);
 
     Group* group = new Group();
     group->setParent(dbSource->rootGroup());
@@ -322,11 +325,13 @@ void TestGroup::testCopyCustomIcon()
 
     group->setParent(dbTarget->rootGroup());
     QVERIFY(dbTarget->metadata()->containsCustomIcon(groupIconUuid));
+    QCOMPARE(dbTarget->metadata()->customIconData(groupIconUuid), dbSource->metadata()->customIconData(groupIconUuid));
     QCOMPARE(dbTarget->metadata()->customIcon(groupIconUuid), groupIcon);
     QCOMPARE(group->icon(), groupIcon);
 
     entry->setGroup(dbTarget->rootGroup());
     QVERIFY(dbTarget->metadata()->containsCustomIcon(entryIconUuid));
+    QCOMPARE(dbTarget->metadata()->customIconData(entryIconUuid), dbSource->metadata()->customIconData(entryIconUuid));
     QCOMPARE(dbTarget->metadata()->customIcon(entryIconUuid), entryIcon);
     QCOMPARE(entry->icon(), entryIcon);
 }
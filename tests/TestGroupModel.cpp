@@ -150,3 +150,88 @@ void TestGroupModel::test()
     delete modelTest;
     delete model;
 }
+
+void TestGroupModel::testIndexInParent()
+{
+    Database* db = new Database();
+    Group* root = db->rootGroup();
+    QCOMPARE(root->indexInParent(), -1);
+
+    Group* parent1 = new Group();
+    parent1->setParent(root);
+    Group* parent2 = new Group();
+    parent2->setParent(root);
+
+    QList<Group*> groups;
+    for (int i = 0; i < 10; i++) {
+        Group* group = new Group();
+        group->setParent(parent1);
+        groups.append(group);
+    }
+
+    groups.at(2)->setParent(parent1, 7);
+    groups.at(8)->setParent(parent1, 0);
+    groups.at(5)->setParent(parent2);
+    delete groups.at(0);
+    Group* inserted = new Group();
+    inserted->setParent(parent1, 3);
+
+    for (Group* group : {parent1, parent2}) {
+        const QList<Group*>& children = group->children();
+        for (int i = 0; i < children.size(); i++) {
+            QCOMPARE(children.at(i)->indexInParent(), i);
+        }
+    }
+
+    delete db;
+}
+
+void TestGroupModel::benchmarkLargeTree()
+{
+    QByteArray env = qgetenv("BENCHMARK");
+
+    if (env.isEmpty() || env == "0" || env == "no") {
+        QSKIP("Benchmark skipped. Set env variable BENCHMARK=1 to enable.");
+    }
+
+    Database* db = new Database();
+    Group* root = db->rootGroup();
+
+    QList<Group*> parents;
+    for (int i = 0; i < 4; i++) {
+        Group* parent = new Group();
+        parent->setName(QString("parent%1").arg(i));
+        parent->setParent(root);
+        parents.append(parent);
+    }
+
+    for (int i = 0; i < 10000; i++) {
+        Group* group = new Group();
+        group->setName(QString("group%1").arg(i));
+        group->setParent(parents.at(i % parents.size()));
+    }
+
+    GroupModel* model = new GroupModel(db, this);
+
+    QBENCHMARK {
+        // expand every parent and resolve the parent of each child, as a view does
+        QModelIndex rootIndex = model->index(0, 0);
+        for (int i = 0; i < model->rowCount(rootIndex); i++) {
+            QModelIndex parentIndex = model->index(i, 0, rootIndex);
+            for (int j = 0; j < model->rowCount(parentIndex); j++) {
+                QModelIndex index = model->index(j, 0, parentIndex);
+                QCOMPARE(model->parent(index), parentIndex);
+            }
+        }
+
+        // move a batch of groups between parents and back again
+        for (int i = 0; i < 100; i++) {
+            Group* group = parents.at(0)->children().last();
+            group->setParent(parents.at(1), 0);
+            group->setParent(parents.at(0));
+        }
+    }
+
+    delete model;
+    delete db;
+}
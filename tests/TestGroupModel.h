@@ -27,6 +27,8 @@ class TestGroupModel : public QObject
 private slots:
     void initTestCase();
     void test();
+    void testIndexInParent();
+    void benchmarkLargeTree();
 };
 
 #endif // KEEPASSX_TESTGROUPMODEL_H
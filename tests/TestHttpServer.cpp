@@ -0,0 +1,369 @@
+/*
+ *  Copyright (C) 2017 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "TestHttpServer.h"
+
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSet>
+#include <QTcpSocket>
+#include <QTest>
+
+#include "core/Config.h"
+#include "crypto/Crypto.h"
+#include "crypto/Random.h"
+#include "crypto/SymmetricCipher.h"
+#include "http/HttpSettings.h"
+#include "http/Protocol.h"
+#include "http/Server.h"
+
+QTEST_GUILESS_MAIN(TestHttpServer)
+
+namespace {
+
+const char TestId[] = "load-test";
+
+/**
+ * Server over a synthetic database: site<N>.example.com has N + 1 entries.
+ * Everything is read-only, so it can be called from the worker threads.
+ */
+class SyntheticServer : public KeepassHttpProtocol::Server
+{
+public:
+    SyntheticServer(const QString& key, int sites)
+        : m_key(key)
+        , m_allEntries(0)
+    {
+        for (int i = 0; i < sites; ++i) {
+            QList<KeepassHttpProtocol::Entry> entries;
+            for (int j = 0; j <= i; ++j) {
+                entries << KeepassHttpProtocol::Entry(QString("Site %1").arg(i), QString("user%1").arg(j),
+                                                      QString("password%1").arg(j), QString::number(j));
+            }
+            m_entries.insert(QString("site%1.example.com").arg(i), entries);
+            m_allEntries += entries.size();
+        }
+    }
+
+    virtual bool isDatabaseOpened() const { return true; }
+    virtual bool openDatabase() { return true; }
+    virtual QString getDatabaseRootUuid() { return "root"; }
+    virtual QString getDatabaseRecycleBinUuid() { return "recyclebin"; }
+    virtual QString getKey(const QString& id) { return id == TestId ? m_key : QString(); }
+    virtual QString storeKey(const QString&) { return QString(); }
+
+    virtual QList<KeepassHttpProtocol::Entry> findMatchingEntries(const QString&, const QString& url, const QString&, const QString&)
+    {
+        return m_entries.value(QUrl(url).host());
+    }
+
+    virtual int countMatchingEntries(const QString&, const QString& url, const QString&, const QString&)
+    {
+        return m_entries.value(QUrl(url).host()).size();
+    }
+
+    virtual QList<KeepassHttpProtocol::Entry> searchAllEntries(const QString&, const QString& after, int limit)
+    {
+        QList<KeepassHttpProtocol::Entry> result;
+        for (int i = 0; i < m_allEntries && result.size() < limit; ++i) {
+            const QString uuid = QString("%1").arg(i, 32, 16, QChar('0'));
+            if (uuid > after) {
+                result << KeepassHttpProtocol::Entry(QString("Entry %1").arg(i), "user", QString(), uuid);
+            }
+        }
+        return result;
+    }
+    virtual void addEntry(const QString&, const QString&, const QString&, const QString&, const QString&, const QString&) {}
+    virtual void updateEntry(const QString&, const QString&, const QString&, const QString&, const QString&) {}
+    virtual QString generatePassword() { return QString(); }
+
+private:
+    const QString m_key;
+    QHash<QString, QList<KeepassHttpProtocol::Entry>> m_entries;
+    int m_allEntries;
+};
+
+QByteArray testKey;
+
+QString encrypt(const QString& text, const QByteArray& iv)
+{
+    QByteArray data = text.toUtf8();
+    const int paddingSize = 16 - data.size() % 16;
+    data.append(QByteArray(paddingSize, static_cast<char>(paddingSize)));
+
+    SymmetricCipher cipher(SymmetricCipher::Aes256, SymmetricCipher::Cbc, SymmetricCipher::Encrypt);
+    cipher.init(testKey, iv);
+    bool ok;
+    return QString::fromLatin1(cipher.process(data, &ok).toBase64());
+}
+
+QString decrypt(const QString& text, const QByteArray& iv)
+{
+    SymmetricCipher cipher(SymmetricCipher::Aes256, SymmetricCipher::Cbc, SymmetricCipher::Decrypt);
+    cipher.init(testKey, iv);
+    bool ok;
+    QByteArray data = cipher.process(QByteArray::fromBase64(text.toLatin1()), &ok);
+    data.chop(data.at(data.size() - 1));
+    return QString::fromUtf8(data);
+}
+
+/**
+ * A request with the given extra fields, the ones named in encryptedFields
+ * are encrypted with the request nonce like the Url.
+ */
+QByteArray httpRequest(const QString& requestType, const QString& url, const QByteArray& version = "1.1",
+                       QJsonObject json = QJsonObject(), const QStringList& encryptedFields = QStringList())
+{
+    const QByteArray iv = randomGen()->randomArray(16);
+    const QString nonce = QString::fromLatin1(iv.toBase64());
+
+    for (const QString& field : encryptedFields) {
+        if (json.contains(field)) {
+            json[field] = encrypt(json.value(field).toString(), iv);
+        }
+    }
+
+    json["RequestType"] = requestType;
+    json["Id"] = TestId;
+    json["Nonce"] = nonce;
+    json["Verifier"] = encrypt(nonce, iv);
+    json["Url"] = encrypt(url, iv);
+    const QByteArray body = QJsonDocument(json).toJson(QJsonDocument::Compact);
+
+    return "POST / HTTP/" + version + "\r\n"
+           "Host: localhost\r\n"
+           "Content-Type: application/json\r\n"
+           "Content-Length: " + QByteArray::number(body.size()) + "\r\n"
+           "\r\n" + body;
+}
+
+/**
+ * Read count responses off the socket while the server keeps running in the
+ * same event loop. Headers are returned lower-cased.
+ */
+bool readResponses(QTcpSocket& socket, int count, QList<QByteArray>& headers, QList<QJsonObject>& bodies)
+{
+    QByteArray data;
+    QElapsedTimer timer;
+    timer.start();
+
+    while (bodies.size() < count) {
+        const int headerEnd = data.indexOf("\r\n\r\n");
+        if (headerEnd >= 0) {
+            const QByteArray header = data.left(headerEnd).toLower();
+            const int pos = header.indexOf("content-length:");
+            if (pos < 0) {
+                return false;
+            }
+            int lineEnd = header.indexOf("\r\n", pos);
+            if (lineEnd < 0) {
+                lineEnd = header.size();
+            }
+            const int length = header.mid(pos + 15, lineEnd - pos - 15).trimmed().toInt();
+            if (data.size() >= headerEnd + 4 + length) {
+                headers.append(header);
+                bodies.append(QJsonDocument::fromJson(data.mid(headerEnd + 4, length)).object());
+                data.remove(0, headerEnd + 4 + length);
+                continue;
+            }
+        }
+
+        if (timer.elapsed() > 10000) {
+            return false;
+        }
+        QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+        data.append(socket.readAll());
+    }
+    return true;
+}
+
+bool waitForDisconnected(QTcpSocket& socket)
+{
+    QElapsedTimer timer;
+    timer.start();
+    while (socket.state() != QAbstractSocket::UnconnectedState && timer.elapsed() < 5000) {
+        QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+    }
+    return socket.state() == QAbstractSocket::UnconnectedState;
+}
+
+} // namespace
+
+void TestHttpServer::initTestCase()
+{
+    QVERIFY(Crypto::init());
+    Config::createTempFileInstance();
+    // let the system pick a free port
+    HttpSettings::setHttpPort(0);
+
+    testKey = randomGen()->randomArray(32);
+    m_server.reset(new SyntheticServer(QString::fromLatin1(testKey.toBase64()), 100));
+    m_server->start();
+    m_port = m_server->serverPort();
+    QVERIFY(m_port != 0);
+}
+
+void TestHttpServer::cleanupTestCase()
+{
+    m_server->stop();
+    m_server.reset();
+}
+
+void TestHttpServer::testKeepAlive()
+{
+    QTcpSocket socket;
+    socket.connectToHost("127.0.0.1", m_port);
+
+    QList<QByteArray> headers;
+    QList<QJsonObject> bodies;
+    socket.write(httpRequest("get-logins-count", "https://site2.example.com/login"));
+    QVERIFY(readResponses(socket, 1, headers, bodies));
+    QVERIFY(headers[0].startsWith("http/1.1 200"));
+    QVERIFY(headers[0].contains("connection: keep-alive"));
+    QCOMPARE(bodies[0].value("Success").toBool(), true);
+    QCOMPARE(bodies[0].value("Count").toInt(), 3);
+
+    // the same connection takes the next request
+    QCOMPARE(socket.state(), QAbstractSocket::ConnectedState);
+    socket.write(httpRequest("get-logins", "https://site4.example.com/login"));
+    QVERIFY(readResponses(socket, 1, headers, bodies));
+    QCOMPARE(bodies[1].value("Count").toInt(), 5);
+    QCOMPARE(socket.state(), QAbstractSocket::ConnectedState);
+}
+
+void TestHttpServer::testCloseConnection()
+{
+    QTcpSocket socket;
+    socket.connectToHost("127.0.0.1", m_port);
+
+    // HTTP/1.0 without keep-alive closes after the response
+    QList<QByteArray> headers;
+    QList<QJsonObject> bodies;
+    socket.write(httpRequest("get-logins-count", "https://site0.example.com/", "1.0"));
+    QVERIFY(readResponses(socket, 1, headers, bodies));
+    QVERIFY(headers[0].contains("connection: close"));
+    QCOMPARE(bodies[0].value("Count").toInt(), 1);
+    QVERIFY(waitForDisconnected(socket));
+}
+
+void TestHttpServer::testPipelining()
+{
+    QTcpSocket socket;
+    socket.connectToHost("127.0.0.1", m_port);
+
+    QByteArray requests;
+    for (int i = 20; i > 0; --i) {
+        requests.append(httpRequest(i % 2 ? "get-logins" : "get-logins-count",
+                                    QString("https://site%1.example.com/").arg(i)));
+    }
+    socket.write(requests);
+
+    // replies come back in request order even though they are computed concurrently
+    QList<QByteArray> headers;
+    QList<QJsonObject> bodies;
+    QVERIFY(readResponses(socket, 20, headers, bodies));
+    for (int i = 0; i < 20; ++i) {
+        QCOMPARE(bodies[i].value("Success").toBool(), true);
+        QCOMPARE(bodies[i].value("Count").toInt(), 21 - i);
+    }
+}
+
+void TestHttpServer::testGetAllLoginsPaged()
+{
+    QTcpSocket socket;
+    socket.connectToHost("127.0.0.1", m_port);
+
+    // without a Limit, or with one above the maximum, a single page is returned
+    QJsonObject largePage;
+    largePage["Limit"] = 100000;
+    socket.write(httpRequest("get-all-logins", QString()));
+    socket.write(httpRequest("get-all-logins", QString(), "1.1", largePage));
+
+    QList<QByteArray> headers;
+    QList<QJsonObject> bodies;
+    QVERIFY(readResponses(socket, 2, headers, bodies));
+    for (const QJsonObject& body : bodies) {
+        QCOMPARE(body.value("Count").toInt(), 500);
+        QCOMPARE(body.value("Entries").toArray().size(), 500);
+        QVERIFY(body.value("Next").isString());
+    }
+
+    // follow Next until the last page, every entry comes exactly once
+    QSet<QString> uuids;
+    QString after;
+    int pages = 0;
+    do {
+        QJsonObject page;
+        page["Limit"] = 400;
+        if (!after.isEmpty()) {
+            page["After"] = after;
+        }
+        socket.write(httpRequest("get-all-logins", QString(), "1.1", page, QStringList() << "After"));
+
+        headers.clear();
+        bodies.clear();
+        QVERIFY(readResponses(socket, 1, headers, bodies));
+        const QJsonObject& body = bodies.first();
+        const QByteArray responseIv = QByteArray::fromBase64(body.value("Nonce").toString().toLatin1());
+        const QJsonArray entries = body.value("Entries").toArray();
+        QVERIFY(entries.size() <= 400);
+        for (const QJsonValue& entry : entries) {
+            uuids.insert(decrypt(entry.toObject().value("Uuid").toString(), responseIv));
+        }
+        after = body.value("Next").isString() ? decrypt(body.value("Next").toString(), responseIv) : QString();
+        ++pages;
+    } while (!after.isEmpty() && pages < 100);
+
+    QCOMPARE(uuids.size(), 5050);
+    QCOMPARE(pages, 13);
+}
+
+void TestHttpServer::benchmarkLoad()
+{
+    QByteArray env = qgetenv("BENCHMARK");
+
+    if (env.isEmpty() || env == "0" || env == "no") {
+        QSKIP("Benchmark skipped. Set env variable BENCHMARK=1 to enable.");
+    }
+
+    const int clients = 8;
+    const int requestsPerClient = 200;
+
+    QBENCHMARK {
+        QList<QTcpSocket*> sockets;
+        for (int i = 0; i < clients; ++i) {
+            QTcpSocket* socket = new QTcpSocket();
+            socket->connectToHost("127.0.0.1", m_port);
+            QByteArray requests;
+            for (int j = 0; j < requestsPerClient; ++j) {
+                requests.append(httpRequest(j % 4 ? "get-logins-count" : "get-logins",
+                                            QString("https://site%1.example.com/").arg((i * 7 + j) % 100)));
+            }
+            socket->write(requests);
+            sockets.append(socket);
+        }
+
+        for (QTcpSocket* socket : sockets) {
+            QList<QByteArray> headers;
+            QList<QJsonObject> bodies;
+            QVERIFY(readResponses(*socket, requestsPerClient, headers, bodies));
+        }
+        qDeleteAll(sockets);
+    }
+}
@@ -117,6 +117,11 @@ void TestKeePass2Format::testXmlCustomIcons()
     QCOMPARE(icon.width(), 16);
     QCOMPARE(icon.height(), 16);
 
+    // icons are kept encoded and decoded on demand
+    QByteArray iconData = m_xmlDb->metadata()->customIconData(uuid);
+    QVERIFY(!iconData.isEmpty());
+    QCOMPARE(QImage::fromData(iconData), icon);
+
     for (int x = 0; x < 16; x++) {
         for (int y = 0; y < 16; y++) {
             QRgb rgb = icon.pixel(x, y);
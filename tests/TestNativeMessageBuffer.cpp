@@ -0,0 +1,234 @@
+/*
+ *  Copyright (C) 2017 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "TestNativeMessageBuffer.h"
+
+#include <QElapsedTimer>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QTest>
+
+#include "browser/NativeMessageBuffer.h"
+#include "proxy/NativeMessageRelay.h"
+
+QTEST_GUILESS_MAIN(TestNativeMessageBuffer)
+
+namespace {
+
+/**
+ * Stands in for KeePassXC behind the proxy socket: answers every message it
+ * receives with the same message, and reassembles what the proxy writes to
+ * stdout.
+ */
+class EchoPeer : public QObject
+{
+public:
+    EchoPeer(const QString& serverName, NativeMessageRelay* relay)
+        : m_peer(nullptr)
+        , m_received(0)
+    {
+        QLocalServer::removeServer(serverName);
+        m_server.listen(serverName);
+        connect(&m_server, &QLocalServer::newConnection, this, [this]() {
+            m_peer = m_server.nextPendingConnection();
+            connect(m_peer, &QLocalSocket::readyRead, this, [this]() {
+                m_requests.append(m_peer->readAll());
+                QByteArray message;
+                while (m_requests.takeMessage(message)) {
+                    m_peer->write(NativeMessageBuffer::frame(message));
+                }
+            });
+        });
+        connect(relay, &NativeMessageRelay::localMessage, this, [this](const char* data, qint64 size) {
+            m_replies.append(data, size);
+            QByteArray message;
+            while (m_replies.takeMessage(message)) {
+                m_messages.append(message);
+                ++m_received;
+            }
+        });
+    }
+
+    bool isListening() const
+    {
+        return m_server.isListening();
+    }
+
+    // wait until count replies have arrived since the peer was created
+    bool waitForReplies(int count, int timeout = 10000)
+    {
+        QElapsedTimer timer;
+        timer.start();
+        while (m_received < count && !timer.hasExpired(timeout)) {
+            QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+        }
+        return m_received >= count;
+    }
+
+    QList<QByteArray> takeMessages()
+    {
+        QList<QByteArray> messages;
+        messages.swap(m_messages);
+        return messages;
+    }
+
+private:
+    QLocalServer m_server;
+    QLocalSocket* m_peer;
+    NativeMessageBuffer m_requests;
+    NativeMessageBuffer m_replies;
+    QList<QByteArray> m_messages;
+    int m_received;
+};
+
+}
+
+void TestNativeMessageBuffer::testFraming()
+{
+    const QByteArray message("{\"action\":\"get-databasehash\"}");
+    const QByteArray frame = NativeMessageBuffer::frame(message);
+    QCOMPARE(frame.size(), message.size() + 4);
+
+    NativeMessageBuffer buffer;
+    QByteArray result;
+    buffer.append(frame + frame);
+    QVERIFY(buffer.takeMessage(result));
+    QCOMPARE(result, message);
+    QVERIFY(buffer.takeMessage(result));
+    QCOMPARE(result, message);
+    QVERIFY(!buffer.takeMessage(result));
+    QVERIFY(!buffer.hasError());
+
+    buffer.append(NativeMessageBuffer::frame(QByteArray()));
+    QVERIFY(buffer.takeMessage(result));
+    QVERIFY(result.isEmpty());
+}
+
+void TestNativeMessageBuffer::testFragmentedStream()
+{
+    QList<QByteArray> messages;
+    QByteArray stream;
+    for (int i = 0; i < 20; ++i) {
+        messages.append(QByteArray(i * 37, 'a' + (i % 26)));
+        stream.append(NativeMessageBuffer::frame(messages.last()));
+    }
+
+    // feed the stream in odd chunk sizes so frames and prefixes are split
+    NativeMessageBuffer buffer;
+    QList<QByteArray> received;
+    QByteArray message;
+    for (int pos = 0; pos < stream.size(); pos += 3) {
+        buffer.append(stream.constData() + pos, qMin(3, stream.size() - pos));
+        while (buffer.takeMessage(message)) {
+            received.append(message);
+        }
+    }
+
+    QCOMPARE(received, messages);
+    QVERIFY(!buffer.hasError());
+}
+
+void TestNativeMessageBuffer::testOversizedMessage()
+{
+    const quint32 length = NativeMessageBuffer::MaxMessageSize + 1;
+
+    NativeMessageBuffer buffer;
+    QByteArray message;
+    buffer.append(reinterpret_cast<const char*>(&length), sizeof(length));
+    QVERIFY(!buffer.takeMessage(message));
+    QVERIFY(buffer.hasError());
+
+    buffer.append(NativeMessageBuffer::frame("test"));
+    QVERIFY(!buffer.takeMessage(message));
+}
+
+void TestNativeMessageBuffer::testUnframedMessage()
+{
+    // bare JSON as sent by older proxies
+    QVERIFY(NativeMessageBuffer::isUnframed("{\"action\":\"get-databasehash\"}"));
+    QVERIFY(NativeMessageBuffer::isUnframed("{ \"a"));
+    QVERIFY(!NativeMessageBuffer::isUnframed("{\"a"));
+
+    // a frame whose length starts with '{' is still a frame
+    QVERIFY(!NativeMessageBuffer::isUnframed(NativeMessageBuffer::frame(QByteArray(0x7b, 'x'))));
+    QVERIFY(!NativeMessageBuffer::isUnframed(NativeMessageBuffer::frame(QByteArray(0x227b, 'x'))));
+    QVERIFY(!NativeMessageBuffer::isUnframed(NativeMessageBuffer::frame("{\"action\":\"test\"}")));
+}
+
+void TestNativeMessageBuffer::testProxyRelay()
+{
+    const QString serverName = QString("keepassxc-test-relay-%1").arg(QCoreApplication::applicationPid());
+    QLocalSocket socket;
+    NativeMessageRelay relay(&socket);
+    EchoPeer peer(serverName, &relay);
+    QVERIFY(peer.isListening());
+
+    // messages from the browser arriving before the connection are kept
+    QList<QByteArray> messages;
+    messages << "{\"action\":\"get-databasehash\"}" << "{\"action\":\"test-associate\"}";
+    relay.relayStdIn(NativeMessageBuffer::frame(messages.at(0)));
+    socket.connectToServer(serverName);
+    relay.relayStdIn(NativeMessageBuffer::frame(messages.at(1)));
+    QVERIFY(peer.waitForReplies(2));
+    QCOMPARE(peer.takeMessages(), messages);
+
+    // frames split across stdin reads are passed on unchanged
+    const QByteArray large(3 * 64 * 1024 + 17, 'x');
+    const QByteArray frame = NativeMessageBuffer::frame(large);
+    for (int pos = 0; pos < frame.size(); pos += 1000) {
+        relay.relayStdIn(frame.mid(pos, 1000));
+    }
+    QVERIFY(peer.waitForReplies(3));
+    QCOMPARE(peer.takeMessages(), QList<QByteArray>() << large);
+}
+
+void TestNativeMessageBuffer::benchmarkSocketRelay()
+{
+    QByteArray env = qgetenv("BENCHMARK");
+
+    if (env.isEmpty() || env == "0" || env == "no") {
+        QSKIP("Benchmark skipped. Set env variable BENCHMARK=1 to enable.");
+    }
+
+    // the proxy relay against a stand-in for KeePassXC that echoes every message
+    const QString serverName = QString("keepassxc-test-%1").arg(QCoreApplication::applicationPid());
+    QLocalSocket socket;
+    NativeMessageRelay relay(&socket);
+    EchoPeer peer(serverName, &relay);
+    QVERIFY(peer.isListening());
+    socket.connectToServer(serverName);
+    QVERIFY(socket.waitForConnected(1000));
+
+    const QByteArray message(512 * 1024, 'x');
+    const QByteArray frame = NativeMessageBuffer::frame(message);
+    const int count = 32;
+    int expected = 0;
+
+    QBENCHMARK {
+        // stdin is read in chunks of the proxy's read buffer
+        for (int i = 0; i < count; ++i) {
+            for (int pos = 0; pos < frame.size(); pos += 64 * 1024) {
+                relay.relayStdIn(QByteArray::fromRawData(frame.constData() + pos, qMin(64 * 1024, frame.size() - pos)));
+            }
+        }
+        expected += count;
+        QVERIFY(peer.waitForReplies(expected));
+        const QList<QByteArray> replies = peer.takeMessages();
+        QCOMPARE(replies.size(), count);
+        QCOMPARE(replies.last(), message);
+    }
+}
@@ -0,0 +1,185 @@
+/*
+ *  Copyright (C) 2017 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "TestPasswordAudit.h"
+
+#include <QSignalSpy>
+#include <QTest>
+
+#include "modeltest.h"
+#include "core/Database.h"
+#include "core/Entry.h"
+#include "core/Group.h"
+#include "core/Metadata.h"
+#include "core/PasswordAudit.h"
+#include "crypto/Crypto.h"
+#include "gui/entry/PasswordAuditModel.h"
+#include "zxcvbn/zxcvbn.h"
+
+QTEST_GUILESS_MAIN(TestPasswordAudit)
+
+namespace
+{
+    QHash<QString, PasswordAudit::Result> resultsByTitle(const QSignalSpy& spy)
+    {
+        QHash<QString, PasswordAudit::Result> results;
+        for (const QList<QVariant>& arguments : spy) {
+            const PasswordAudit::Result result = arguments.at(0).value<PasswordAudit::Result>();
+            results.insert(result.entry->title(), result);
+        }
+        return results;
+    }
+}
+
+void TestPasswordAudit::initTestCase()
+{
+    qRegisterMetaType<PasswordAudit::Result>();
+    qRegisterMetaType<QModelIndex>("QModelIndex");
+    QVERIFY(Crypto::init());
+}
+
+void TestPasswordAudit::init()
+{
+    m_db = new Database();
+
+    addEntry("weak", "password");
+    addEntry("reused1", "Xk9#qLm2$vPz8!wR4tYb");
+    addEntry("reused2", "Xk9#qLm2$vPz8!wR4tYb");
+    addEntry("empty", "");
+
+    Entry* expired = addEntry("expired", "Vb7*nQ2@zL5^wE9&hJ3");
+    expired->setExpires(true);
+    expired->setExpiryTime(QDateTime::currentDateTimeUtc().addDays(-1));
+
+    Entry* stale = addEntry("stale", "Mq4!tR8#yU2$iO6%pA1");
+    TimeInfo timeInfo = stale->timeInfo();
+    timeInfo.setLastModificationTime(QDateTime::currentDateTimeUtc().addDays(-400));
+    stale->setTimeInfo(timeInfo);
+
+    Group* recycleBin = new Group();
+    recycleBin->setParent(m_db->rootGroup());
+    m_db->metadata()->setRecycleBin(recycleBin);
+    Entry* recycled = new Entry();
+    recycled->setTitle("recycled");
+    recycled->setPassword("password");
+    recycled->setGroup(recycleBin);
+}
+
+void TestPasswordAudit::cleanup()
+{
+    delete m_db;
+}
+
+Entry* TestPasswordAudit::addEntry(const QString& title, const QString& password)
+{
+    Entry* entry = new Entry();
+    entry->setUuid(Uuid::random());
+    entry->setTitle(title);
+    entry->setPassword(password);
+    entry->setGroup(m_db->rootGroup());
+    return entry;
+}
+
+void TestPasswordAudit::testAudit()
+{
+    PasswordAudit audit;
+    QSignalSpy resultSpy(&audit, SIGNAL(resultReady(PasswordAudit::Result)));
+    QSignalSpy finishedSpy(&audit, SIGNAL(finished()));
+
+    audit.start(m_db);
+    QTRY_COMPARE(finishedSpy.count(), 1);
+
+    // entries without password and in the recycle bin are skipped
+    QCOMPARE(audit.entryCount(), 5);
+    QCOMPARE(resultSpy.count(), 5);
+
+    const QHash<QString, PasswordAudit::Result> results = resultsByTitle(resultSpy);
+    QCOMPARE(results.value("weak").flags, PasswordAudit::Flags(PasswordAudit::WeakPassword));
+    QCOMPARE(results.value("weak").entropy, ZxcvbnMatch("password", nullptr, nullptr));
+    QCOMPARE(results.value("reused1").flags, PasswordAudit::Flags(PasswordAudit::ReusedPassword));
+    QCOMPARE(results.value("reused1").reuseCount, 2);
+    QCOMPARE(results.value("reused2").reuseCount, 2);
+    QCOMPARE(results.value("expired").flags, PasswordAudit::Flags(PasswordAudit::ExpiredEntry));
+    QCOMPARE(results.value("expired").reuseCount, 1);
+    QCOMPARE(results.value("stale").flags, PasswordAudit::Flags(PasswordAudit::StaleEntry));
+
+    resultSpy.clear();
+    finishedSpy.clear();
+    audit.setStaleDays(0);
+    audit.clearCache();
+    audit.start(m_db);
+    QTRY_COMPARE(finishedSpy.count(), 1);
+    QCOMPARE(resultsByTitle(resultSpy).value("stale").flags, PasswordAudit::Flags(PasswordAudit::NoFlags));
+}
+
+void TestPasswordAudit::testCache()
+{
+    PasswordAudit audit;
+    QSignalSpy resultSpy(&audit, SIGNAL(resultReady(PasswordAudit::Result)));
+    QSignalSpy finishedSpy(&audit, SIGNAL(finished()));
+
+    audit.start(m_db);
+    QCOMPARE(resultSpy.count(), 0);
+    QTRY_COMPARE(finishedSpy.count(), 1);
+    QCOMPARE(resultSpy.count(), 5);
+
+    const QList<Entry*> entries = m_db->rootGroup()->entries();
+    for (Entry* entry : entries) {
+        if (entry->title() == "weak") {
+            entry->setPassword("Zx8&cV3*bN6(mK1)lP4");
+        }
+    }
+
+    // unchanged entries are reported right away, only the modified one is estimated
+    resultSpy.clear();
+    finishedSpy.clear();
+    audit.start(m_db);
+    QCOMPARE(resultSpy.count(), 4);
+    QTRY_COMPARE(finishedSpy.count(), 1);
+    QCOMPARE(resultSpy.count(), 5);
+    QCOMPARE(resultsByTitle(resultSpy).value("weak").flags, PasswordAudit::Flags(PasswordAudit::NoFlags));
+}
+
+void TestPasswordAudit::testModel()
+{
+    PasswordAudit audit;
+    PasswordAuditModel model(&audit);
+    ModelTest modelTest(&model);
+    QSignalSpy finishedSpy(&audit, SIGNAL(finished()));
+
+    audit.start(m_db);
+    QTRY_COMPARE(finishedSpy.count(), 1);
+    QCOMPARE(model.rowCount(), 5);
+
+    for (int row = 0; row < model.rowCount(); ++row) {
+        const QModelIndex index = model.index(row, PasswordAuditModel::Title);
+        const QString title = model.data(index).toString();
+        QCOMPARE(model.entryFromIndex(index)->title(), title);
+
+        if (title == "reused1") {
+            QCOMPARE(model.data(model.index(row, PasswordAuditModel::Reused)).toString(), QString("2"));
+            QCOMPARE(model.data(model.index(row, PasswordAuditModel::Reused), PasswordAuditModel::SortRole).toInt(), 2);
+        } else if (title == "weak") {
+            QCOMPARE(model.data(model.index(row, PasswordAuditModel::Quality)).toString(), QString("Poor"));
+        } else if (title == "expired") {
+            QCOMPARE(model.data(model.index(row, PasswordAuditModel::Status)).toString(), QString("Expired"));
+        }
+    }
+
+    model.clear();
+    QCOMPARE(model.rowCount(), 0);
+}
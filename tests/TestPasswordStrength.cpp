@@ -0,0 +1,169 @@
+/*
+ *  Copyright (C) 2017 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "TestPasswordStrength.h"
+
+#include <QSignalSpy>
+#include <QTest>
+
+#include <random>
+
+#include "core/Global.h"
+#include "core/PasswordStrengthTask.h"
+#include "zxcvbn/zxcvbn.h"
+
+QTEST_GUILESS_MAIN(TestPasswordStrength)
+
+namespace
+{
+    void compareMatches(ZxcMatch_t* expected, ZxcMatch_t* actual)
+    {
+        for (; expected && actual; expected = expected->Next, actual = actual->Next) {
+            QCOMPARE(actual->Begin, expected->Begin);
+            QCOMPARE(actual->Length, expected->Length);
+            QCOMPARE(static_cast<int>(actual->Type), static_cast<int>(expected->Type));
+            QCOMPARE(actual->Entrpy, expected->Entrpy);
+        }
+        QVERIFY(!expected && !actual);
+    }
+
+    int cancelAfter(void* calls)
+    {
+        return --*static_cast<int*>(calls) < 0;
+    }
+}
+
+void TestPasswordStrength::testIncrementalMatch()
+{
+    const QByteArray typed = "Tr0ub4dor&3correcthorse19/08/1987qwertyzyx0987aaaa";
+
+    QList<QByteArray> passwords;
+    for (int i = 1; i <= typed.size(); ++i) {
+        passwords << typed.left(i);
+    }
+    // backspace, edits in the middle and at the begining
+    passwords << typed.left(20) << typed.left(12) << "x" + typed << typed.left(15) + "7" + typed.mid(15)
+              << typed.left(30) + typed.mid(31) << "password" << QByteArray() << "passw\xc3\xb6rd";
+
+    ZxcState_t* state = ZxcvbnNewState();
+    for (const QByteArray& password : asConst(passwords)) {
+        ZxcMatch_t* expectedInfo = nullptr;
+        ZxcMatch_t* actualInfo = nullptr;
+        const double expected = ZxcvbnMatch(password.constData(), nullptr, &expectedInfo);
+        const double actual = ZxcvbnMatchState(password.constData(), nullptr, &actualInfo, state, nullptr, nullptr);
+
+        QCOMPARE(actual, expected);
+        compareMatches(expectedInfo, actualInfo);
+        ZxcvbnFreeInfo(expectedInfo);
+        ZxcvbnFreeInfo(actualInfo);
+    }
+    ZxcvbnFreeState(state);
+}
+
+/**
+ * Random typing, deleting and pasting with user words, compared against a
+ * full evaluation after every edit. Pasted words make user and dictionary
+ * matches cross the edit point, so both the reused and the recomputed
+ * matches at each start are exercised.
+ */
+void TestPasswordStrength::testRandomEdits()
+{
+    const char* userDict[] = {"keepassxc", "alice", "hunter2", "1987", "\xc3\xb6l", nullptr};
+    const QList<QByteArray> pastes = QList<QByteArray>() << "keepass" << "keepassxc" << "alice" << "hunter2" << "Hunter2"
+                                                         << "1987" << "password" << "qwerty" << "\xc3\xb6l";
+    const QByteArray alphabet = "aeiklnoprstxAK1279!&/ ";
+
+    std::mt19937 random(4711);
+    QByteArray password;
+    ZxcState_t* state = ZxcvbnNewState();
+
+    for (int i = 0; i < 3000; ++i) {
+        const int pos = password.isEmpty() ? 0 : static_cast<int>(random() % (password.size() + 1));
+        switch (random() % 6) {
+        case 0:
+        case 1:
+            password.append(alphabet.at(random() % alphabet.size()));
+            break;
+        case 2:
+            password.insert(pos, alphabet.at(random() % alphabet.size()));
+            break;
+        case 3:
+            password.insert(pos, pastes.at(random() % pastes.size()));
+            break;
+        case 4:
+            password.chop(1 + random() % 3);
+            break;
+        case 5:
+            password.remove(pos, 1 + random() % 4);
+            break;
+        }
+        if (password.size() > 40) {
+            password = password.right(20);
+        }
+
+        ZxcMatch_t* expectedInfo = nullptr;
+        ZxcMatch_t* actualInfo = nullptr;
+        const double expected = ZxcvbnMatch(password.constData(), userDict, &expectedInfo);
+        const double actual = ZxcvbnMatchState(password.constData(), userDict, &actualInfo, state, nullptr, nullptr);
+
+        compareMatches(expectedInfo, actualInfo);
+        ZxcvbnFreeInfo(expectedInfo);
+        ZxcvbnFreeInfo(actualInfo);
+        QVERIFY2(!QTest::currentTestFailed(), password.constData());
+        QCOMPARE(actual, expected);
+    }
+    ZxcvbnFreeState(state);
+}
+
+void TestPasswordStrength::testCancel()
+{
+    ZxcState_t* state = ZxcvbnNewState();
+    QVERIFY(ZxcvbnMatchState("correcthorse", nullptr, nullptr, state, nullptr, nullptr) > 0.0);
+
+    int calls = 3;
+    ZxcMatch_t* info = nullptr;
+    QVERIFY(ZxcvbnMatchState("correcthorsebattery", nullptr, &info, state, &cancelAfter, &calls) < 0.0);
+    QVERIFY(!info);
+
+    // a cancelled call leaves the state of the previous password behind
+    const char* password = "correcthorsebatterystaple";
+    QCOMPARE(ZxcvbnMatchState(password, nullptr, nullptr, state, nullptr, nullptr),
+             ZxcvbnMatch(password, nullptr, nullptr));
+    ZxcvbnFreeState(state);
+}
+
+void TestPasswordStrength::testStrengthTask()
+{
+    PasswordStrengthTask task;
+    QSignalSpy spy(&task, SIGNAL(finished(double)));
+
+    const QString typed = "correcthorsebatterystaple";
+    for (int i = 1; i <= typed.size(); ++i) {
+        task.start(typed.left(i));
+    }
+
+    // only the last password is reported
+    QTRY_COMPARE(spy.count(), 1);
+    QCOMPARE(spy.first().at(0).toDouble(), ZxcvbnMatch(typed.toUtf8().constData(), nullptr, nullptr));
+
+    spy.clear();
+    task.start(typed);
+    task.cancel();
+    QTRY_VERIFY(!task.isRunning());
+    QTest::qWait(50);
+    QVERIFY(spy.isEmpty());
+}
@@ -0,0 +1,112 @@
+/*
+ *  Copyright (C) 2017 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "TestPublicSuffixList.h"
+
+#include <QTest>
+
+#include "core/PublicSuffixList.h"
+
+QTEST_GUILESS_MAIN(TestPublicSuffixList)
+
+void TestPublicSuffixList::initTestCase()
+{
+    QVERIFY(!publicSuffixList()->isEmpty());
+}
+
+void TestPublicSuffixList::testPublicSuffix_data()
+{
+    QTest::addColumn<QString>("host");
+    QTest::addColumn<QString>("suffix");
+    QTest::addColumn<QString>("domain");
+
+    QTest::newRow("SingleLabelSuffix") << "www.example.com" << "com" << "example.com";
+    QTest::newRow("MultiLabelSuffix") << "a.b.c.example.co.uk" << "co.uk" << "example.co.uk";
+    QTest::newRow("Suffix") << "co.uk" << "co.uk" << QString();
+    QTest::newRow("PrivateSuffix") << "user.github.io" << "github.io" << "user.github.io";
+    QTest::newRow("Wildcard") << "www.shop.ck" << "shop.ck" << "www.shop.ck";
+    QTest::newRow("Exception") << "www.ck" << "ck" << "www.ck";
+    QTest::newRow("ExceptionBelowWildcard") << "www.city.kawasaki.jp" << "kawasaki.jp" << "city.kawasaki.jp";
+    QTest::newRow("UnknownTld") << "intranet.example.internal" << "internal" << "example.internal";
+    QTest::newRow("UpperCase") << "WWW.Example.CO.UK" << "co.uk" << "example.co.uk";
+    QTest::newRow("TrailingDot") << "www.example.com." << "com" << "example.com";
+    QTest::newRow("Idn") << QString::fromUtf8("пример.рф") << "xn--p1ai" << "xn--e1afmkfd.xn--p1ai";
+}
+
+void TestPublicSuffixList::testPublicSuffix()
+{
+    QFETCH(QString, host);
+    QFETCH(QString, suffix);
+    QFETCH(QString, domain);
+
+    QCOMPARE(publicSuffixList()->publicSuffix(host), suffix);
+    QCOMPARE(publicSuffixList()->registrableDomain(host), domain);
+}
+
+void TestPublicSuffixList::testHostLevels()
+{
+    PublicSuffixList* list = publicSuffixList();
+
+    QCOMPARE(list->hostLevels("a.b.c.example.co.uk"),
+             QStringList() << "a.b.c.example.co.uk" << "b.c.example.co.uk" << "c.example.co.uk" << "example.co.uk");
+    QCOMPARE(list->hostLevels("www.example.com"), QStringList() << "www.example.com" << "example.com");
+    QCOMPARE(list->hostLevels("Login.Example.com"), QStringList() << "login.example.com" << "example.com");
+    QCOMPARE(list->hostLevels("co.uk"), QStringList() << "co.uk");
+    QCOMPARE(list->hostLevels("localhost"), QStringList() << "localhost");
+    QCOMPARE(list->hostLevels("192.168.1.10"), QStringList() << "192.168.1.10");
+    QCOMPARE(list->hostLevels(QString::fromUtf8("www.пример.рф")),
+             QStringList() << QString::fromUtf8("www.пример.рф") << QString::fromUtf8("пример.рф"));
+    QVERIFY(list->hostLevels("").isEmpty());
+    QVERIFY(list->hostLevels("a..example.com").isEmpty());
+}
+
+void TestPublicSuffixList::testMissingList()
+{
+    // without rules only the top-level domain is a public suffix
+    PublicSuffixList list("does-not-exist.dat");
+    QVERIFY(list.isEmpty());
+    QCOMPARE(list.publicSuffix("www.example.co.uk"), QString("uk"));
+    QCOMPARE(list.hostLevels("www.example.com"), QStringList() << "www.example.com" << "example.com");
+}
+
+void TestPublicSuffixList::benchmarkHostLevels()
+{
+    QByteArray env = qgetenv("BENCHMARK");
+
+    if (env.isEmpty() || env == "0" || env == "no") {
+        QSKIP("Benchmark skipped. Set env variable BENCHMARK=1 to enable.");
+    }
+
+    QStringList hosts;
+    for (int i = 0; i < 1000; ++i) {
+        hosts << QString("login.app%1.example.co.uk").arg(i)
+              << QString("www.site%1.com").arg(i)
+              << QString("user%1.github.io").arg(i);
+    }
+
+    PublicSuffixList* list = publicSuffixList();
+    int levels = 0;
+
+    QBENCHMARK {
+        levels = 0;
+        for (const QString& host : hosts) {
+            levels += list->hostLevels(host).size();
+        }
+    }
+
+    QCOMPARE(levels, 1000 * (3 + 2 + 1));
+}
@@ -19,8 +19,11 @@
 
 #include "core/Endian.h"
 #include "core/Global.h"
+#include "crypto/Crypto.h"
 
+#include <QSet>
 #include <QTest>
+#include <QtConcurrent>
 
 QTEST_GUILESS_MAIN(TestRandom)
 
@@ -71,6 +74,48 @@ void TestRandom::testUIntRange()
     QCOMPARE(randomGen()->randomUIntRange(100, 200), 142U);
 }
 
+void TestRandom::testGcryptBackend()
+{
+    QVERIFY(Crypto::init());
+
+    RandomBackendGcrypt backend;
+
+    // odd sizes that straddle buffer refills and the reseed interval
+    QByteArray data(3 * 1024 * 1024 + 7, '\0');
+    int pos = 0;
+    for (int size = 1; pos < data.size(); size = (size * 7 + 3) % 5000 + 1) {
+        const int len = qMin(size, data.size() - pos);
+        backend.randomize(data.data() + pos, len);
+        pos += len;
+    }
+
+    int counts[256] = {};
+    for (char byte : asConst(data)) {
+        ++counts[static_cast<quint8>(byte)];
+    }
+    const int expected = data.size() / 256;
+    for (int count : counts) {
+        QVERIFY(count > expected * 9 / 10 && count < expected * 11 / 10);
+    }
+
+    // the backend can be used from several threads at once
+    QList<QFuture<QByteArray>> futures;
+    for (int i = 0; i < 4; ++i) {
+        futures << QtConcurrent::run([&backend]() {
+            QByteArray block(64 * 1024, '\0');
+            for (int pos = 0; pos < block.size(); pos += 4) {
+                backend.randomize(block.data() + pos, 4);
+            }
+            return block;
+        });
+    }
+    QSet<QByteArray> blocks;
+    for (QFuture<QByteArray>& future : futures) {
+        blocks.insert(future.result().left(32));
+    }
+    QCOMPARE(blocks.size(), 4);
+}
+
 
 RandomBackendTest::RandomBackendTest()
     : m_bytesIndex(0)
@@ -42,6 +42,7 @@ private slots:
     void initTestCase();
     void testUInt();
     void testUIntRange();
+    void testGcryptBackend();
 
 private:
     RandomBackendTest* m_backend;
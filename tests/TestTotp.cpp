@@ -19,12 +19,15 @@
 #include "TestTotp.h"
 
 #include <QDateTime>
+#include <QSignalSpy>
 #include <QTest>
 #include <QTextCodec>
 #include <QTime>
 #include <QtEndian>
 
+#include "core/Entry.h"
 #include "crypto/Crypto.h"
+#include "totp/TotpService.h"
 #include "totp/totp.h"
 
 QTEST_GUILESS_MAIN(TestTotp)
@@ -169,3 +172,44 @@ void TestTotp::testSteamTotp()
     time = 1511200714;
     QCOMPARE(Totp::generateTotp(seed, time, Totp::ENCODER_STEAM, 30), QString("9P3VP"));
 }
+
+void TestTotp::testTotpService()
+{
+    Entry entry;
+    entry.attributes()->set("otp", "otpauth://totp/test?secret=GEZDGNBVGY3TQOJQGEZDGNBVGY3TQOJQ");
+
+    QString code = totpService()->code(&entry);
+    QString expected = entry.totp();
+    if (code != expected) {
+        // the time step rolled over between the two lookups
+        code = totpService()->code(&entry);
+    }
+    QCOMPARE(code, expected);
+    QCOMPARE(code.size(), 6);
+
+    // modifying the entry drops the cached secret
+    QSignalSpy changedSpy(totpService(), SIGNAL(codesChanged()));
+    entry.attributes()->set("otp", "otpauth://totp/test?secret=GEZDGNBVGY3TQOJQGEZDGNBVGY3TQOJQ&digits=8");
+    QCOMPARE(changedSpy.count(), 1);
+    QCOMPARE(totpService()->code(&entry).size(), 8);
+
+    entry.attributes()->set("otp", "otpauth://totp/test?secret=1");
+    QCOMPARE(totpService()->code(&entry), entry.totp());
+
+    // views are notified when the time step rolls over
+    entry.attributes()->set("otp", "otpauth://totp/test?secret=GEZDGNBVGY3TQOJQGEZDGNBVGY3TQOJQ&period=1");
+    totpService()->code(&entry);
+    changedSpy.clear();
+    QVERIFY(changedSpy.wait(2500));
+
+    QScopedPointer<Entry> other(new Entry());
+    other->attributes()->set("otp", "GEZDGNBVGY3TQOJQGEZDGNBVGY3TQOJQ");
+    totpService()->code(other.data());
+    other.reset();
+    totpService()->code(&entry);
+    QVERIFY(changedSpy.wait(2500));
+
+    // codes no view asked for during the last step are dropped
+    changedSpy.clear();
+    QVERIFY(!changedSpy.wait(2500));
+}
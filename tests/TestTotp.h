@@ -33,6 +33,7 @@ private slots:
     void testTotpCode();
     void testEncoderData();
     void testSteamTotp();
+    void testTotpService();
 };
 
 #endif // KEEPASSX_TESTTOTP_H
@@ -20,6 +20,7 @@
 #include <QTest>
 
 #include "autotype/WildcardMatcher.h"
+#include "autotype/WildcardPatternSet.h"
 
 QTEST_GUILESS_MAIN(TestWildcardMatcher)
 
@@ -58,6 +59,96 @@ void TestWildcardMatcher::testMatcher()
     cleanupMatcher();
 }
 
+void TestWildcardMatcher::testPatternSet_data()
+{
+    testMatcher_data();
+
+    QTest::newRow("NoMatchOverlappingStartAndEnd") << QString("aba") << QString("ab*ba") << false;
+    QTest::newRow("NoMatchOverlappingParts") << QString("abcd") << QString("*abc*bcd*") << false;
+    QTest::newRow("MatchRepeatedParts") << QString("xaxbxa") << QString("*a*a") << true;
+    QTest::newRow("MatchEmptyText") << QString() << QString("*") << true;
+    QTest::newRow("NoMatchEmptyText") << QString() << QString("a*") << false;
+}
+
+void TestWildcardMatcher::testPatternSet()
+{
+    QFETCH(QString, text);
+    QFETCH(QString, pattern);
+    QFETCH(bool, match);
+
+    // the pattern has to match the same way next to unrelated patterns
+    WildcardPatternSet patterns(QStringList() << "*other*text*" << pattern << text << "*e*");
+    QBitArray result = patterns.match(text);
+    QCOMPARE(result.size(), 4);
+    QCOMPARE(result.testBit(1), match);
+    QCOMPARE(result.testBit(1), WildcardMatcher(text).match(pattern));
+    QVERIFY(result.testBit(2));
+}
+
+void TestWildcardMatcher::testPatternSetEquivalence()
+{
+    // every pattern of up to five characters out of "ab*" against every text
+    // of up to six characters out of "ab"
+    QStringList patterns;
+    for (int length = 0; length <= 5; ++length) {
+        int count = 1;
+        for (int i = 0; i < length; ++i) {
+            count *= 3;
+        }
+        for (int n = 0; n < count; ++n) {
+            QString pattern;
+            for (int i = 0, rest = n; i < length; ++i, rest /= 3) {
+                pattern.append(QString("ab*").at(rest % 3));
+            }
+            patterns.append(pattern);
+        }
+    }
+
+    WildcardPatternSet patternSet(patterns);
+    for (int length = 0; length <= 6; ++length) {
+        for (int n = 0; n < (1 << length); ++n) {
+            QString text;
+            for (int i = 0; i < length; ++i) {
+                text.append((n >> i) & 1 ? 'A' : 'b');
+            }
+
+            const QBitArray result = patternSet.match(text);
+            WildcardMatcher matcher(text);
+            for (int i = 0; i < patterns.size(); ++i) {
+                if (result.testBit(i) != matcher.match(patterns.at(i))) {
+                    QFAIL(qPrintable(QString("\"%1\" against \"%2\"").arg(patterns.at(i), text)));
+                }
+            }
+        }
+    }
+}
+
+void TestWildcardMatcher::benchmarkPatternSet()
+{
+    QByteArray env = qgetenv("BENCHMARK");
+
+    if (env.isEmpty() || env == "0" || env == "no") {
+        QSKIP("Benchmark skipped. Set env variable BENCHMARK=1 to enable.");
+    }
+
+    QStringList patterns;
+    for (int i = 0; i < 10000; ++i) {
+        patterns << QString("Application %1 - *").arg(i)
+                 << QString("*Account %1*Mozilla Firefox").arg(i);
+    }
+
+    const QString text("Account 9999 - Login - Mozilla Firefox");
+    WildcardPatternSet patternSet(patterns);
+    int matches = 0;
+
+    QBENCHMARK {
+        matches = patternSet.match(text).count(true);
+    }
+
+    // Account 9, 99, 999 and 9999
+    QCOMPARE(matches, 4);
+}
+
 void TestWildcardMatcher::initMatcher(QString text)
 {
     m_matcher = new WildcardMatcher(text);
@@ -29,6 +29,10 @@ class TestWildcardMatcher : public QObject
 private slots:
     void testMatcher();
     void testMatcher_data();
+    void testPatternSet();
+    void testPatternSet_data();
+    void testPatternSetEquivalence();
+    void benchmarkPatternSet();
 
 private:
     static const QString DefaultText;
@@ -0,0 +1,161 @@
+/*
+ *  Copyright (C) 2017 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "TestBrowser.h"
+
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QTest>
+
+#include "config-keepassx-tests.h"
+#include "browser/BrowserService.h"
+#include "browser/BrowserSettings.h"
+#include "core/Config.h"
+#include "core/Database.h"
+#include "core/Entry.h"
+#include "core/Group.h"
+#include "core/Tools.h"
+#include "crypto/Crypto.h"
+#include "gui/DatabaseTabWidget.h"
+#include "gui/DatabaseWidget.h"
+
+QTEST_MAIN(TestBrowser)
+
+namespace {
+
+const char TestId[] = "cache-test";
+
+QStringList logins(const QJsonArray& reply)
+{
+    QStringList result;
+    for (const QJsonValue& entry : reply) {
+        result << entry.toObject().value("login").toString();
+    }
+    return result;
+}
+
+}
+
+void TestBrowser::initTestCase()
+{
+    QVERIFY(Crypto::init());
+    Config::createTempFileInstance();
+    BrowserSettings::setAlwaysAllowAccess(true);
+    BrowserSettings::setSearchInAllDatabases(false);
+    BrowserSettings::setSortByTitle(false);
+
+    QFile sourceDbFile(QString(KEEPASSX_TEST_DATA_DIR).append("/NewDatabase.kdbx"));
+    QVERIFY(sourceDbFile.open(QIODevice::ReadOnly));
+    QByteArray dbData;
+    QVERIFY(Tools::readAllFromDevice(&sourceDbFile, dbData));
+    QVERIFY(m_dbFile.open());
+    QCOMPARE(m_dbFile.write(dbData), static_cast<qint64>(dbData.size()));
+    m_dbFile.close();
+}
+
+void TestBrowser::init()
+{
+    m_tabWidget = new DatabaseTabWidget();
+    m_tabWidget->openDatabase(m_dbFile.fileName(), "a");
+    QVERIFY(m_tabWidget->currentDatabaseWidget());
+    m_db = m_tabWidget->currentDatabaseWidget()->database();
+    QVERIFY(m_db);
+
+    m_entry = new Entry();
+    m_entry->setUuid(Uuid::random());
+    m_entry->setUrl("https://example.com/login");
+    m_entry->setUsername("user");
+    m_entry->setGroup(m_db->rootGroup());
+
+    m_service = new BrowserService(m_tabWidget);
+}
+
+void TestBrowser::cleanup()
+{
+    delete m_service;
+    delete m_tabWidget;
+}
+
+void TestBrowser::testResponseCache()
+{
+    const QString url("https://www.example.com/signin");
+
+    QCOMPARE(logins(m_service->findMatchingEntries(TestId, url, url, "")), QStringList() << "user");
+    QCOMPARE(m_service->cacheHits(), 0);
+    QCOMPARE(m_service->cacheMisses(), 1);
+
+    // a repeated request is answered from the cache
+    QCOMPARE(logins(m_service->findMatchingEntries(TestId, url, url, "")), QStringList() << "user");
+    QCOMPARE(m_service->cacheHits(), 1);
+    QCOMPARE(m_service->cacheMisses(), 1);
+
+    // the reply is built from the entry again, so it is never stale
+    m_entry->setPassword("changed");
+    QJsonArray reply = m_service->findMatchingEntries(TestId, url, url, "");
+    QCOMPARE(reply.size(), 1);
+    QCOMPARE(reply.first().toObject().value("password").toString(), QString("changed"));
+    QCOMPARE(m_service->cacheMisses(), 2);
+
+    // modified databases invalidate their replies
+    Entry* added = new Entry();
+    added->setUuid(Uuid::random());
+    added->setUrl("https://www.example.com");
+    added->setUsername("added");
+    added->setGroup(m_db->rootGroup());
+    QCOMPARE(m_service->findMatchingEntries(TestId, url, url, "").size(), 2);
+    QCOMPARE(m_service->cacheHits(), 1);
+    QCOMPARE(m_service->cacheMisses(), 3);
+    QCOMPARE(m_service->findMatchingEntries(TestId, url, url, "").size(), 2);
+    QCOMPARE(m_service->cacheHits(), 2);
+
+    // so do locking and unlocking
+    m_service->databaseLocked(m_tabWidget->currentDatabaseWidget());
+    QCOMPARE(m_service->findMatchingEntries(TestId, url, url, "").size(), 2);
+    QCOMPARE(m_service->cacheHits(), 2);
+    QCOMPARE(m_service->cacheMisses(), 4);
+
+    // and changed settings that affect the reply
+    BrowserSettings::setSortByTitle(true);
+    QCOMPARE(m_service->findMatchingEntries(TestId, url, url, "").size(), 2);
+    QCOMPARE(m_service->cacheMisses(), 5);
+    BrowserSettings::setSortByTitle(false);
+    QCOMPARE(m_service->findMatchingEntries(TestId, url, url, "").size(), 2);
+    QCOMPARE(m_service->cacheHits(), 3);
+    QCOMPARE(m_service->cacheMisses(), 5);
+}
+
+void TestBrowser::testResponseCacheEviction()
+{
+    // one more reply than the cache holds drops only the least recently used
+    const int count = 257;
+    for (int i = 0; i < count; ++i) {
+        const QString url = QString("https://site%1.example.net").arg(i);
+        QVERIFY(m_service->findMatchingEntries(TestId, url, url, "").isEmpty());
+    }
+    QCOMPARE(m_service->cacheHits(), 0);
+    QCOMPARE(m_service->cacheMisses(), count);
+
+    const QString first("https://site0.example.net");
+    const QString second("https://site1.example.net");
+    const QString last = QString("https://site%1.example.net").arg(count - 1);
+    m_service->findMatchingEntries(TestId, last, last, "");
+    m_service->findMatchingEntries(TestId, second, second, "");
+    QCOMPARE(m_service->cacheHits(), 2);
+    m_service->findMatchingEntries(TestId, first, first, "");
+    QCOMPARE(m_service->cacheHits(), 2);
+    QCOMPARE(m_service->cacheMisses(), count + 1);
+}
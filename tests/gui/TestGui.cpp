@@ -436,43 +436,43 @@ void TestGui::testPasswordEntryEntropy()
 
     editNewPassword->setText("");
     QTest::keyClicks(editNewPassword, "hello");
-    QCOMPARE(entropyLabel->text(), QString("Entropy: 6.38 bit"));
-    QCOMPARE(strengthLabel->text(), QString("Password Quality: Poor"));
+    QTRY_COMPARE(entropyLabel->text(), QString("Entropy: 6.38 bit"));
+    QTRY_COMPARE(strengthLabel->text(), QString("Password Quality: Poor"));
 
     editNewPassword->setText("");
     QTest::keyClicks(editNewPassword, "helloworld");
-    QCOMPARE(entropyLabel->text(), QString("Entropy: 13.10 bit"));
-    QCOMPARE(strengthLabel->text(), QString("Password Quality: Poor"));
+    QTRY_COMPARE(entropyLabel->text(), QString("Entropy: 13.10 bit"));
+    QTRY_COMPARE(strengthLabel->text(), QString("Password Quality: Poor"));
 
     editNewPassword->setText("");
     QTest::keyClicks(editNewPassword, "password1");
-    QCOMPARE(entropyLabel->text(), QString("Entropy: 4.00 bit"));
-    QCOMPARE(strengthLabel->text(), QString("Password Quality: Poor"));
+    QTRY_COMPARE(entropyLabel->text(), QString("Entropy: 4.00 bit"));
+    QTRY_COMPARE(strengthLabel->text(), QString("Password Quality: Poor"));
 
     editNewPassword->setText("");
     QTest::keyClicks(editNewPassword, "D0g..................");
-    QCOMPARE(entropyLabel->text(), QString("Entropy: 19.02 bit"));
-    QCOMPARE(strengthLabel->text(), QString("Password Quality: Poor"));
+    QTRY_COMPARE(entropyLabel->text(), QString("Entropy: 19.02 bit"));
+    QTRY_COMPARE(strengthLabel->text(), QString("Password Quality: Poor"));
 
     editNewPassword->setText("");
     QTest::keyClicks(editNewPassword, "Tr0ub4dour&3");
-    QCOMPARE(entropyLabel->text(), QString("Entropy: 30.87 bit"));
-    QCOMPARE(strengthLabel->text(), QString("Password Quality: Poor"));
+    QTRY_COMPARE(entropyLabel->text(), QString("Entropy: 30.87 bit"));
+    QTRY_COMPARE(strengthLabel->text(), QString("Password Quality: Poor"));
 
     editNewPassword->setText("");
     QTest::keyClicks(editNewPassword, "correcthorsebatterystaple");
-    QCOMPARE(entropyLabel->text(),  QString("Entropy: 47.98 bit"));
-    QCOMPARE(strengthLabel->text(), QString("Password Quality: Weak"));
+    QTRY_COMPARE(entropyLabel->text(),  QString("Entropy: 47.98 bit"));
+    QTRY_COMPARE(strengthLabel->text(), QString("Password Quality: Weak"));
 
     editNewPassword->setText("");
     QTest::keyClicks(editNewPassword, "YQC3kbXbjC652dTDH");
-    QCOMPARE(entropyLabel->text(),  QString("Entropy: 96.07 bit"));
-    QCOMPARE(strengthLabel->text(), QString("Password Quality: Good"));
+    QTRY_COMPARE(entropyLabel->text(),  QString("Entropy: 96.07 bit"));
+    QTRY_COMPARE(strengthLabel->text(), QString("Password Quality: Good"));
 
     editNewPassword->setText("");
     QTest::keyClicks(editNewPassword, "Bs5ZFfthWzR8DGFEjaCM6bGqhmCT4km");
-    QCOMPARE(entropyLabel->text(),  QString("Entropy: 174.59 bit"));
-    QCOMPARE(strengthLabel->text(), QString("Password Quality: Excellent"));
+    QTRY_COMPARE(entropyLabel->text(),  QString("Entropy: 174.59 bit"));
+    QTRY_COMPARE(strengthLabel->text(), QString("Password Quality: Excellent"));
 
     // We are done
 }
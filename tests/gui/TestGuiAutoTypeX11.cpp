@@ -0,0 +1,90 @@
+/*
+ *  Copyright (C) 2017 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "TestGuiAutoTypeX11.h"
+
+#include <QApplication>
+#include <QLineEdit>
+#include <QPluginLoader>
+#include <QTest>
+
+#include "autotype/AutoType.h"
+#include "autotype/AutoTypePlatformPlugin.h"
+#include "core/Config.h"
+#include "core/Database.h"
+#include "core/Entry.h"
+#include "core/FilePath.h"
+#include "core/Group.h"
+#include "crypto/Crypto.h"
+
+QTEST_MAIN(TestGuiAutoTypeX11)
+
+/**
+ * Types into a line edit of this process with the X11 plugin, e.g. on Xvfb.
+ * The test is skipped on other platforms or without the XTEST extension.
+ */
+void TestGuiAutoTypeX11::initTestCase()
+{
+    QVERIFY(Crypto::init());
+    Config::createTempFileInstance();
+
+    if (QApplication::platformName() != "xcb") {
+        QSKIP("The X11 Auto-Type test needs an X server.");
+    }
+
+    QPluginLoader loader(filePath()->pluginPath("keepassx-autotype-xcb"));
+    loader.setLoadHints(QLibrary::ResolveAllSymbolsHint);
+    AutoTypePlatformInterface* platform = qobject_cast<AutoTypePlatformInterface*>(loader.instance());
+    if (!platform || !platform->isAvailable()) {
+        QSKIP("The X11 Auto-Type plugin isn't built or the X server lacks XTEST.");
+    }
+
+    m_db.reset(new Database());
+    Group* group = new Group();
+    m_db->setRootGroup(group);
+    m_entry = new Entry();
+    m_entry->setGroup(group);
+    m_entry->setUsername("user");
+    // 64 characters, some of them outside of the default US layout, so keys
+    // have to be remapped while typing
+    m_entry->setPassword(QString::fromUtf8("Xvfb-1234_ÄÖÜäöüß€éèçñ!\"#$%&'()*+,-./:;<=>?@[\\]^_`|~ abcdefghijk"));
+    QCOMPARE(m_entry->password().size(), 64);
+
+    m_lineEdit.reset(new QLineEdit());
+    m_lineEdit->show();
+    m_lineEdit->activateWindow();
+    QVERIFY(QTest::qWaitForWindowActive(m_lineEdit.data()));
+}
+
+void TestGuiAutoTypeX11::init()
+{
+    m_lineEdit->clear();
+    m_lineEdit->setFocus();
+}
+
+void TestGuiAutoTypeX11::cleanupTestCase()
+{
+    m_lineEdit.reset();
+    m_db.reset();
+}
+
+void TestGuiAutoTypeX11::testTypeSequence()
+{
+    AutoType::instance()->performAutoType(m_entry, nullptr, "{PASSWORD}{DELAY 50}{USERNAME}");
+
+    QTRY_COMPARE(m_lineEdit->text(), m_entry->password() + m_entry->username());
+}